@@ -18,6 +18,10 @@
 
 #include <stdint.h>
 #include "stm32f446xx_gpio_driver.h"
+#include "stm32f446xx_idle_driver.h"
+#include "stm32f446xx_timebase_driver.h"
+#include "stm32f446xx_prof_driver.h"
+#include "stm32f446xx_debounce_driver.h"
 
 #if !defined(__SOFT_FP__) && defined(__ARM_FP)
   #warning "FPU is not initialized, but the project is compiling for an FPU. Please initialize the FPU before use."
@@ -34,18 +38,49 @@
  */
 volatile uint8_t g_LedState = 0;
 
+#define CORE_CLOCK_HZ      16000000U  // HSI after reset, no PLL in this project
+#define BLINK_HALF_PERIOD  125U       // ms the LED stays ON (or OFF) while blinking
+#define BUTTON_DEBOUNCE_MS 12U        // what software_delay(50000) measured at 16 MHz
+#define BUTTON_PIN         13U        // PC13, active low (pressed = 0)
+#define EXTI_LINES_15_10   (0x3FU << 10) // lines served by EXTI15_10_IRQHandler
+
+/*
+ * Profiling slots (see stm32f446xx_prof_driver.h)
+ * The table is printed over SWO every time the FSM cycles back to OFF.
+ */
+#define PROF_ID_GPIO_INIT   0
+#define PROF_ID_GPIO_WRITE  1
+#define PROF_ID_EXTI_ISR    2
+
 /*
- * Software Delay Function
- * Intentionally wasting CPU cycles to create a delay.
+ * Debounced button event, called from the TIM5 interrupt once the level is stable.
+ * Only the press (stable low) advances the FSM; the release is ignored.
  */
-void software_delay(uint32_t count){
-    for(uint32_t i = 0; i < count; i++){
-        // Empty loop
+static void Button_Event(uint8_t Line, uint8_t Level)
+{
+    (void)Line;
+
+    if (Level != GPIO_PIN_RESET){
+        return;
     }
+
+    // Update FSM State: 0 -> 1 -> 2 -> 0 ...
+    g_LedState++;
+    if(g_LedState > 2) {
+        g_LedState = 0;
+    }
+
+    // Wake the main loop: even if it is about to enter WFI, it will not miss this change
+    IDLE_SignalEvent();
 }
 
 int main(void)
 {
+    PROF_Init();
+    PROF_Register(PROF_ID_GPIO_INIT, "GPIO_Init");
+    PROF_Register(PROF_ID_GPIO_WRITE, "GPIO_WriteToOutput");
+    PROF_Register(PROF_ID_EXTI_ISR, "EXTI15_10 ISR");
+
     // ==========================================
     // 1. Initialize LED (PA5) - Output Mode
     // ==========================================
@@ -61,7 +96,9 @@ int main(void)
 
     // Enable Clock for Port A
     GPIO_PeriClockControl(GPIOA, ENABLE);
+    PROF_BEGIN(PROF_ID_GPIO_INIT);
     GPIO_Init(&GPIO_LED);
+    PROF_END(PROF_ID_GPIO_INIT);
 
     // ==========================================
     // 2. Initialize User Button (PC13) - Interrupt Mode
@@ -77,39 +114,84 @@ int main(void)
     // Enable Clock for Port C
     GPIO_PeriClockControl(GPIOC, ENABLE);
 
+    /*
+     * Debounce on the TIM5 alarm instead of waiting inside the ISR.
+     * The time base must run first: the debounce windows are measured on it.
+     * Registered BEFORE GPIO_Init unmasks EXTI13: a press in between would otherwise
+     * reach DEBOUNCE_IRQHandling for a line it does not know yet.
+     * (PC13 is an input out of reset, so the initial level read here is valid.)
+     */
+    TIMEBASE_Init();
+    DEBOUNCE_Init();
+    DEBOUNCE_Register(GPIOC, BUTTON_PIN, BUTTON_DEBOUNCE_MS, Button_Event);
+
     // Initialize User Button (This handles SYSCFG, EXTI, and NVIC configurations automatically)
+    PROF_BEGIN(PROF_ID_GPIO_INIT);
     GPIO_Init(&GPIO_USER_BUTTON);
+    PROF_END(PROF_ID_GPIO_INIT);
 
     // ==========================================
     // 3. Main Loop (Application Logic)
     // ==========================================
+    /*
+     * [Tickless Idle]
+     * The loop only does work when something changed, then goes back to sleep:
+     * - State changed (button ISR): apply the new LED output ONCE.
+     * - Blinking: sleep exactly until the next toggle is due (SysTick one-shot).
+     * - OFF / SOLID ON: nothing will ever happen without the button -> sleep with no deadline.
+     * The CPU now spends almost all of its time in WFI instead of spinning.
+     */
+    IDLE_Init(CORE_CLOCK_HZ);
+
+    uint8_t applied_state = 0xFF;      // forces the first pass to apply g_LedState
+    uint32_t last_toggle = 0;          // get_ticks_ms() of the last blink toggle
+
     while (1){
+        uint8_t state = g_LedState;    // one snapshot per pass, the ISR may change it anytime
+
         // Finite State Machine (FSM) -> Controls LED behavior based on g_LedState
-        switch(g_LedState){
-            case 0: // OFF
-                GPIO_WriteToOutputPin(GPIOA, 5, 0);
-                break;
-            case 1: // SOLID ON
-                GPIO_WriteToOutputPin(GPIOA, 5, 1);
-                break;
-            case 2: // BLINK
-				/*
-				 * [How Blinking Works]
-				 * Since we are inside an infinite while(1) loop, as long as g_LedState stays 2,
-				 * the CPU will repeatedly enter this case.
-				 *
-				 * 1. Toggle: Uses XOR operation (^) to flip the pin state.
-				 * - First pass: 0 (OFF) ^ 1 = 1 (ON)
-				 * - Second pass: 1 (ON) ^ 1 = 0 (OFF)
-				 *
-				 * 2. Delay: Holds the current state (ON or OFF) for the duration of the delay.
-				 * - software_delay(500000) ≈ 125ms interval.
-				 *
-				 * The combined result is: ON -> Wait 125ms -> Loop back -> OFF -> Wait 125ms -> Loop back...
-				 */
-				GPIO_ToggleOutputPin(GPIOA, 5);
-				software_delay(500000);
-				break;
+        if (state != applied_state){
+            switch(state){
+                case 0: // OFF
+                    PROF_BEGIN(PROF_ID_GPIO_WRITE);
+                    GPIO_WriteToOutputPin(GPIOA, 5, 0);
+                    PROF_END(PROF_ID_GPIO_WRITE);
+                    if (applied_state != 0xFF){
+                        PROF_Dump(); // one full OFF -> ON -> BLINK -> OFF cycle done
+                    }
+                    break;
+                case 1: // SOLID ON
+                    PROF_BEGIN(PROF_ID_GPIO_WRITE);
+                    GPIO_WriteToOutputPin(GPIOA, 5, 1);
+                    PROF_END(PROF_ID_GPIO_WRITE);
+                    break;
+                case 2: // BLINK: start from the current level, first toggle right away
+                    GPIO_ToggleOutputPin(GPIOA, 5);
+                    last_toggle = get_ticks_ms();
+                    break;
+            }
+            applied_state = state;
+        }
+
+        if (state == 2){
+            /*
+             * [How Blinking Works]
+             * Instead of toggling and burning 125ms in a delay loop, keep a deadline on
+             * the TIM5 time base: toggle once 125ms have passed since the last toggle,
+             * otherwise sleep for exactly the time that is left.
+             * "last_toggle += period" (not "= now") keeps the rhythm exact even if we
+             * wake up a little late.
+             */
+            if (timeout_expired_ms(last_toggle, BLINK_HALF_PERIOD)){
+                GPIO_ToggleOutputPin(GPIOA, 5);
+                last_toggle += BLINK_HALF_PERIOD;
+            }
+            uint32_t elapsed = get_ticks_ms() - last_toggle;
+            if (elapsed < BLINK_HALF_PERIOD){
+                IDLE_Sleep(BLINK_HALF_PERIOD - elapsed);
+            }
+        }else{
+            IDLE_Sleep(IDLE_WAIT_FOREVER);
         }
     }
 }
@@ -127,37 +209,25 @@ int main(void)
  */
 void EXTI15_10_IRQHandler(void)
 {
+    PROF_SCOPE(PROF_ID_EXTI_ISR); // cycles from here to the closing brace
+
     /*
-     * Check Pending Register (EXTI -> PR)
-     * We need to confirm that the interrupt was triggered by Line 13 (PC13).
+     * [Non-Blocking Debouncing]
+     * The old version waited 12 ms right here (software_delay, then delay_ms) to let the
+     * contact bounce settle, blocking every interrupt at this priority meanwhile.
+     * Now the ISR only masks line 13 (EXTI->IMR), clears its pending bit and arms the
+     * TIM5 alarm. 12 ms later Button_Event() gets the stable level; the bounces in
+     * between never reach the CPU.
+     *
+     * OBSERVATION: On the NUCLEO-F446RE board, I tested without debouncing
+     * and it worked perfectly. This is likely due to the hardware RC Low-pass
+     * filter (Capacitor + Resistor) built into the User Button circuit.
+     * Keeping the logic here for robustness on other hardware.
      *
-     * EXTI->PR & (1 << 13) evaluates to true (non-zero) if the 13th bit is set.
+     * Whatever is still pending and unmasked on lines 10-15 after that is not
+     * registered with the debounce driver (it masks and clears its own lines):
+     * clear it, otherwise this vector would be re-entered forever.
      */
-    if(EXTI->PR & (1 << 13))
-    {
-        /*
-         * [Software Debouncing]
-         * A delay of ~50ms to ignore mechanical noise from the switch.
-         *
-         * OBSERVATION: On the NUCLEO-F446RE board, I tested without this delay
-         * and it worked perfectly. This is likely due to the hardware RC Low-pass
-         * filter (Capacitor + Resistor) built into the User Button circuit.
-         * Keeping the logic here for robustness on other hardware.
-         */
-        software_delay(50000);
-
-        // Update FSM State: 0 -> 1 -> 2 -> 0 ...
-        g_LedState++;
-        if(g_LedState > 2) {
-            g_LedState = 0;
-        }
-
-        /*
-         * CRITICAL STEP: Clear the Pending Bit
-         * According to the Reference Manual, this bit is cleared by writing '1' to it.
-         * If we don't clear it, the CPU will think the interrupt is still pending
-         * and will get stuck in an infinite loop re-entering this function.
-         */
-        EXTI->PR |= (1 << 13);
-    }
+    DEBOUNCE_IRQHandling();
+    EXTI->PR = EXTI->PR & EXTI->IMR & EXTI_LINES_15_10;
 }
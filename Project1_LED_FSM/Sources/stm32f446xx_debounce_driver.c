@@ -0,0 +1,174 @@
+/*
+ * stm32f446xx_debounce_driver.c
+ *
+ *  Created on: 2026/1/20
+ *      Author: Yuheng
+ */
+#include "stm32f446xx_debounce_driver.h"
+#include "stm32f446xx_timebase_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct{
+	GPIO_RegDef_t *pGPIOx;          // port the line is routed to, NULL = not registered
+	uint32_t WindowUs;
+	uint32_t Deadline;              // get_ticks_us() at which the window is over
+	DEBOUNCE_Callback_t Callback;
+	uint8_t StableLevel;            // level reported by the last event
+} DEBOUNCE_Line_t;
+
+static DEBOUNCE_Line_t Lines[DEBOUNCE_LINES];
+
+static uint16_t RegisteredMask;     // bit n = line n is registered
+static volatile uint16_t ArmedMask; // bit n = line n is masked and waiting for its window
+
+/*
+ * Shared between the EXTI interrupts, the TIM5 interrupt and main (Register/SetWindow):
+ * nestable masking, same pattern as the time base.
+ */
+static uint32_t DEBOUNCE_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void DEBOUNCE_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/*
+ * Program the alarm for the earliest armed deadline (interrupts masked).
+ * "Earliest" is the smallest distance from now, so the 32-bit wrap of get_ticks_us() is harmless.
+ */
+static void DEBOUNCE_ScheduleNext(uint32_t Now){
+	uint32_t armed = ArmedMask;
+	uint32_t earliest = 0;
+	uint32_t shortest = UINT32_MAX;
+
+	if (armed == 0){
+		TIMEBASE_CancelAlarm();
+		return;
+	}
+	while (armed != 0){
+		uint8_t line = (uint8_t)__builtin_ctz(armed);
+		uint32_t distance = Lines[line].Deadline - Now;
+
+		if ((int32_t)distance < 0){
+			distance = 0; // already due
+		}
+		if (distance < shortest){
+			shortest = distance;
+			earliest = Lines[line].Deadline;
+		}
+		armed &= armed - 1U; // drop the lowest set bit
+	}
+	TIMEBASE_SetAlarmUs(earliest);
+}
+
+/*
+ * TIM5 alarm: close every window that is over
+ */
+static void DEBOUNCE_AlarmHandler(void){
+	uint32_t primask = DEBOUNCE_EnterCritical();
+	uint32_t now = get_ticks_us();
+	uint32_t armed = ArmedMask;
+	uint16_t changed = 0;
+
+	while (armed != 0){
+		uint8_t line = (uint8_t)__builtin_ctz(armed);
+		uint16_t bit = (uint16_t)(1U << line);
+		DEBOUNCE_Line_t *pLine = &Lines[line];
+		armed &= armed - 1U;
+
+		if ((int32_t)(now - pLine->Deadline) < 0){
+			continue; // window still open
+		}
+
+		/*
+		 * Order matters:
+		 * 1. PR: forget the bounce edges that arrived while the line was masked
+		 * 2. IMR: unmask -> from now on a new edge starts a new window
+		 * 3. IDR: sample AFTER unmasking, so a change right now is either seen here
+		 *    or starts a new window, never lost in between
+		 */
+		ArmedMask &= (uint16_t)~bit;
+		EXTI->PR = bit;      // rc_w1: writing 1 clears, 0 leaves the other lines alone
+		EXTI->IMR |= bit;
+
+		uint8_t level = (uint8_t)((pLine->pGPIOx->IDR >> line) & 0x1U);
+		if (level != pLine->StableLevel){
+			pLine->StableLevel = level;
+			changed |= bit;
+		}
+	}
+
+	DEBOUNCE_ScheduleNext(now);
+	DEBOUNCE_ExitCritical(primask);
+
+	// Events outside the masked section
+	while (changed != 0){
+		uint8_t line = (uint8_t)__builtin_ctz(changed);
+		changed &= (uint16_t)(changed - 1U);
+		Lines[line].Callback(line, Lines[line].StableLevel);
+	}
+}
+
+void DEBOUNCE_Init(void){
+	TIMEBASE_SetAlarmCallback(DEBOUNCE_AlarmHandler);
+}
+
+uint8_t DEBOUNCE_Register(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint32_t WindowMs, DEBOUNCE_Callback_t Callback){
+	if (PinNumber >= DEBOUNCE_LINES || Callback == NULL){
+		return DISABLE;
+	}
+	uint32_t primask = DEBOUNCE_EnterCritical();
+
+	Lines[PinNumber].pGPIOx = pGPIOx;
+	Lines[PinNumber].Callback = Callback;
+	Lines[PinNumber].StableLevel = (uint8_t)((pGPIOx->IDR >> PinNumber) & 0x1U);
+	RegisteredMask |= (uint16_t)(1U << PinNumber);
+
+	DEBOUNCE_ExitCritical(primask);
+
+	DEBOUNCE_SetWindow(PinNumber, WindowMs);
+	return ENABLE;
+}
+
+void DEBOUNCE_SetWindow(uint8_t Line, uint32_t WindowMs){
+	if (Line >= DEBOUNCE_LINES){
+		return;
+	}
+	if (WindowMs > DEBOUNCE_MAX_WINDOW_MS){
+		WindowMs = DEBOUNCE_MAX_WINDOW_MS;
+	}
+	Lines[Line].WindowUs = WindowMs * 1000U; // one aligned 32-bit store, no masking needed
+}
+
+void DEBOUNCE_IRQHandling(void){
+	uint32_t pending = EXTI->PR & EXTI->IMR & RegisteredMask;
+
+	if (pending == 0){
+		return;
+	}
+
+	uint32_t primask = DEBOUNCE_EnterCritical();
+	uint32_t now = get_ticks_us();
+
+	// 1. Mask the lines (no more interrupts from their bounces) and clear them
+	EXTI->IMR &= ~pending;
+	EXTI->PR = pending;
+
+	// 2. Open a window for each of them
+	ArmedMask |= (uint16_t)pending;
+	while (pending != 0){
+		uint8_t line = (uint8_t)__builtin_ctz(pending);
+		Lines[line].Deadline = now + Lines[line].WindowUs;
+		pending &= pending - 1U;
+	}
+
+	// 3. The new deadline may be earlier than the one the alarm waits for
+	DEBOUNCE_ScheduleNext(now);
+	DEBOUNCE_ExitCritical(primask);
+}
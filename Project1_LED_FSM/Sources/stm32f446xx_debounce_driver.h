@@ -0,0 +1,90 @@
+/*
+ * stm32f446xx_debounce_driver.h
+ *
+ *  Created on: 2026/1/20
+ *      Author: Yuheng
+ *
+ * Description:
+ * Non-blocking debounce for EXTI inputs (all 16 lines), driven by the TIM5 alarm.
+ *
+ * Why?
+ * The button ISR used to wait out the contact bounce inside the interrupt
+ * (software_delay, later delay_ms(12)). For those 12 ms nothing else at the
+ * same or lower priority could run, and the CPU could not sleep.
+ *
+ * How it works:
+ *   button:  ¯¯¯¯|_|¯|__|¯|_________________   (bouncing, then stable low)
+ *                ^                  ^
+ *   1. first edge -> EXTI ISR:      2. window over -> TIM5 alarm:
+ *      - mask the line (IMR)           - clear the edges collected meanwhile (PR)
+ *      - clear PR                      - unmask the line (IMR)
+ *      - deadline = now + window       - sample IDR: changed since the last event?
+ *      - (re)program the alarm           -> call the line's callback with the new level
+ * The bounces in between never reach the CPU, because the line is masked.
+ * The ISR is a handful of register writes, no waiting.
+ *
+ * One alarm for 16 lines:
+ * TIM5 has a single alarm (CCR1). Each line keeps its own deadline, and the alarm is
+ * always programmed to the EARLIEST armed one. When it fires, every line whose window
+ * is over is handled, then the alarm moves on to the next earliest deadline.
+ *
+ * Events:
+ * The callback gets the stable pin level after the window (0 or 1), so both press
+ * and release are reported (with a falling-edge trigger, a release still bounces
+ * and produces falling edges). A pulse shorter than the window leaves the level
+ * unchanged and is dropped as a glitch.
+ * Callbacks run in the TIM5 interrupt: keep them short.
+ */
+
+#ifndef SOURCES_STM32F446XX_DEBOUNCE_DRIVER_H_
+#define SOURCES_STM32F446XX_DEBOUNCE_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx_gpio_driver.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#define DEBOUNCE_LINES              16      // EXTI0 - EXTI15 (one GPIO pin number each)
+#define DEBOUNCE_MAX_WINDOW_MS      1000U   // longer windows are clamped
+
+/*
+ * Line = pin number (EXTI line n is pin n of the port selected in SYSCFG_EXTICR).
+ * Level = stable IDR level after the window (GPIO_PIN_SET / GPIO_PIN_RESET).
+ */
+typedef void (*DEBOUNCE_Callback_t)(uint8_t Line, uint8_t Level);
+
+/*
+ * ==========================================
+ * 2. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Take over the TIM5 alarm. TIMEBASE_Init() must have been called before.
+ */
+void DEBOUNCE_Init(void);
+
+/*
+ * Debounce one pin. Register it BEFORE GPIO_Init puts it in an interrupt mode
+ * (GPIO_MODE_IT_FT / IT_RT / IT_RFT), which unmasks its EXTI line: the pin must
+ * already read as an input here (e.g. reset state) for the initial level.
+ * Returns ENABLE on success, DISABLE if PinNumber is not 0-15 or Callback is NULL.
+ */
+uint8_t DEBOUNCE_Register(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint32_t WindowMs, DEBOUNCE_Callback_t Callback);
+
+/*
+ * Change the window of a registered line. Takes effect from the next edge.
+ */
+void DEBOUNCE_SetWindow(uint8_t Line, uint32_t WindowMs);
+
+/*
+ * Call from EXTIx_IRQHandler (any of them, for every registered line it covers).
+ * Handles every registered line that is pending; other pending lines are left
+ * alone for the caller.
+ */
+void DEBOUNCE_IRQHandling(void);
+
+#endif /* SOURCES_STM32F446XX_DEBOUNCE_DRIVER_H_ */
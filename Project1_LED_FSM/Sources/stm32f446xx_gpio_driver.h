@@ -269,12 +269,12 @@ void GPIO_ToggleOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber);
  * ==========================================
  */
 typedef struct{
-	uint32_t IMR; // interrupt mask register -> offset 0x00
-	uint32_t EMR; // event mask register -> offset 0x04
-	uint32_t RTSR; // rising trigger selection register -> offset 0x08
-	uint32_t FTSR; // falling trigger selection register -> offset 0x0C
-	uint32_t SWIER; // software interrupt event register -> offset 0x10
-	uint32_t PR; // pending register -> offset 0x14
+	volatile uint32_t IMR; // interrupt mask register -> offset 0x00
+	volatile uint32_t EMR; // event mask register -> offset 0x04
+	volatile uint32_t RTSR; // rising trigger selection register -> offset 0x08
+	volatile uint32_t FTSR; // falling trigger selection register -> offset 0x0C
+	volatile uint32_t SWIER; // software interrupt event register -> offset 0x10
+	volatile uint32_t PR; // pending register -> offset 0x14 (changed by hardware, MUST be volatile)
 } EXTI_RegDef_t;
 
 /*
@@ -0,0 +1,131 @@
+/*
+ * stm32f446xx_idle_driver.c
+ *
+ *  Created on: 2026/1/15
+ *      Author: Yuheng
+ */
+
+#include "stm32f446xx_idle_driver.h"
+#include <stdint.h>
+
+static uint32_t TicksPerMs;          // SysTick ticks per millisecond (core clock / 8 / 1000)
+static uint32_t LastAwakeStamp;      // DWT->CYCCNT when we last woke up
+static volatile uint8_t PendingEvent; // set by ISRs through IDLE_SignalEvent
+
+static uint64_t SleepTicks;
+static uint64_t ActiveCycles;
+static uint32_t WakeUps;
+
+void IDLE_Init(uint32_t CoreClockHz){
+	TicksPerMs = CoreClockHz / IDLE_SYSTICK_DIV / 1000U;
+
+	// SysTick stays OFF until we actually sleep (no periodic tick)
+	SYSTICK->CTRL = 0;
+
+	// DWT cycle counter: TRCENA first, otherwise the DWT registers ignore writes
+	*DEMCR_ADDR |= (1U << 24);
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= (1U << 0);
+
+	// Plain Sleep mode (not Stop): peripherals keep running while we wait
+	*SCB_SCR_ADDR &= ~(1U << 2);
+
+	LastAwakeStamp = DWT->CYCCNT;
+}
+
+void IDLE_SignalEvent(void){
+	PendingEvent = 1;
+}
+
+uint32_t IDLE_Sleep(uint32_t TimeoutMs){
+	uint32_t reload, ctrl, val, elapsed;
+
+	/*
+	 * 1. Close the race window
+	 * PRIMASK = 1 (cpsid i) blocks interrupt HANDLERS, but a pending interrupt
+	 * still wakes WFI. So: check for work with interrupts masked, then sleep.
+	 * If the button fires after the check, WFI returns immediately instead of
+	 * sleeping through the event.
+	 */
+	__asm volatile ("cpsid i" : : : "memory");
+
+	ActiveCycles += (uint32_t)(DWT->CYCCNT - LastAwakeStamp);
+
+	if (PendingEvent){
+		PendingEvent = 0;
+		LastAwakeStamp = DWT->CYCCNT;
+		__asm volatile ("cpsie i" : : : "memory");
+		return 0;
+	}
+
+	/*
+	 * 2. Program SysTick as a one-shot wake-up timer
+	 * LOAD = N - 1 gives exactly N ticks until the counter wraps (COUNTFLAG).
+	 * No deadline (or a deadline longer than 24 bits) -> use the full range,
+	 * the caller simply sleeps again after the wake-up.
+	 */
+	if (TimeoutMs == IDLE_WAIT_FOREVER || TimeoutMs > (SYSTICK_MAX_RELOAD + 1U) / TicksPerMs){
+		reload = SYSTICK_MAX_RELOAD;
+	}else if (TimeoutMs == 0){
+		__asm volatile ("cpsie i" : : : "memory");
+		return 0;
+	}else{
+		reload = TimeoutMs * TicksPerMs - 1U;
+	}
+
+	SYSTICK->CTRL = 0;
+	SYSTICK->LOAD = reload;
+	SYSTICK->VAL = 0;                                         // any write clears the counter and COUNTFLAG
+	SYSTICK->CTRL = SYSTICK_CTRL_TICKINT | SYSTICK_CTRL_ENABLE; // CLKSOURCE = 0 -> AHB/8
+
+	/*
+	 * 3. Sleep
+	 * DSB makes sure every outstanding write (e.g. the LED BSRR) has reached the bus
+	 * before the core clock stops.
+	 */
+	__asm volatile ("dsb" : : : "memory");
+	__asm volatile ("wfi");
+
+	/*
+	 * 4. Woken up: measure how long we slept
+	 * Reading CTRL clears COUNTFLAG, so read it exactly once.
+	 * COUNTFLAG = 1 -> the full one-shot period elapsed.
+	 * COUNTFLAG = 0 -> an interrupt (button) woke us early, elapsed = LOAD - VAL.
+	 */
+	ctrl = SYSTICK->CTRL;
+	val = SYSTICK->VAL;
+	SYSTICK->CTRL = 0;
+	*SCB_ICSR_ADDR = (1U << 25); // PENDSTCLR: the SysTick exception was only a wake-up source
+
+	elapsed = (ctrl & SYSTICK_CTRL_COUNTFLAG) ? (reload + 1U) : (reload - val);
+	SleepTicks += elapsed;
+	WakeUps++;
+
+	LastAwakeStamp = DWT->CYCCNT;
+
+	// 5. Let the waiting ISR (if any) run now
+	__asm volatile ("cpsie i" : : : "memory");
+
+	return elapsed / TicksPerMs;
+}
+
+void IDLE_GetStats(IDLE_Stats_t *pStats){
+	pStats->SleepTicks = SleepTicks;
+	pStats->ActiveCycles = ActiveCycles;
+	pStats->WakeUps = WakeUps;
+	pStats->SleepTimeMs = (uint32_t)(SleepTicks / TicksPerMs);
+
+	// Compare both in core clock cycles (1 SysTick tick = 8 core cycles)
+	uint64_t sleep_cycles = SleepTicks * IDLE_SYSTICK_DIV;
+	uint64_t total_cycles = sleep_cycles + ActiveCycles;
+	pStats->IdlePercent = (total_cycles == 0) ? 0 : (uint8_t)((sleep_cycles * 100U) / total_cycles);
+}
+
+/*
+ * SysTick is only used as a wake-up source, and its pending bit is cleared
+ * in IDLE_Sleep before interrupts are re-enabled. This handler exists so that a
+ * stray SysTick never lands in Default_Handler (an infinite loop).
+ */
+void SysTick_Handler(void){
+	SYSTICK->CTRL = 0;
+}
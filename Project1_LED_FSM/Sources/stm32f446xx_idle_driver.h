@@ -0,0 +1,125 @@
+/*
+ * stm32f446xx_idle_driver.h
+ *
+ *  Created on: 2026/1/15
+ *      Author: Yuheng
+ *
+ * Description:
+ * Tickless Idle for the LED FSM.
+ *
+ * Problem:
+ * The old while(1) loop re-wrote the same BSRR value millions of times per second
+ * in the OFF and SOLID ON states. The LED only changes on a button press (or every
+ * 125 ms while blinking), so the CPU was burning 100% for nothing.
+ *
+ * Solution:
+ * When the FSM has nothing to do, put the core to sleep with WFI (Wait For Interrupt).
+ * - The button (EXTI) interrupt wakes it up immediately.
+ * - If there is a deadline (next blink toggle), SysTick is programmed as a ONE-SHOT
+ *   wake-up timer for exactly that moment. There is no periodic 1 ms tick ("tickless").
+ * - Time spent asleep is measured with SysTick, time spent awake with the DWT
+ *   cycle counter, which gives the idle percentage.
+ *
+ * Sleep vs Stop:
+ * WFI with SLEEPDEEP = 0 is "Sleep mode": only the CPU clock stops, every peripheral
+ * (GPIO, EXTI, SysTick) keeps running, so nothing needs re-initialising on wake-up.
+ *
+ * Refer to PM0214 - 4.5 SysTick timer, 2.5 Power management
+ */
+
+#ifndef SOURCES_STM32F446XX_IDLE_DRIVER_H_
+#define SOURCES_STM32F446XX_IDLE_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx_prof_driver.h"
+
+/*
+ * ==========================================
+ * 1. Core Peripheral Register Definitions
+ * ==========================================
+ * These live inside the Cortex-M4 itself (Private Peripheral Bus), not in the STM32 part.
+ */
+
+/*
+ * SysTick: 24-bit down-counter
+ * CTRL bit 0 ENABLE, bit 1 TICKINT, bit 2 CLKSOURCE (0: AHB/8, 1: AHB), bit 16 COUNTFLAG
+ */
+typedef struct{
+	volatile uint32_t CTRL;  // control and status register,  offset: 0x00
+	volatile uint32_t LOAD;  // reload value register,        offset: 0x04
+	volatile uint32_t VAL;   // current value register,       offset: 0x08
+	volatile uint32_t CALIB; // calibration value register,   offset: 0x0C
+} SysTick_RegDef_t;
+
+/*
+ * DWT: defined in stm32f446xx_prof_driver.h. Only CYCCNT is used here (counts CPU
+ * cycles, and stops while the CPU sleeps, which is exactly what we want for "time spent awake").
+ */
+
+#define SYSTICK_BASEADDR        0xE000E010U
+#define SCB_ICSR_ADDR           ((volatile uint32_t*)0xE000ED04U) // bit 25 PENDSTCLR
+#define SCB_SCR_ADDR            ((volatile uint32_t*)0xE000ED10U) // bit 2 SLEEPDEEP
+
+#define SYSTICK                 ((SysTick_RegDef_t*)SYSTICK_BASEADDR)
+
+#define SYSTICK_CTRL_ENABLE     (1U << 0)
+#define SYSTICK_CTRL_TICKINT    (1U << 1)
+#define SYSTICK_CTRL_COUNTFLAG  (1U << 16)
+#define SYSTICK_MAX_RELOAD      0x00FFFFFFU  // 24 bits
+
+/*
+ * ==========================================
+ * 2. Configuration
+ * ==========================================
+ * SysTick is clocked from AHB/8 while sleeping.
+ * At 16 MHz (HSI) that is 2 MHz -> 0.5 us resolution, and the 24-bit counter
+ * covers up to 8.3 s in one shot. Longer sleeps just wake up once per 8.3 s.
+ */
+#define IDLE_SYSTICK_DIV        8U
+#define IDLE_WAIT_FOREVER       0xFFFFFFFFU  // no deadline: sleep until an interrupt
+
+/*
+ * Statistics (read them in the debugger, or with IDLE_GetStats)
+ */
+typedef struct{
+	uint64_t SleepTicks;     // time spent in WFI, in SysTick ticks (core clock / 8)
+	uint64_t ActiveCycles;   // time spent awake, in core clock cycles
+	uint32_t SleepTimeMs;    // SleepTicks converted to milliseconds
+	uint32_t WakeUps;        // number of WFI exits
+	uint8_t  IdlePercent;    // sleep / (sleep + active) * 100
+} IDLE_Stats_t;
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Must be called once, before the first IDLE_Sleep.
+ * CoreClockHz: HCLK in Hz (16000000 for the reset HSI clock).
+ */
+void IDLE_Init(uint32_t CoreClockHz);
+
+/*
+ * Sleep until an interrupt arrives or TimeoutMs has passed, whichever comes first.
+ * TimeoutMs = IDLE_WAIT_FOREVER -> no deadline.
+ * Returns the number of whole milliseconds actually slept, so the caller can
+ * subtract it from its own deadline (returns TimeoutMs exactly when the deadline was reached).
+ *
+ * If IDLE_SignalEvent() was called since the last IDLE_Sleep, it returns 0 immediately
+ * without sleeping -> an event can never be "lost" between checking the FSM and WFI.
+ */
+uint32_t IDLE_Sleep(uint32_t TimeoutMs);
+
+/*
+ * Call from any ISR that creates work for the main loop (e.g. the button ISR).
+ */
+void IDLE_SignalEvent(void);
+
+/*
+ * Copy of the current statistics (IdlePercent and SleepTimeMs are computed here).
+ */
+void IDLE_GetStats(IDLE_Stats_t *pStats);
+
+#endif /* SOURCES_STM32F446XX_IDLE_DRIVER_H_ */
@@ -0,0 +1,91 @@
+/*
+ * stm32f446xx_prof_driver.c
+ *
+ *  Created on: 2026/1/17
+ *      Author: Yuheng
+ */
+#include "stm32f446xx_prof_driver.h"
+#include <stdint.h>
+#include <stdio.h>
+
+PROF_Probe_t PROF_Probes[PROF_MAX_PROBES];
+uint32_t PROF_Overhead;
+
+#define PROF_CALIBRATION_RUNS   8
+
+void PROF_Init(void){
+	/*
+	 * 1. Enable the cycle counter
+	 * DEMCR.TRCENA (bit 24) powers the DWT/ITM blocks, then DWT_CTRL.CYCCNTENA (bit 0).
+	 * Harmless if another driver (idle) already did it.
+	 */
+	*DEMCR_ADDR |= (1U << 24);
+	DWT->CTRL |= (1U << 0);
+
+	/*
+	 * 2. Calibrate
+	 * Time an EMPTY begin/end pair a few times on slot 0 and keep the minimum.
+	 * That is the cost of the probe itself (load CYCCNT, store, load, subtract),
+	 * and it is subtracted from every later sample.
+	 */
+	PROF_Overhead = 0;
+	PROF_Register(0, NULL);
+	for (uint8_t i = 0; i < PROF_CALIBRATION_RUNS; i++){
+		PROF_Begin(0);
+		PROF_End(0);
+	}
+	PROF_Overhead = PROF_Probes[0].Min;
+	PROF_Register(0, NULL);
+}
+
+void PROF_Register(uint8_t Id, const char *Name){
+	if (Id >= PROF_MAX_PROBES){
+		return;
+	}
+	PROF_Probes[Id].Name = Name;
+	PROF_Probes[Id].Count = 0;
+	PROF_Probes[Id].Min = 0;
+	PROF_Probes[Id].Max = 0;
+	PROF_Probes[Id].Total = 0;
+}
+
+void PROF_Reset(void){
+	for (uint8_t i = 0; i < PROF_MAX_PROBES; i++){
+		if (PROF_Probes[i].Name != NULL){
+			PROF_Register(i, PROF_Probes[i].Name);
+		}
+	}
+}
+
+void PROF_Dump(void){
+	printf("probe                 count       min       max      mean  (cycles, overhead %lu removed)\n",
+	       (unsigned long)PROF_Overhead);
+
+	for (uint8_t i = 0; i < PROF_MAX_PROBES; i++){
+		const PROF_Probe_t *pProbe = &PROF_Probes[i];
+		if (pProbe->Name == NULL){
+			continue;
+		}
+		uint32_t mean = (pProbe->Count == 0) ? 0 : (uint32_t)(pProbe->Total / pProbe->Count);
+		printf("%-18s %8lu %9lu %9lu %9lu\n", pProbe->Name,
+		       (unsigned long)pProbe->Count, (unsigned long)pProbe->Min,
+		       (unsigned long)pProbe->Max, (unsigned long)mean);
+	}
+}
+
+/*
+ * printf backend
+ * syscalls.c: printf -> _write -> __io_putchar (declared weak there, never defined until now,
+ * so any printf used to jump to address 0 and HardFault).
+ *
+ * Characters go out through ITM stimulus port 0 -> SWO pin -> ST-LINK -> "SWV ITM Data Console".
+ * If no debugger has enabled tracing (TCR.ITMENA and TER bit 0), the character is dropped
+ * instead of waiting forever, so printing is safe on a board running without a probe.
+ */
+int __io_putchar(int ch){
+	if ((*ITM_TCR_ADDR & (1U << 0)) && (*ITM_TER_ADDR & (1U << 0))){
+		while (*ITM_STIM0_ADDR == 0); // reads 1 when the port FIFO can take another write
+		*(volatile uint8_t*)ITM_STIM0_ADDR = (uint8_t)ch;
+	}
+	return ch;
+}
@@ -0,0 +1,173 @@
+/*
+ * stm32f446xx_prof_driver.h
+ *
+ *  Created on: 2026/1/17
+ *      Author: Yuheng
+ *
+ * Description:
+ * Cycle-accurate profiling on top of the Cortex-M4 DWT cycle counter (CYCCNT).
+ *
+ * Why?
+ * "How long does GPIO_Init take?" or "How long does the button ISR block the CPU?"
+ * had no answer. Toggling a pin and looking at a scope works for one spot at a time.
+ * CYCCNT counts every core clock cycle (62.5 ns at 16 MHz), so wrapping code in
+ * a begin/end pair gives the exact cost in cycles.
+ *
+ * How it works:
+ * 1. Probe slots: a static table of PROF_MAX_PROBES entries. The application picks
+ *    a slot ID for each spot it wants to measure and gives it a name (PROF_Register).
+ * 2. PROF_BEGIN(id) stores CYCCNT, PROF_END(id) takes the difference and updates
+ *    count / min / max / total. Both are inline: a few cycles per probe, so they can
+ *    stay in production builds. The cost of an empty BEGIN/END pair is measured once
+ *    in PROF_Init and subtracted from every sample.
+ * 3. PROF_SCOPE(id) profiles until the end of the current { } block (GCC cleanup attribute).
+ * 4. PROF_Dump() prints the table with printf -> _write (syscalls.c) -> __io_putchar,
+ *    which sends the characters out through the ITM on the SWO pin (ST-LINK SWV console).
+ *
+ * Rules:
+ * - One slot = one call site context. Do not use the same slot from main AND an ISR
+ *   (the ISR could overwrite the start stamp of the main-loop measurement).
+ * - CYCCNT is 32 bits: one measurement must be shorter than 2^32 cycles (268 s at 16 MHz).
+ * - CYCCNT stops while the core sleeps (WFI), so time spent in IDLE_Sleep is not counted.
+ *
+ * Refer to PM0214 - DWT / ITM are described in the ARMv7-M Architecture Reference Manual (C1.8, C1.7)
+ */
+
+#ifndef SOURCES_STM32F446XX_PROF_DRIVER_H_
+#define SOURCES_STM32F446XX_PROF_DRIVER_H_
+
+#include <stdint.h>
+
+/*
+ * ==========================================
+ * 1. Core Debug Register Definitions
+ * ==========================================
+ */
+
+/*
+ * DWT (Data Watchpoint and Trace): only CYCCNT is used.
+ */
+typedef struct{
+	volatile uint32_t CTRL;   // control register,     offset: 0x00 (bit 0 CYCCNTENA)
+	volatile uint32_t CYCCNT; // cycle count register, offset: 0x04
+} DWT_RegDef_t;
+
+#define DWT_BASEADDR            0xE0001000U
+#define DWT                     ((DWT_RegDef_t*)DWT_BASEADDR)
+#define DEMCR_ADDR              ((volatile uint32_t*)0xE000EDFCU) // bit 24 TRCENA enables DWT and ITM
+
+/*
+ * ITM (Instrumentation Trace Macrocell): stimulus port 0 = printf channel on SWO
+ * STIM[0] offset 0x000, TER (trace enable) offset 0xE00, TCR (trace control) offset 0xE80
+ */
+#define ITM_STIM0_ADDR          ((volatile uint32_t*)0xE0000000U)
+#define ITM_TER_ADDR            ((volatile uint32_t*)0xE0000E00U)
+#define ITM_TCR_ADDR            ((volatile uint32_t*)0xE0000E80U)
+
+/*
+ * ==========================================
+ * 2. Configuration
+ * ==========================================
+ */
+#define PROF_MAX_PROBES         8
+
+/*
+ * Set to 0 (e.g. -DPROF_ENABLED=0) to compile every probe away completely.
+ */
+#ifndef PROF_ENABLED
+#define PROF_ENABLED            1
+#endif
+
+/*
+ * One probe slot
+ * Mean is not stored: Total / Count, computed when printing.
+ */
+typedef struct{
+	const char *Name;       // set by PROF_Register, NULL = slot unused
+	uint32_t Start;         // CYCCNT at PROF_BEGIN
+	uint32_t Count;         // number of completed measurements
+	uint32_t Min;           // cycles
+	uint32_t Max;           // cycles
+	uint64_t Total;         // cycles, 64-bit so it never overflows in practice
+} PROF_Probe_t;
+
+/*
+ * The table is global on purpose: it can be read directly in the debugger
+ * (Expressions window -> PROF_Probes), and the inline probes need it.
+ */
+extern PROF_Probe_t PROF_Probes[PROF_MAX_PROBES];
+extern uint32_t PROF_Overhead;
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Enable the cycle counter and measure the cost of an empty probe pair.
+ * Call once, before the first probe.
+ */
+void PROF_Init(void);
+
+/*
+ * Give slot 'Id' a name and clear its statistics.
+ */
+void PROF_Register(uint8_t Id, const char *Name);
+
+/*
+ * Clear the statistics of every registered slot (names are kept).
+ */
+void PROF_Reset(void);
+
+/*
+ * Print every registered slot: name, count, min, max, mean (cycles).
+ */
+void PROF_Dump(void);
+
+/*
+ * ==========================================
+ * 4. Probes
+ * ==========================================
+ * static inline: no call overhead, the compiler folds 'Id' into an address.
+ */
+static inline void PROF_Begin(uint8_t Id){
+	PROF_Probes[Id].Start = DWT->CYCCNT;
+}
+
+static inline void PROF_End(uint8_t Id){
+	PROF_Probe_t *pProbe = &PROF_Probes[Id];
+	uint32_t cycles = DWT->CYCCNT - pProbe->Start; // unsigned: correct across the 32-bit wrap
+
+	cycles = (cycles > PROF_Overhead) ? (cycles - PROF_Overhead) : 0;
+
+	if (pProbe->Count == 0 || cycles < pProbe->Min){
+		pProbe->Min = cycles;
+	}
+	if (cycles > pProbe->Max){
+		pProbe->Max = cycles;
+	}
+	pProbe->Total += cycles;
+	pProbe->Count++;
+}
+
+/*
+ * Scoped probe: measures from this line to the closing } of the block.
+ * The cleanup attribute makes GCC call PROF_ScopeEnd on every exit path (including return).
+ */
+static inline void PROF_ScopeEnd(uint8_t *pId){
+	PROF_End(*pId);
+}
+
+#if PROF_ENABLED
+#define PROF_BEGIN(Id)      PROF_Begin(Id)
+#define PROF_END(Id)        PROF_End(Id)
+#define PROF_SCOPE(Id)      uint8_t prof_scope_id_ __attribute__((cleanup(PROF_ScopeEnd))) = (Id); \
+                            PROF_Begin(Id)
+#else
+#define PROF_BEGIN(Id)      ((void)0)
+#define PROF_END(Id)        ((void)0)
+#define PROF_SCOPE(Id)      ((void)0)
+#endif
+
+#endif /* SOURCES_STM32F446XX_PROF_DRIVER_H_ */
@@ -0,0 +1,180 @@
+/*
+ * stm32f446xx_timebase_driver.c
+ *
+ *  Created on: 2026/1/16
+ *      Author: Yuheng
+ */
+#include "stm32f446xx_timebase_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Microseconds elapsed when CNT was last 0.
+ * Current time = BaseUs + CNT.
+ * The overflow interrupt adds 2^32 every time CNT wraps.
+ */
+static volatile uint64_t BaseUs;
+
+static TIMEBASE_AlarmCallback_t AlarmCallback;
+
+/*
+ * Interrupt masking that can be nested (safe to call from an ISR or with
+ * interrupts already disabled): save PRIMASK, disable, later restore the saved value.
+ */
+static uint32_t TIMEBASE_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void TIMEBASE_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/*
+ * Current time, must be called with interrupts masked.
+ * If CNT wrapped but the overflow ISR has not run yet (we are in a higher-priority
+ * ISR, or interrupts are masked), UIF is still set: account for that wrap here,
+ * and re-read CNT so the value is guaranteed to be from after the wrap.
+ */
+static uint64_t TIMEBASE_ReadLocked(void){
+	uint64_t base = BaseUs;
+	uint32_t cnt = TIMEBASE_TIM->CNT;
+
+	if (TIMEBASE_TIM->SR & (1U << 0)){
+		cnt = TIMEBASE_TIM->CNT;
+		base += (1ULL << 32);
+	}
+	return base + cnt;
+}
+
+void TIMEBASE_Init(void){
+	TIM5_PCLK_EN();
+
+	BaseUs = 0;
+	TIMEBASE_TIM->CR1 = 0;
+	TIMEBASE_TIM->PSC = (TIMEBASE_TIMER_CLOCK_HZ / TIMEBASE_TICK_HZ) - 1U; // 16 MHz / 16 = 1 MHz
+	TIMEBASE_TIM->ARR = 0xFFFFFFFFU; // free-running over the full 32 bits
+
+	/*
+	 * CR1 bit 2 URS (Update Request Source) = 1:
+	 * only a real overflow raises UIF / the interrupt.
+	 * The software update (EGR UG) below stays silent.
+	 */
+	TIMEBASE_TIM->CR1 |= (1U << 2);
+
+	// EGR bit 0 UG: load PSC now (it is preloaded) and reset CNT to 0
+	TIMEBASE_TIM->EGR |= (1U << 0);
+	TIMEBASE_TIM->SR = 0;
+
+	// DIER bit 0 UIE: overflow interrupt (once every ~71.6 minutes)
+	TIMEBASE_TIM->DIER |= (1U << 0);
+	NVIC_ISER_Config(TIMEBASE_IRQ);
+
+	TIMEBASE_TIM->CR1 |= (1U << 0); // CEN
+}
+
+uint64_t TIMEBASE_GetTicksUs64(void){
+	uint32_t primask = TIMEBASE_EnterCritical();
+	uint64_t now = TIMEBASE_ReadLocked();
+	TIMEBASE_ExitCritical(primask);
+	return now;
+}
+
+uint32_t get_ticks_us(void){
+	// The overflow only adds 2^32 to BaseUs, so the low 32 bits are simply CNT: one register read
+	return TIMEBASE_TIM->CNT;
+}
+
+uint32_t get_ticks_ms(void){
+	// Divide the 64-bit value: dividing the wrapping 32-bit us count would jump at the wrap
+	return (uint32_t)(TIMEBASE_GetTicksUs64() / 1000U);
+}
+
+uint8_t timeout_expired_ms(uint32_t Start, uint32_t Timeout){
+	return ((uint32_t)(get_ticks_ms() - Start) >= Timeout);
+}
+
+uint8_t timeout_expired_us(uint32_t Start, uint32_t Timeout){
+	return ((uint32_t)(get_ticks_us() - Start) >= Timeout);
+}
+
+void delay_us(uint32_t Us){
+	/*
+	 * Start may be read just before CNT ticks, so waiting for "elapsed > Us"
+	 * (not >=) guarantees AT LEAST Us microseconds.
+	 */
+	uint32_t start = get_ticks_us();
+	while ((uint32_t)(get_ticks_us() - start) <= Us);
+}
+
+void delay_ms(uint32_t Ms){
+	uint64_t end = TIMEBASE_GetTicksUs64() + (uint64_t)Ms * 1000U + 1U;
+	while (TIMEBASE_GetTicksUs64() < end);
+}
+
+void TIMEBASE_SetAlarmCallback(TIMEBASE_AlarmCallback_t Callback){
+	AlarmCallback = Callback;
+}
+
+void TIMEBASE_SetAlarmUs(uint32_t DeadlineUs){
+	uint32_t primask = TIMEBASE_EnterCritical();
+
+	/*
+	 * CCMR1 CC1S = 00 (output) and OC1M = 000 (frozen) after reset:
+	 * the compare only sets CC1IF, the channel has no pin.
+	 * CCR1 is not preloaded (OC1PE = 0), so the new value is active at once.
+	 */
+	TIMEBASE_TIM->CCR1 = DeadlineUs;
+	TIMEBASE_TIM->SR = ~(1U << 1); // drop a stale CC1IF
+
+	/*
+	 * The compare only matches when CNT passes CCR1. If the deadline is already
+	 * reached (or CNT moved past it while we were writing), force the event:
+	 * EGR bit 1 CC1G sets CC1IF by software.
+	 */
+	if ((int32_t)(DeadlineUs - TIMEBASE_TIM->CNT) <= 0){
+		TIMEBASE_TIM->EGR = (1U << 1);
+	}
+
+	TIMEBASE_TIM->DIER |= (1U << 1); // CC1IE
+	TIMEBASE_ExitCritical(primask);
+}
+
+void TIMEBASE_CancelAlarm(void){
+	uint32_t primask = TIMEBASE_EnterCritical();
+	TIMEBASE_TIM->DIER &= ~(1U << 1);
+	TIMEBASE_TIM->SR = ~(1U << 1);
+	TIMEBASE_ExitCritical(primask);
+}
+
+/*
+ * Overflow: CNT went from 0xFFFFFFFF back to 0
+ * Masked, because a higher-priority ISR reading the time between "clear UIF"
+ * and "BaseUs += 2^32" would see the time jump back by 71 minutes.
+ */
+void TIM5_IRQHandler(void){
+	uint32_t primask = TIMEBASE_EnterCritical();
+
+	if (TIMEBASE_TIM->SR & (1U << 0)){
+		TIMEBASE_TIM->SR = ~(1U << 0); // rc_w0: write 0 to clear UIF, 1 leaves other flags untouched
+		BaseUs += (1ULL << 32);
+	}
+
+	// Alarm: one-shot, disarm before calling so the callback can re-arm it
+	uint8_t alarm = 0;
+	if ((TIMEBASE_TIM->SR & (1U << 1)) && (TIMEBASE_TIM->DIER & (1U << 1))){
+		TIMEBASE_TIM->DIER &= ~(1U << 1);
+		TIMEBASE_TIM->SR = ~(1U << 1);
+		alarm = 1;
+	}
+
+	TIMEBASE_ExitCritical(primask);
+
+	// Outside the masked section: the callback may take a while
+	if (alarm && AlarmCallback != NULL){
+		AlarmCallback();
+	}
+}
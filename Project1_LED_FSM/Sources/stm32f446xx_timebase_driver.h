@@ -0,0 +1,147 @@
+/*
+ * stm32f446xx_timebase_driver.h
+ *
+ *  Created on: 2026/1/16
+ *      Author: Yuheng
+ *
+ * Description:
+ * Monotonic time base (milliseconds / microseconds) built on TIM5.
+ *
+ * Why not software_delay()?
+ * software_delay(count) is a busy loop: how long "count" takes depends on the
+ * optimization level (-O0 vs -O2), on flash wait states / ART, and on the CPU clock.
+ * The old "500000 ~ 125ms" estimate was only right for one build at 16 MHz.
+ *
+ * Why TIM5 and not SysTick?
+ * - TIM5 has a 32-bit counter. Running it at 1 MHz gives 1 us per count and it only
+ *   wraps every ~71.6 minutes, so reading the time is ONE register read (CNT).
+ * - SysTick is 24-bit and would need a 1 kHz interrupt to build a millisecond counter.
+ *   That interrupt wakes the CPU every millisecond and breaks tickless idle.
+ * - SysTick is already the one-shot wake-up timer of the tickless idle driver.
+ * The only periodic interrupt is the overflow every 2^32 us, used to extend the count to 64 bits.
+ * Channel 1 (output compare, no pin) provides ONE one-shot alarm, see Section 4.
+ * TIM5 keeps counting in Sleep mode (WFI), so time stays correct across IDLE_Sleep().
+ *
+ * Wrap-around rule:
+ * get_ticks_ms()/get_ticks_us() are 32-bit and wrap. ALWAYS compare with subtraction:
+ *   if ((get_ticks_ms() - start) >= timeout)   -> correct across the wrap
+ *   if (get_ticks_ms() >= start + timeout)     -> WRONG near the wrap
+ * timeout_expired_ms()/timeout_expired_us() do this for you.
+ *
+ * Refer to RM0390 - 18 General-purpose timers (TIM2 to TIM5)
+ */
+
+#ifndef SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_
+#define SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx_gpio_driver.h"
+
+/*
+ * ==========================================
+ * 1. TIM5 Register Definitions
+ * ==========================================
+ * This project has no timer driver, so only what the time base needs lives here.
+ * Refer to RM0390 - 18.4.21 TIMx register map
+ */
+typedef struct {
+    volatile uint32_t CR1;      // Control register 1,              Offset: 0x00
+    volatile uint32_t CR2;      // Control register 2,              Offset: 0x04
+    volatile uint32_t SMCR;     // Slave mode control register,     Offset: 0x08
+    volatile uint32_t DIER;     // DMA/Interrupt enable register,   Offset: 0x0C
+    volatile uint32_t SR;       // Status register,                 Offset: 0x10
+    volatile uint32_t EGR;      // Event generation register,       Offset: 0x14
+    volatile uint32_t CCMR1;    // Capture/compare mode register 1, Offset: 0x18
+    volatile uint32_t CCMR2;    // Capture/compare mode register 2, Offset: 0x1C
+    volatile uint32_t CCER;     // Capture/compare enable register, Offset: 0x20
+    volatile uint32_t CNT;      // Counter,                         Offset: 0x24
+    volatile uint32_t PSC;      // Prescaler,                       Offset: 0x28
+    volatile uint32_t ARR;      // Auto-reload register,            Offset: 0x2C
+    volatile uint32_t Reserved1;//                                  Offset: 0x30
+    volatile uint32_t CCR1;     // Capture/compare register 1,      Offset: 0x34 (alarm)
+} TIM_RegDef_t;
+
+#define TIM5_BASEADDR       (0x40000C00U) // APB1
+#define TIM5                ((TIM_RegDef_t*)TIM5_BASEADDR)
+#define TIM5_IRQ            (50)          // RM0390 Vector Table (Position 50)
+
+// TIM5 clock: bit 3 of RCC_APB1ENR (offset 0x40)
+#define RCC_APB1ENR_OFFSET  0x40U
+#define RCC_APB1ENR_ADDR    (RCC_BASEADDR + RCC_APB1ENR_OFFSET)
+#define TIM5_PCLK_EN()      ( *(volatile uint32_t*)(RCC_APB1ENR_ADDR) |= (1 << 3) )
+
+/*
+ * ==========================================
+ * 2. Configuration
+ * ==========================================
+ * The core runs from HSI (16 MHz) and the APB1 prescaler is 1 after reset,
+ * so TIM5 is clocked at 16 MHz -> PSC = 15 for 1 MHz.
+ */
+#define TIMEBASE_TIM            TIM5
+#define TIMEBASE_IRQ            TIM5_IRQ
+#define TIMEBASE_TIMER_CLOCK_HZ 16000000U
+#define TIMEBASE_TICK_HZ        1000000U    // 1 count = 1 us
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Start the time base (counts from 0).
+ * Call once at startup.
+ */
+void TIMEBASE_Init(void);
+
+/*
+ * Time since TIMEBASE_Init.
+ * 64-bit version never wraps (584 000 years), the 32-bit versions wrap
+ * (us after ~71.6 min, ms after ~49.7 days), see the wrap-around rule above.
+ * Safe to call from interrupts.
+ */
+uint64_t TIMEBASE_GetTicksUs64(void);
+uint32_t get_ticks_us(void);
+uint32_t get_ticks_ms(void);
+
+/*
+ * Non-blocking deadline checks
+ * Returns 1 once at least Timeout has passed since Start, 0 otherwise.
+ * Usage:
+ *   uint32_t start = get_ticks_ms();
+ *   ...
+ *   if (timeout_expired_ms(start, 125)) { toggle; start += 125; }
+ */
+uint8_t timeout_expired_ms(uint32_t Start, uint32_t Timeout);
+uint8_t timeout_expired_us(uint32_t Start, uint32_t Timeout);
+
+/*
+ * Calibrated blocking delays
+ * Same duration at any optimization level and any clock.
+ * delay_us() busy-waits on the counter (resolution 1 us), so it also works inside an ISR.
+ */
+void delay_us(uint32_t Us);
+void delay_ms(uint32_t Ms);
+
+/*
+ * ==========================================
+ * 4. One-Shot Alarm
+ * ==========================================
+ * CCR1 is compared against CNT in hardware: when CNT reaches it, CC1IF is set and
+ * the TIM5 interrupt calls the alarm callback ONCE (the alarm then disarms itself).
+ * No interrupt at all until then, so it does not disturb tickless idle.
+ * There is a single alarm: modules that need several deadlines keep their own list
+ * and always program the earliest one (see stm32f446xx_debounce_driver.c).
+ */
+typedef void (*TIMEBASE_AlarmCallback_t)(void);
+
+void TIMEBASE_SetAlarmCallback(TIMEBASE_AlarmCallback_t Callback);
+
+/*
+ * Arm the alarm for get_ticks_us() == DeadlineUs (absolute, wraps like get_ticks_us).
+ * A deadline that is already reached fires right away. Re-arming replaces the old deadline.
+ */
+void TIMEBASE_SetAlarmUs(uint32_t DeadlineUs);
+void TIMEBASE_CancelAlarm(void);
+
+#endif /* SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_ */
@@ -0,0 +1,53 @@
+/*
+ * benchmark_art.h
+ *
+ * Created on: 2026/1/11
+ * Author: Yuheng
+ *
+ * Description:
+ * Flash ART Accelerator Benchmark.
+ * Only compiled into the "<project>_ART_Benchmark" build target (ART_BENCHMARK defined).
+ *
+ * What it measures (in CPU cycles, using the DWT cycle counter):
+ * 1. One call of GPIO_ToggleOutputPin(GPIOA, 5)           -> driver hot path
+ * 2. EXTI15_10_IRQHandler entry latency (software-triggered) -> ISR hot path
+ *
+ * ...once for each flash accelerator setting:
+ * all off / prefetch only / I+D cache only / everything on.
+ *
+ * How to read the results:
+ * There is no UART in this project, so results are kept in g_ARTBenchResults.
+ * Run the benchmark build in the debugger, break on ART_Benchmark_Done(),
+ * and add g_ARTBenchResults to the Expressions/Live Expressions view.
+ */
+
+#ifndef SOURCES_BENCHMARK_ART_H_
+#define SOURCES_BENCHMARK_ART_H_
+
+#include <stdint.h>
+
+#define ART_BENCH_ITERATIONS    1000U
+#define ART_BENCH_NUM_CONFIGS   4U
+
+typedef struct{
+	uint8_t  Prefetch;           // ENABLE or DISABLE
+	uint8_t  ICache;             // ENABLE or DISABLE
+	uint8_t  DCache;             // ENABLE or DISABLE
+	uint32_t ToggleCycles;       // average cycles per GPIO_ToggleOutputPin call
+	uint32_t IRQEntryCycles;     // average cycles from EXTI trigger to first ISR instruction
+} ART_BenchResult_t;
+
+extern volatile ART_BenchResult_t g_ARTBenchResults[ART_BENCH_NUM_CONFIGS];
+
+/*
+ * Runs all configurations, restores the full ART setting (all ENABLE)
+ * and then calls ART_Benchmark_Done().
+ */
+void ART_Benchmark_Run(void);
+
+/*
+ * Empty marker function: put a breakpoint here to inspect the results.
+ */
+void ART_Benchmark_Done(void);
+
+#endif /* SOURCES_BENCHMARK_ART_H_ */
@@ -0,0 +1,97 @@
+/*
+ * benchmark_gpio_init.c
+ *
+ *  Created on: 2026/1/25
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_gpio_driver.h"
+#include "benchmark_gpio_init.h"
+#include <stdint.h>
+
+volatile GPIO_BenchResult_t g_GPIOBenchResult;
+
+/*
+ * Configuration registers of a port (ODR / BSRR / LCKR are not touched by either path)
+ */
+typedef struct{
+	uint32_t MODER;
+	uint32_t OTYPER;
+	uint32_t OSPEEDR;
+	uint32_t PUPDR;
+	uint32_t AFR[2];
+} GPIO_PortState_t;
+
+static void GPIO_SaveState(GPIO_RegDef_t *pGPIOx, GPIO_PortState_t *pState){
+	pState->MODER = pGPIOx->MODER;
+	pState->OTYPER = pGPIOx->OTYPER;
+	pState->OSPEEDR = pGPIOx->OSPEEDR;
+	pState->PUPDR = pGPIOx->PUPDR;
+	pState->AFR[0] = pGPIOx->AFR[0];
+	pState->AFR[1] = pGPIOx->AFR[1];
+}
+
+static void GPIO_RestoreState(GPIO_RegDef_t *pGPIOx, const GPIO_PortState_t *pState){
+	pGPIOx->MODER = pState->MODER;
+	pGPIOx->OTYPER = pState->OTYPER;
+	pGPIOx->OSPEEDR = pState->OSPEEDR;
+	pGPIOx->PUPDR = pState->PUPDR;
+	pGPIOx->AFR[0] = pState->AFR[0];
+	pGPIOx->AFR[1] = pState->AFR[1];
+}
+
+void GPIO_Benchmark_Run(void){
+	GPIO_PortState_t original, per_pin, masked;
+	uint32_t start, per_pin_total = 0, mask_total = 0;
+
+	DWT_CycleCounterEnable();
+	GPIO_PeriClockControl(GPIOB, ENABLE);
+	GPIO_SaveState(GPIOB, &original);
+
+	// The bus: 16 pins, same settings
+	GPIO_Handle_t GPIO_Bus;
+	GPIO_Bus.pGPIOx = GPIOB;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinNumber = 0;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinMode = GPIO_MODE_IN;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinSpeed = GPIO_SPEED_VERY_HIGH;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinPuPdControl = GPIO_PIN_PD;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinOPType = GPIO_OP_TYPE_PP;
+	GPIO_Bus.GPIO_PinConfig.GPIO_PinAltFunMode = GPIO_AF_0;
+
+	/*
+	 * Every iteration starts from the original state, so both paths do the same
+	 * work every time (the restore itself is outside the measured window).
+	 */
+	for (uint32_t i = 0; i < GPIO_BENCH_ITERATIONS; i++){
+		GPIO_RestoreState(GPIOB, &original);
+		start = DWT->CYCCNT;
+		for (uint8_t pin = 0; pin < 16; pin++){
+			GPIO_Bus.GPIO_PinConfig.GPIO_PinNumber = pin;
+			GPIO_Init(&GPIO_Bus);
+		}
+		per_pin_total += DWT->CYCCNT - start;
+	}
+	GPIO_SaveState(GPIOB, &per_pin);
+
+	for (uint32_t i = 0; i < GPIO_BENCH_ITERATIONS; i++){
+		GPIO_RestoreState(GPIOB, &original);
+		start = DWT->CYCCNT;
+		GPIO_InitMask(GPIOB, 0xFFFFU, &GPIO_Bus.GPIO_PinConfig);
+		mask_total += DWT->CYCCNT - start;
+	}
+	GPIO_SaveState(GPIOB, &masked);
+
+	GPIO_RestoreState(GPIOB, &original);
+	GPIO_PeriClockControl(GPIOB, DISABLE);
+
+	g_GPIOBenchResult.PerPinCycles = per_pin_total / GPIO_BENCH_ITERATIONS;
+	g_GPIOBenchResult.MaskCycles = mask_total / GPIO_BENCH_ITERATIONS;
+	g_GPIOBenchResult.SameResult = (per_pin.MODER == masked.MODER && per_pin.OTYPER == masked.OTYPER &&
+	                                per_pin.OSPEEDR == masked.OSPEEDR && per_pin.PUPDR == masked.PUPDR &&
+	                                per_pin.AFR[0] == masked.AFR[0] && per_pin.AFR[1] == masked.AFR[1]);
+	GPIO_Benchmark_Done();
+}
+
+void GPIO_Benchmark_Done(void){
+	// Breakpoint here -> inspect g_GPIOBenchResult
+}
@@ -0,0 +1,54 @@
+/*
+ * benchmark_gpio_init.h
+ *
+ * Created on: 2026/1/25
+ * Author: Yuheng
+ *
+ * Description:
+ * GPIO bring-up benchmark: GPIO_Init pin by pin vs GPIO_InitMask.
+ * Only compiled into the "<project>_GPIO_Benchmark" build target (GPIO_BENCHMARK defined).
+ *
+ * What it measures (in CPU cycles, using the DWT cycle counter):
+ * Configuring all 16 pins of GPIOB as a bus (same settings on every pin)
+ * 1. with 16 calls of GPIO_Init            -> one RMW per register per pin
+ * 2. with one call of GPIO_InitMask(0xFFFF) -> one read + one write per register
+ * Both runs start from the same register state, and the resulting registers are
+ * compared: the two paths must configure the port identically.
+ *
+ * GPIOB pins are set up as inputs with pull-down (nothing is driven, safe on any board),
+ * and the port is restored afterwards. The mode does not change the cost: the same
+ * registers are written either way.
+ *
+ * How to read the results:
+ * There is no UART in this project, so results are kept in g_GPIOBenchResult.
+ * Run the benchmark build in the debugger, break on GPIO_Benchmark_Done(),
+ * and add g_GPIOBenchResult to the Expressions/Live Expressions view.
+ * Cycles / 180 = microseconds of boot time at 180 MHz.
+ */
+
+#ifndef SOURCES_BENCHMARK_GPIO_INIT_H_
+#define SOURCES_BENCHMARK_GPIO_INIT_H_
+
+#include <stdint.h>
+
+#define GPIO_BENCH_ITERATIONS   100U
+
+typedef struct{
+	uint32_t PerPinCycles;       // average cycles for 16 x GPIO_Init
+	uint32_t MaskCycles;         // average cycles for 1 x GPIO_InitMask
+	uint8_t  SameResult;         // 1: both paths left identical MODER/OTYPER/OSPEEDR/PUPDR/AFR
+} GPIO_BenchResult_t;
+
+extern volatile GPIO_BenchResult_t g_GPIOBenchResult;
+
+/*
+ * Runs both measurements, restores GPIOB and then calls GPIO_Benchmark_Done().
+ */
+void GPIO_Benchmark_Run(void);
+
+/*
+ * Empty marker function: put a breakpoint here to inspect the results.
+ */
+void GPIO_Benchmark_Done(void);
+
+#endif /* SOURCES_BENCHMARK_GPIO_INIT_H_ */
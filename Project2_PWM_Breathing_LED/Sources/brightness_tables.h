@@ -0,0 +1,75 @@
+/*
+ * brightness_tables.h
+ *
+ * GENERATED by Tools/gen_brightness_tables.py -- do not edit by hand.
+ * Parameters: --length 100 --gamma 2.2
+ *
+ * Every table is a list macro: LEDTABLE_xxx(SCALE) expands to
+ * SCALE(q0), SCALE(q1), ... with q in Q16 (65536 = 100 % duty).
+ * Use LEDTABLE_Q16_TO_CCR as SCALE to get CCR values for a given ARR,
+ * evaluated by the compiler (the table ends up in flash, zero runtime math).
+ */
+
+#ifndef SOURCES_BRIGHTNESS_TABLES_H_
+#define SOURCES_BRIGHTNESS_TABLES_H_
+
+#include <stdint.h>
+
+#define LEDTABLE_LENGTH         100U
+#define LEDTABLE_GAMMA_X10      22U   // gamma of LEDTABLE_GAMMA, times 10
+
+/*
+ * Q16 fraction -> CCR value for a timer with period ARR (full on = ARR + 1), rounded.
+ */
+#define LEDTABLE_Q16_TO_CCR(Q16, ARR) \
+	((uint32_t)((((uint64_t)(Q16) * ((uint64_t)(ARR) + 1U)) + 0x8000U) >> 16))
+
+/* Ramp 0 -> 100 %, duty = x ^ 2.2 */
+#define LEDTABLE_GAMMA(SCALE) \
+	SCALE(    0), SCALE(    3), SCALE(   12), SCALE(   30), SCALE(   56), SCALE(   92), SCALE(  137), SCALE(  193), \
+	SCALE(  259), SCALE(  335), SCALE(  423), SCALE(  521), SCALE(  631), SCALE(  753), SCALE(  886), SCALE( 1032), \
+	SCALE( 1189), SCALE( 1359), SCALE( 1541), SCALE( 1735), SCALE( 1942), SCALE( 2163), SCALE( 2396), SCALE( 2642), \
+	SCALE( 2901), SCALE( 3174), SCALE( 3460), SCALE( 3759), SCALE( 4072), SCALE( 4399), SCALE( 4740), SCALE( 5094), \
+	SCALE( 5463), SCALE( 5845), SCALE( 6242), SCALE( 6653), SCALE( 7079), SCALE( 7518), SCALE( 7973), SCALE( 8442), \
+	SCALE( 8925), SCALE( 9423), SCALE( 9936), SCALE(10464), SCALE(11007), SCALE(11565), SCALE(12138), SCALE(12726), \
+	SCALE(13329), SCALE(13948), SCALE(14582), SCALE(15231), SCALE(15896), SCALE(16576), SCALE(17272), SCALE(17984), \
+	SCALE(18711), SCALE(19454), SCALE(20213), SCALE(20987), SCALE(21778), SCALE(22584), SCALE(23407), SCALE(24246), \
+	SCALE(25100), SCALE(25971), SCALE(26858), SCALE(27762), SCALE(28682), SCALE(29618), SCALE(30570), SCALE(31539), \
+	SCALE(32525), SCALE(33527), SCALE(34546), SCALE(35581), SCALE(36633), SCALE(37702), SCALE(38787), SCALE(39890), \
+	SCALE(41009), SCALE(42145), SCALE(43299), SCALE(44469), SCALE(45656), SCALE(46860), SCALE(48082), SCALE(49320), \
+	SCALE(50576), SCALE(51849), SCALE(53139), SCALE(54447), SCALE(55772), SCALE(57114), SCALE(58474), SCALE(59851), \
+	SCALE(61246), SCALE(62659), SCALE(64088), SCALE(65536),
+
+/* Ramp 0 -> 100 %, equal steps of CIE 1931 lightness */
+#define LEDTABLE_CIE1931(SCALE) \
+	SCALE(    0), SCALE(   73), SCALE(  147), SCALE(  220), SCALE(  293), SCALE(  366), SCALE(  440), SCALE(  513), \
+	SCALE(  586), SCALE(  663), SCALE(  747), SCALE(  837), SCALE(  934), SCALE( 1038), SCALE( 1150), SCALE( 1269), \
+	SCALE( 1397), SCALE( 1533), SCALE( 1677), SCALE( 1830), SCALE( 1992), SCALE( 2164), SCALE( 2345), SCALE( 2535), \
+	SCALE( 2736), SCALE( 2948), SCALE( 3169), SCALE( 3402), SCALE( 3646), SCALE( 3901), SCALE( 4168), SCALE( 4447), \
+	SCALE( 4738), SCALE( 5041), SCALE( 5357), SCALE( 5686), SCALE( 6028), SCALE( 6384), SCALE( 6753), SCALE( 7137), \
+	SCALE( 7534), SCALE( 7946), SCALE( 8373), SCALE( 8815), SCALE( 9272), SCALE( 9745), SCALE(10233), SCALE(10738), \
+	SCALE(11258), SCALE(11796), SCALE(12350), SCALE(12921), SCALE(13510), SCALE(14116), SCALE(14741), SCALE(15383), \
+	SCALE(16044), SCALE(16723), SCALE(17421), SCALE(18139), SCALE(18875), SCALE(19632), SCALE(20408), SCALE(21205), \
+	SCALE(22022), SCALE(22860), SCALE(23719), SCALE(24599), SCALE(25501), SCALE(26424), SCALE(27370), SCALE(28337), \
+	SCALE(29328), SCALE(30341), SCALE(31377), SCALE(32436), SCALE(33519), SCALE(34626), SCALE(35757), SCALE(36913), \
+	SCALE(38093), SCALE(39297), SCALE(40527), SCALE(41783), SCALE(43064), SCALE(44371), SCALE(45704), SCALE(47064), \
+	SCALE(48450), SCALE(49863), SCALE(51304), SCALE(52772), SCALE(54268), SCALE(55791), SCALE(57343), SCALE(58924), \
+	SCALE(60533), SCALE(62171), SCALE(63839), SCALE(65536),
+
+/* One full breath dark -> bright -> dark, raised-cosine lightness (CIE 1931 corrected) */
+#define LEDTABLE_SINE_BREATH(SCALE) \
+	SCALE(    0), SCALE(    7), SCALE(   29), SCALE(   64), SCALE(  114), SCALE(  178), SCALE(  255), SCALE(  345), \
+	SCALE(  449), SCALE(  565), SCALE(  700), SCALE(  871), SCALE( 1084), SCALE( 1347), SCALE( 1669), SCALE( 2060), \
+	SCALE( 2531), SCALE( 3091), SCALE( 3753), SCALE( 4526), SCALE( 5423), SCALE( 6453), SCALE( 7625), SCALE( 8949), \
+	SCALE(10429), SCALE(12071), SCALE(13877), SCALE(15846), SCALE(17976), SCALE(20259), SCALE(22688), SCALE(25248), \
+	SCALE(27924), SCALE(30697), SCALE(33545), SCALE(36442), SCALE(39361), SCALE(42273), SCALE(45146), SCALE(47948), \
+	SCALE(50647), SCALE(53209), SCALE(55603), SCALE(57797), SCALE(59763), SCALE(61475), SCALE(62909), SCALE(64046), \
+	SCALE(64870), SCALE(65369), SCALE(65536), SCALE(65369), SCALE(64870), SCALE(64046), SCALE(62909), SCALE(61475), \
+	SCALE(59763), SCALE(57797), SCALE(55603), SCALE(53209), SCALE(50647), SCALE(47948), SCALE(45146), SCALE(42273), \
+	SCALE(39361), SCALE(36442), SCALE(33545), SCALE(30697), SCALE(27924), SCALE(25248), SCALE(22688), SCALE(20259), \
+	SCALE(17976), SCALE(15846), SCALE(13877), SCALE(12071), SCALE(10429), SCALE( 8949), SCALE( 7625), SCALE( 6453), \
+	SCALE( 5423), SCALE( 4526), SCALE( 3753), SCALE( 3091), SCALE( 2531), SCALE( 2060), SCALE( 1669), SCALE( 1347), \
+	SCALE( 1084), SCALE(  871), SCALE(  700), SCALE(  565), SCALE(  449), SCALE(  345), SCALE(  255), SCALE(  178), \
+	SCALE(  114), SCALE(   64), SCALE(   29), SCALE(    7),
+
+#endif /* SOURCES_BRIGHTNESS_TABLES_H_ */
@@ -20,6 +20,18 @@
 #include "stm32f446xx.h"
 #include "stm32f446xx_gpio_driver.h"
 #include "stm32f446xx_timer_driver.h"
+#include "stm32f446xx_rcc_driver.h"
+#include "stm32f446xx_timebase_driver.h"
+#include "stm32f446xx_swtimer_driver.h"
+#include "stm32f446xx_dma_driver.h"
+#include "stm32f446xx_sequencer_driver.h"
+#include "brightness_tables.h"
+#ifdef ART_BENCHMARK
+#include "benchmark_art.h"
+#endif
+#ifdef GPIO_BENCHMARK
+#include "benchmark_gpio_init.h"
+#endif
 
 #if !defined(__SOFT_FP__) && defined(__ARM_FP)
   #warning "FPU is not initialized, but the project is compiling for an FPU. Please initialize the FPU before use."
@@ -28,12 +40,81 @@
 // Project 2: PWM Breathing LED
 // We will use TIM2 Channel 1 (connected to PA5)
 
-void software_delay(uint32_t count){
-    for(uint32_t i = 0; i < count; i++);
+/*
+ * PWM Requirements
+ * PSC/ARR are solved at compile time from these (see stm32f446xx_timer_driver.h).
+ * If the clock plan in stm32f446xx_rcc_driver.h ever changes so that 1 kHz with
+ * 1000 steps is no longer reachable within 100 ppm, the build fails right here.
+ */
+#define PWM_FREQ_HZ         1000U
+#define PWM_MIN_STEPS       1000U
+#define PWM_TOLERANCE_PPM   100U
+TIM_ASSERT_SOLVABLE(SYSINIT_TIMCLK1_HZ, PWM_FREQ_HZ, PWM_MIN_STEPS, TIM_ARR_MAX_32BIT, PWM_TOLERANCE_PPM);
+#define PWM_PSC             TIM_CALC_PSC(SYSINIT_TIMCLK1_HZ, PWM_FREQ_HZ, PWM_MIN_STEPS, TIM_ARR_MAX_32BIT, PWM_TOLERANCE_PPM) // 89
+#define PWM_ARR             TIM_CALC_ARR(SYSINIT_TIMCLK1_HZ, PWM_FREQ_HZ, PWM_MIN_STEPS, TIM_ARR_MAX_32BIT, PWM_TOLERANCE_PPM) // 999
+
+// The software timers tick on the TIM2 update event, i.e. once per PWM period
+_Static_assert(PWM_FREQ_HZ == SWTIMER_TICK_HZ, "SWTIMER_TICK_HZ must match the TIM2 update rate");
+
+/*
+ * Breathing curve
+ * A linear ramp looks wrong: the eye is far more sensitive to changes in the dark,
+ * so the LED seems to jump up quickly and then hang at "bright".
+ * LEDTABLE_SINE_BREATH (generated by Tools/gen_brightness_tables.py) eases in and out
+ * like a sine AND corrects every step for perception (CIE 1931).
+ * The generator stores fractions (Q16); they become CCR values for OUR ARR right here,
+ * at compile time. Change PSC/ARR and the table follows, no runtime math.
+ */
+#define BREATH_PERIOD_MS            1000U   // one full breath
+#define BREATH_UPDATES_PER_SAMPLE   ((BREATH_PERIOD_MS * PWM_FREQ_HZ) / (1000U * LEDTABLE_LENGTH))
+_Static_assert(BREATH_UPDATES_PER_SAMPLE >= 1, "breath too short for this table length");
+
+#define BREATH_SCALE(Q16)           LEDTABLE_Q16_TO_CCR(Q16, PWM_ARR)
+
+static const uint32_t BreathTable[LEDTABLE_LENGTH] = {
+	LEDTABLE_SINE_BREATH(BREATH_SCALE)
+};
+
+/*
+ * Breathing mode
+ * BREATH_MODE_DMA:       DMA waveform playback, the table is streamed into CCR1 by DMA1 (zero CPU)
+ * BREATH_MODE_SEQUENCER: the TIM2 update interrupt steps through the table (pause/speed/callback)
+ * BREATH_MODE_SOFTWARE:  one table entry per step from the software timer wheel (PendSV)
+ */
+#define BREATH_MODE_SOFTWARE    0
+#define BREATH_MODE_DMA         1
+#define BREATH_MODE_SEQUENCER   2
+
+#ifndef BREATH_MODE
+#define BREATH_MODE         BREATH_MODE_DMA
+#endif
+
+#if BREATH_MODE == BREATH_MODE_SEQUENCER
+static SEQ_t BreathSequencer;
+#elif BREATH_MODE == BREATH_MODE_SOFTWARE
+static SWTIMER_t FadeTimer;
+static uint32_t FadeIndex;
+
+/*
+ * Fade step: runs every BREATH_UPDATES_PER_SAMPLE ticks from the software timer wheel
+ * (PendSV context). One indexed load per step.
+ */
+static void Fade_Step(void *pArg){
+	(void)pArg;
+
+	TIM_SetCompare(TIM2, 1, BreathTable[FadeIndex]); // Modify CCR1 register
+	FadeIndex++;
+	if (FadeIndex >= LEDTABLE_LENGTH){
+		FadeIndex = 0; // next breath
+	}
 }
+#endif
 
 int main(void)
 {
+    // Monotonic ms/us time base on TIM5 (see stm32f446xx_timebase_driver.h)
+    TIMEBASE_Init();
+
 	/*
 	 * ==========================================
 	 * PA5 Alternate Function Configuration
@@ -59,6 +140,7 @@ int main(void)
 	 * We choose TIM2 (AF1) because it is a standard General Purpose Timer.
 	 * TIM8 requires complex configuration (BDTR - Break and Dead-time Register)
 	 * which is unnecessary for a simple LED breathing effect.
+	 * (Half-bridge / motor outputs that DO need it: TIM_CPWM_Init, timer driver Section 9.)
 	 *
 	 * Configuration:
 	 * Set PA5 Alternate Function Register (AFRL) to AF1 (0001).
@@ -80,12 +162,21 @@ int main(void)
     GPIO_PeriClockControl(GPIOA, ENABLE); // 1. Enable Port A Clock
     GPIO_Init(&GPIO_LED); // 2. Configure PA5 registers
 
+#ifdef ART_BENCHMARK
+    // Benchmark build only: flash accelerator cycle counts (see benchmark_art.h)
+    ART_Benchmark_Run();
+#endif
+#ifdef GPIO_BENCHMARK
+    // Benchmark build only: per-pin vs batched GPIO init cycle counts (see benchmark_gpio_init.h)
+    GPIO_Benchmark_Run();
+#endif
+
     // ==========================================
     // Enable TIM2 (Essential! Otherwise registers are locked)
     // ==========================================
-    TIM2_PCLK_EN(); // defined in timer_driver.h
+    TIM_PeriClockControl(TIM2, ENABLE); // reference-counted, see stm32f446xx_pclk_driver.h
 
-    TIM_Handle_t Timer2Handle;
+    TIM_Handle_t Timer2Handle = {0}; // CH2-CH4 stay disabled (Enable = 0)
     Timer2Handle.pTIMx = TIM2; // TIM2 is defined in stm32f446xx.h using its base address
     						   // as a TIM_RegDef_t type pointer
     /*
@@ -108,13 +199,17 @@ int main(void)
 	 *
 	 * Formula: PWM_Freq = System_Clk / ((PSC + 1) * (ARR + 1))
 	 *
-	 * - Step A: System Clock (Input)
-	 * Source: HSI (Internal RC Oscillator) = 16 MHz
+	 * - Step A: Timer Clock (Input)
+	 * SystemInit (rcc driver) runs the core at 180 MHz, APB1 = 45 MHz.
+	 * Because the APB1 prescaler is not 1, TIM2 gets 2 x PCLK1 = 90 MHz.
+	 * The compile-time solver reads this from SYSINIT_TIMCLK1_HZ instead of a
+	 * hard-coded number, so this keeps working if the clock plan changes
+	 * (it used to be 16 MHz HSI).
 	 *
 	 * - Step B: Prescaler (PSC) -> "The Gearbox"
-	 * We want to slow down the 16MHz clock to a simple 1MHz counting speed (1 us/tick).
-	 * Calculation: 16 MHz / 1 MHz = 16
-	 * Register Setting: PSC = 15 (because divider = PSC + 1)
+	 * We want to slow down the timer clock to a simple 1MHz counting speed (1 us/tick).
+	 * Calculation: 90 MHz / 1 MHz = 90
+	 * Register Setting: PSC = 89 (because divider = PSC + 1)
 	 *
 	 * - Step C: Auto-Reload Register (ARR) -> "The Cycle Length"
 	 * Now we have a 1MHz clock (1 tick = 1 us).
@@ -123,41 +218,75 @@ int main(void)
 	 *
 	 * Result: The Timer will reset every 1ms, creating a perfect 1kHz carrier frequency.
 	 */
-	Timer2Handle.TIM_Config.Prescaler = 15;
-	Timer2Handle.TIM_Config.Period = 999; // ARR
+	Timer2Handle.TIM_Config.Prescaler = PWM_PSC; // 89
+	Timer2Handle.TIM_Config.Period = PWM_ARR;    // ARR = 999
+
+	// Channel 1 -> PA5 (LED2): PWM mode 1, active high, preloaded, starts dark
+	Timer2Handle.TIM_Config.Channel[0].Enable = ENABLE;
+	Timer2Handle.TIM_Config.Channel[0].Mode = TIM_PWM_MODE1;
+	Timer2Handle.TIM_Config.Channel[0].Polarity = TIM_OC_POL_HIGH;
+	Timer2Handle.TIM_Config.Channel[0].Preload = ENABLE;
+	Timer2Handle.TIM_Config.Channel[0].InitialDuty = 0;
 
     // Must pass the ADDRESS (&) of the handle!
     // Because the function expects a pointer: void TIM_PWM_Init(TIM_Handle_t *pTIMHandle)
     TIM_PWM_Init(&Timer2Handle); // Initialize TIM2
 
     // ==========================================
-    // Part 3: The Breathing Loop (Duty Cycle Control)
+    // Part 3: The Breathing Timer (Duty Cycle Control)
     // ==========================================
+	/*
+	 * Understanding Capture/Compare (CCR):
+	 * CNT (Counter) is constantly counting: 0, 1, 2 ... 999 -> 0 ...
+	 * CCR1 determines the "Threshold".
+	 * * Logic (PWM Mode 1):
+	 * - If CNT < CCR1 -> Output HIGH (LED ON)
+	 * - If CNT >= CCR1 -> Output LOW (LED OFF)
+	 * * Example:
+	 * If CCR1 = 100 (and ARR=999):
+	 * LED is ON for counts 0-99 (10% of the time) -> Dim
+	 * If CCR1 = 900:
+	 * LED is ON for counts 0-899 (90% of the time) -> Bright
+	 *
+	 * The fade used to be a for loop with a blocking delay between steps.
+	 * DMA mode: the whole breath is a table in flash. Every 10th TIM2 update (100 entries,
+	 * 1 s per breath), DMA1 copies
+	 * the next entry into CCR1 (see TIM_Waveform_Start), in a loop, forever.
+	 * No interrupt at all -> the CPU sleeps through the animation.
+	 * Sequencer mode: the TIM2 update interrupt counts down 10 updates per entry and writes
+	 * the next one into CCR1 (see stm32f446xx_sequencer_driver.h); it can be paused or sped up.
+	 * Software mode: a periodic software timer, TIM2 update -> timing wheel -> Fade_Step.
+	 * In every mode, the main loop has nothing left to do.
+	 */
+#if BREATH_MODE == BREATH_MODE_DMA
+    DMA_PeriClockControl(DMA1, ENABLE);
+
+    TIM_Waveform_Handle_t BreathHandle;
+    BreathHandle.pTIMx = TIM2;
+    BreathHandle.Waveform_Config.pTable = BreathTable;
+    BreathHandle.Waveform_Config.Length = LEDTABLE_LENGTH;
+    BreathHandle.Waveform_Config.Channels = 1;
+    BreathHandle.Waveform_Config.UpdatesPerSample = BREATH_UPDATES_PER_SAMPLE;
+    BreathHandle.Waveform_Config.Circular = ENABLE;
+    BreathHandle.Waveform_Config.HalfCallback = NULL;
+    BreathHandle.Waveform_Config.CompleteCallback = NULL;
+    TIM_Waveform_Start(&BreathHandle);
+#elif BREATH_MODE == BREATH_MODE_SEQUENCER
+    SEQ_Init();
+    BreathSequencer.SEQ_Config.pFrames = BreathTable;
+    BreathSequencer.SEQ_Config.Length = LEDTABLE_LENGTH;
+    BreathSequencer.SEQ_Config.Channel = 1;
+    BreathSequencer.SEQ_Config.UpdatesPerFrame = BREATH_UPDATES_PER_SAMPLE;
+    BreathSequencer.SEQ_Config.Loop = ENABLE;
+    BreathSequencer.SEQ_Config.CompleteCallback = NULL;
+    SEQ_Start(&BreathSequencer);
+#else
+    SWTIMER_Init();
+    SWTIMER_Setup(&FadeTimer, Fade_Step, NULL);
+    SWTIMER_Start(&FadeTimer, BREATH_UPDATES_PER_SAMPLE, BREATH_UPDATES_PER_SAMPLE);
+#endif
+
     while (1){
-    	/*
-		 * Understanding Capture/Compare (CCR):
-		 * CNT (Counter) is constantly counting: 0, 1, 2 ... 999 -> 0 ...
-		 * CCR1 determines the "Threshold".
-		 * * Logic (PWM Mode 1):
-		 * - If CNT < CCR1 -> Output HIGH (LED ON)
-		 * - If CNT >= CCR1 -> Output LOW (LED OFF)
-		 * * Example:
-		 * If CCR1 = 100 (and ARR=999):
-		 * LED is ON for counts 0-99 (10% of the time) -> Dim
-		 * If CCR1 = 900:
-		 * LED is ON for counts 0-899 (90% of the time) -> Bright
-		 */
-
-    	// Phase 1: Fade In (0% -> 100%)
-    	for (int i = 0; i <= 999; i++){
-    		TIM_SetCompare1(TIM2, 100); // Modify CCR1 register
-    		software_delay(1000); // // Wait a bit so eyes can see the change
-    	}
-
-    	// Phase 2: Fade Out (100% -> 0%)
-    	for (int i = 999; i >= 0; i--){
-    		TIM_SetCompare1(TIM2, 100);
-    		software_delay(1000);
-    	}
+    	__asm volatile ("wfi"); // sleep until the next interrupt
     }
 }
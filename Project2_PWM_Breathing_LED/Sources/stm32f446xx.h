@@ -74,11 +74,33 @@
  */
 #define RCC_BASEADDR        (AHB1_BASEADDR + 0x3800U) //0x40023800
 
+/* Flash Interface Register Base Address.
+ * Not the flash memory itself (that lives at 0x08000000), but the controller
+ * in front of it. FLASH_ACR holds the wait states (LATENCY) that must be raised
+ * BEFORE the CPU clock goes above 30 MHz, otherwise instruction fetches fail.
+ */
+#define FLASH_R_BASEADDR    (AHB1_BASEADDR + 0x3C00U) //0x40023C00
+
+/* DMA Controllers
+ * Each controller has 8 streams; every stream moves data between a peripheral
+ * register and memory on its own, without the CPU.
+ */
+#define DMA1_BASEADDR       (AHB1_BASEADDR + 0x6000U) //0x40026000
+#define DMA2_BASEADDR       (AHB1_BASEADDR + 0x6400U) //0x40026400
+
 /*
  * APB1 Peripherals (where TIM2 lives!)
  */
 #define TIM2_BASEADDR       (APB1_BASEADDR) // 0x40000000
-// #define TIM3_BASEADDR    (APB1_BASEADDR + 0x0400U) // For future use
+#define PWR_BASEADDR        (APB1_BASEADDR + 0x7000U) // 0x40007000, Power Controller (voltage scaling, over-drive)
+#define TIM3_BASEADDR       (APB1_BASEADDR + 0x0400U) // 0x40000400, 16-bit
+#define TIM4_BASEADDR       (APB1_BASEADDR + 0x0800U) // 0x40000800, 16-bit
+#define TIM5_BASEADDR       (APB1_BASEADDR + 0x0C00U) // 0x40000C00, 32-bit like TIM2 -> used as the system time base
+#define TIM6_BASEADDR       (APB1_BASEADDR + 0x1000U) // 0x40001000, basic timer (no channels)
+#define TIM7_BASEADDR       (APB1_BASEADDR + 0x1400U) // 0x40001400, basic timer (no channels)
+#define TIM12_BASEADDR      (APB1_BASEADDR + 0x1800U) // 0x40001800, 2 channels
+#define TIM13_BASEADDR      (APB1_BASEADDR + 0x1C00U) // 0x40001C00, 1 channel
+#define TIM14_BASEADDR      (APB1_BASEADDR + 0x2000U) // 0x40002000, 1 channel
 // #define I2C1_BASEADDR    (APB1_BASEADDR + 0x5400U) // For future use
 
 /*
@@ -87,6 +109,10 @@
 #define SYSCFG_BASEADDR     (APB2_BASEADDR + 0x3800U) // 0x40013800
 #define EXTI_BASEADDR       (APB2_BASEADDR + 0x3C00U) // 0x40013C00
 #define TIM1_BASEADDR       (APB2_BASEADDR + 0x0000U) // Advanced Timer
+#define TIM8_BASEADDR       (APB2_BASEADDR + 0x0400U) // 0x40010400, Advanced Timer
+#define TIM9_BASEADDR       (APB2_BASEADDR + 0x4000U) // 0x40014000, 2 channels
+#define TIM10_BASEADDR      (APB2_BASEADDR + 0x4400U) // 0x40014400, 1 channel
+#define TIM11_BASEADDR      (APB2_BASEADDR + 0x4800U) // 0x40014800, 1 channel
 
 /*
  * ==========================================
@@ -137,18 +163,46 @@ typedef struct{
 	// ... there are more registers, but this is enough for now
 } RCC_RegDef_t;
 
+/*
+ * ==========================================
+ * PWR (Power Controller) Register Definition Structure
+ * ==========================================
+ * Needed by the clock driver: the core regulator must be in Scale 1
+ * with Over-Drive enabled before HCLK is allowed to exceed 168 MHz.
+ * Refer to RM0390 - 5.4 PWR registers
+ */
+typedef struct{
+	volatile uint32_t CR;  // power control register,          offset: 0x00
+	volatile uint32_t CSR; // power control/status register,   offset: 0x04
+} PWR_RegDef_t;
+
+/*
+ * ==========================================
+ * FLASH Interface Register Definition Structure
+ * ==========================================
+ * Refer to RM0390 - 3.8 Flash interface registers
+ */
+typedef struct{
+	volatile uint32_t ACR;     // access control register,     offset: 0x00
+	volatile uint32_t KEYR;    // key register,                offset: 0x04
+	volatile uint32_t OPTKEYR; // option key register,         offset: 0x08
+	volatile uint32_t SR;      // status register,             offset: 0x0C
+	volatile uint32_t CR;      // control register,            offset: 0x10
+	volatile uint32_t OPTCR;   // option control register,     offset: 0x14
+} FLASH_RegDef_t;
+
 /*
  * ==========================================
  * EXTI Register Definition Structure
  * ==========================================
  */
 typedef struct{
-	uint32_t IMR; // interrupt mask register -> offset 0x00
-	uint32_t EMR; // event mask register -> offset 0x04
-	uint32_t RTSR; // rising trigger selection register -> offset 0x08
-	uint32_t FTSR; // falling trigger selection register -> offset 0x0C
-	uint32_t SWIER; // software interrupt event register -> offset 0x10
-	uint32_t PR; // pending register -> offset 0x14
+	volatile uint32_t IMR; // interrupt mask register -> offset 0x00
+	volatile uint32_t EMR; // event mask register -> offset 0x04
+	volatile uint32_t RTSR; // rising trigger selection register -> offset 0x08
+	volatile uint32_t FTSR; // falling trigger selection register -> offset 0x0C
+	volatile uint32_t SWIER; // software interrupt event register -> offset 0x10
+	volatile uint32_t PR; // pending register -> offset 0x14 (changed by hardware, MUST be volatile)
 } EXTI_RegDef_t;
 
 /*
@@ -165,11 +219,38 @@ typedef struct{
 					  // external interrupt configuration register 4 -> offset 0x14
 } SYSCFG_RegDef_t;
 
+/*
+ * ==========================================
+ * DMA Register Definition Structures
+ * ==========================================
+ * Refer to RM0390 - 9.5.11 DMA register map
+ * The controller block holds the interrupt flags of all 8 streams:
+ * LISR/LIFCR for streams 0-3, HISR/HIFCR for streams 4-7.
+ * Each stream then has its own block of 6 registers, 0x18 bytes apart, starting at offset 0x10.
+ */
+typedef struct{
+	volatile uint32_t LISR;  // low interrupt status register,      offset: 0x00
+	volatile uint32_t HISR;  // high interrupt status register,     offset: 0x04
+	volatile uint32_t LIFCR; // low interrupt flag clear register,  offset: 0x08
+	volatile uint32_t HIFCR; // high interrupt flag clear register, offset: 0x0C
+} DMA_RegDef_t;
+
+typedef struct{
+	volatile uint32_t CR;    // stream configuration register,      offset: 0x10 + 0x18 * n
+	volatile uint32_t NDTR;  // number of data register (items left)
+	volatile uint32_t PAR;   // peripheral address register
+	volatile uint32_t M0AR;  // memory 0 address register
+	volatile uint32_t M1AR;  // memory 1 address register (double buffer mode)
+	volatile uint32_t FCR;   // FIFO control register
+} DMA_Stream_RegDef_t;
+
 /*
  * ==========================================
  * TIM (General Purpose Timer) Register Structure
  * Applicable for TIM2 - TIM5 (General Purpose)
- * Refer to RM0390 - 17.4.21 TIMx register map
+ * and TIM1 / TIM8 (Advanced Control): RCR and BDTR only exist on those two,
+ * on the other timers the two words are reserved.
+ * Refer to RM0390 - 17.4.21 TIMx register map, 16.4.21 TIM1&TIM8 register map
  * ==========================================
  */
 typedef struct {
@@ -185,12 +266,12 @@ typedef struct {
     volatile uint32_t CNT;      // Counter,                         Offset: 0x24
     volatile uint32_t PSC;      // Prescaler,                       Offset: 0x28
     volatile uint32_t ARR;      // Auto-reload register,            Offset: 0x2C
-    volatile uint32_t Reserved1;//                                  Offset: 0x30
+    volatile uint32_t RCR;      // Repetition counter (TIM1/8),     Offset: 0x30
     volatile uint32_t CCR1;     // Capture/compare register 1,      Offset: 0x34
     volatile uint32_t CCR2;     // Capture/compare register 2,      Offset: 0x38
     volatile uint32_t CCR3;     // Capture/compare register 3,      Offset: 0x3C
     volatile uint32_t CCR4;     // Capture/compare register 4,      Offset: 0x40
-    volatile uint32_t Reserved2;//                                  Offset: 0x44
+    volatile uint32_t BDTR;     // Break and dead-time (TIM1/8),    Offset: 0x44
     volatile uint32_t DCR;      // DMA control register,            Offset: 0x48
     volatile uint32_t DMAR;     // DMA address for full transfer,   Offset: 0x4C
 } TIM_RegDef_t;
@@ -221,6 +302,58 @@ typedef struct{
 // 0xE000E100 - 0xE000E11F -> NVIC_ISER0 - NVIC_ISER7
 #define NVIC_ISER_BASE_ADDR 0xE000E100U // according to pm0214 manual
 
+/*
+ * ==========================================
+ * DWT (Data Watchpoint and Trace) Register Structure Definition
+ * ==========================================
+ * Cortex-M4 debug block (Refer to ARMv7-M Architecture Reference Manual C1.8).
+ * We only care about CYCCNT: a free-running 32-bit counter that increments
+ * once per CPU clock cycle -> the most precise stopwatch on the chip.
+ * It is gated by DEMCR.TRCENA (bit 24) in the CoreDebug block.
+ */
+typedef struct{
+	volatile uint32_t CTRL;     // control register,           offset: 0x00 (bit 0 CYCCNTENA)
+	volatile uint32_t CYCCNT;   // cycle count register,       offset: 0x04
+	volatile uint32_t CPICNT;   // CPI count register,         offset: 0x08
+	volatile uint32_t EXCCNT;   // exception overhead count,   offset: 0x0C
+	volatile uint32_t SLEEPCNT; // sleep count register,       offset: 0x10
+	volatile uint32_t LSUCNT;   // LSU count register,         offset: 0x14
+	volatile uint32_t FOLDCNT;  // folded-instruction count,   offset: 0x18
+	volatile uint32_t PCSR;     // program counter sample,     offset: 0x1C
+} DWT_RegDef_t;
+
+typedef struct{
+	volatile uint32_t DHCSR;    // debug halting control/status, offset: 0x00
+	volatile uint32_t DCRSR;    // debug core register selector, offset: 0x04
+	volatile uint32_t DCRDR;    // debug core register data,     offset: 0x08
+	volatile uint32_t DEMCR;    // debug exception and monitor control, offset: 0x0C (bit 24 TRCENA)
+} CoreDebug_RegDef_t;
+
+#define DWT_BASEADDR        0xE0001000U
+#define COREDEBUG_BASEADDR  0xE000EDF0U
+
+/*
+ * ==========================================
+ * SCB (System Control Block) Register Structure Definition
+ * ==========================================
+ * Refer to PM0214 - 4.4 System control block
+ * ICSR:  pend / clear system exceptions (bit 28 PENDSVSET, bit 25 PENDSTCLR)
+ * SHP[]: one priority byte per system exception, SHP[n] = exception n + 4
+ *        (e.g. PendSV = exception 14 -> SHP[10]). Only the top 4 bits are implemented.
+ */
+typedef struct{
+	volatile uint32_t CPUID;    // CPUID base register,                  offset: 0x00
+	volatile uint32_t ICSR;     // interrupt control and state register, offset: 0x04
+	volatile uint32_t VTOR;     // vector table offset register,         offset: 0x08
+	volatile uint32_t AIRCR;    // application interrupt/reset control,  offset: 0x0C
+	volatile uint32_t SCR;      // system control register,              offset: 0x10
+	volatile uint32_t CCR;      // configuration and control register,   offset: 0x14
+	volatile uint8_t  SHP[12];  // system handler priority registers,    offset: 0x18 - 0x23
+	volatile uint32_t SHCSR;    // system handler control and state,     offset: 0x24
+} SCB_RegDef_t;
+
+#define SCB_BASEADDR        0xE000ED00U
+
 /*
  * ==========================================
  * 4. Peripheral Definitions (Typecasting)
@@ -250,14 +383,48 @@ typedef struct{
  * raw address value (0x40013C00) before casting, causing a compile error.
  */
 #define RCC     ((RCC_RegDef_t*)RCC_BASEADDR)
+#define PWR     ((PWR_RegDef_t*)PWR_BASEADDR)
+#define FLASH   ((FLASH_RegDef_t*)FLASH_R_BASEADDR)
 #define EXTI    ((EXTI_RegDef_t*)EXTI_BASEADDR)
 #define SYSCFG  ((SYSCFG_RegDef_t*)SYSCFG_BASEADDR)
 #define NVIC_ISER ((NVIC_ISER_RegDef_t*)NVIC_ISER_BASE_ADDR)
+#define DWT       ((DWT_RegDef_t*)DWT_BASEADDR)
+#define COREDEBUG ((CoreDebug_RegDef_t*)COREDEBUG_BASEADDR)
+#define SCB       ((SCB_RegDef_t*)SCB_BASEADDR)
+#define DMA1      ((DMA_RegDef_t*)DMA1_BASEADDR)
+#define DMA2      ((DMA_RegDef_t*)DMA2_BASEADDR)
+
+// Stream n (0-7) of a DMA controller, e.g. DMA_STREAM(DMA1, 5)->NDTR
+#define DMA_STREAM(DMAx, N) ((DMA_Stream_RegDef_t*)((uint32_t)(DMAx) + 0x10U + (0x18U * (N))))
 
 // Project 2: Timer definition
+#define TIM1    ((TIM_RegDef_t*)TIM1_BASEADDR)
+#define TIM8    ((TIM_RegDef_t*)TIM8_BASEADDR)
 #define TIM2    ((TIM_RegDef_t*)TIM2_BASEADDR)
+#define TIM3    ((TIM_RegDef_t*)TIM3_BASEADDR)
+#define TIM4    ((TIM_RegDef_t*)TIM4_BASEADDR)
+#define TIM5    ((TIM_RegDef_t*)TIM5_BASEADDR)
+#define TIM6    ((TIM_RegDef_t*)TIM6_BASEADDR)
+#define TIM7    ((TIM_RegDef_t*)TIM7_BASEADDR)
+#define TIM9    ((TIM_RegDef_t*)TIM9_BASEADDR)
+#define TIM10   ((TIM_RegDef_t*)TIM10_BASEADDR)
+#define TIM11   ((TIM_RegDef_t*)TIM11_BASEADDR)
+#define TIM12   ((TIM_RegDef_t*)TIM12_BASEADDR)
+#define TIM13   ((TIM_RegDef_t*)TIM13_BASEADDR)
+#define TIM14   ((TIM_RegDef_t*)TIM14_BASEADDR)
 // We will define TIM_RegDef_t in Timer driver or here later
 
+/*
+ * Enable the DWT cycle counter (shared by the benchmarks)
+ * 1. DEMCR.TRCENA (bit 24) powers the DWT/ITM blocks
+ * 2. DWT_CTRL.CYCCNTENA (bit 0) starts the counter
+ */
+static inline void DWT_CycleCounterEnable(void){
+	SET_BIT(COREDEBUG->DEMCR, 24);
+	DWT->CYCCNT = 0;
+	SET_BIT(DWT->CTRL, 0);
+}
+
 /*
  * ==========================================
  * 5. Interrupt Macros
@@ -266,6 +433,24 @@ typedef struct{
 // See RM0390 Vector Table (Position 40)
  * ==========================================
  */
+#define DMA1_STREAM0_IRQ (11) // DMA1 streams 0-6 are consecutive (11-17)
+#define DMA1_STREAM7_IRQ (47)
+#define DMA2_STREAM0_IRQ (56) // DMA2 streams 0-4: 56-60
+#define DMA2_STREAM5_IRQ (68) // DMA2 streams 5-7: 68-70
+#define TIM1_BRK_TIM9_IRQ  (24) // TIM1 break, shared with TIM9
+#define TIM1_UP_TIM10_IRQ  (25) // TIM1 update, shared with TIM10
+#define TIM1_TRG_COM_TIM11_IRQ (26) // TIM1 trigger / commutation, shared with TIM11
+#define TIM1_CC_IRQ        (27) // TIM1 capture / compare
+#define TIM8_BRK_TIM12_IRQ (43) // TIM8 break, shared with TIM12
+#define TIM8_UP_TIM13_IRQ  (44) // TIM8 update, shared with TIM13
+#define TIM8_TRG_COM_TIM14_IRQ (45) // TIM8 trigger / commutation, shared with TIM14
+#define TIM8_CC_IRQ        (46) // TIM8 capture / compare
+#define TIM2_IRQ      (28) // TIM2 global interrupt, see RM0390 Vector Table (Position 28)
+#define TIM3_IRQ      (29)
+#define TIM4_IRQ      (30)
 #define EXTI15_10_IRQ (40)
+#define TIM5_IRQ      (50) // TIM5 global interrupt, see RM0390 Vector Table (Position 50)
+#define TIM6_DAC_IRQ  (54) // TIM6 global interrupt, shared with the DAC underrun
+#define TIM7_IRQ      (55)
 
 #endif /* SOURCES_STM32F446XX_H_ */
@@ -0,0 +1,210 @@
+/*
+ * stm32f446xx_bam_driver.c
+ *
+ *  Created on: 2026/1/23
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_bam_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include "stm32f446xx_timer_driver.h"
+#include "stm32f446xx_rcc_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * The interrupt has to finish one plane before the next one starts:
+ * the shortest plane (bit 0) must be at least this long.
+ */
+#define BAM_MIN_PLANE_US        2U
+
+static const BAM_Channel_t *pBAMChannels;
+static uint8_t BAMChannelCount;
+
+/*
+ * Ports in use, and for each channel the index of its port in BAMPorts
+ */
+static GPIO_RegDef_t *BAMPorts[BAM_MAX_PORTS];
+static uint16_t BAMPortMask[BAM_MAX_PORTS];     // pins of that port driven by BAM
+static uint8_t BAMPortCount;
+static uint8_t BAMChannelPort[BAM_MAX_CHANNELS];
+
+static uint8_t BAMLevels[BAM_MAX_CHANNELS];
+
+/*
+ * [buffer][plane][port] -> BSRR word. 2 x 8 x 4 x 4 bytes = 256 bytes.
+ */
+static uint32_t BAMPlanes[2][BAM_BITS][BAM_MAX_PORTS];
+static volatile uint8_t BAMFront;               // buffer the interrupt is showing
+static volatile uint8_t BAMSwapPending;         // swap at the next plane 0
+
+static uint16_t BAMPlaneArr[BAM_BITS];          // ARR of each plane: (base << b) - 1
+static uint8_t BAMNextPlane;
+
+/*
+ * Tick: update event = start of plane BAMNextPlane
+ * The active ARR already is this plane's length (preloaded one plane earlier).
+ */
+static void BAM_Tick(TIM_RegDef_t *pTIMx){
+	uint8_t plane = BAMNextPlane;
+
+	if (plane == 0 && BAMSwapPending){
+		BAMFront ^= 1U;
+		BAMSwapPending = 0;
+	}
+
+	const uint32_t *pWords = BAMPlanes[BAMFront][plane];
+	for (uint8_t p = 0; p < BAMPortCount; p++){
+		BAMPorts[p]->BSRR = pWords[p];
+	}
+
+	plane = (plane + 1U == BAM_BITS) ? 0 : (uint8_t)(plane + 1U);
+	pTIMx->ARR = BAMPlaneArr[plane]; // preload: becomes active at the end of this plane
+	BAMNextPlane = plane;
+}
+
+/*
+ * Helper: split the level table into bit planes (main loop, not time critical)
+ */
+static void BAM_BuildPlanes(uint32_t Planes[BAM_BITS][BAM_MAX_PORTS]){
+	for (uint8_t b = 0; b < BAM_BITS; b++){
+		uint16_t on[BAM_MAX_PORTS] = {0};
+
+		for (uint8_t ch = 0; ch < BAMChannelCount; ch++){
+			if ((BAMLevels[ch] >> b) & 1U){
+				on[BAMChannelPort[ch]] |= (uint16_t)(1U << pBAMChannels[ch].PinNumber);
+			}
+		}
+		for (uint8_t p = 0; p < BAMPortCount; p++){
+			Planes[b][p] = GPIO_BSRR_WORD(BAMPortMask[p], on[p]);
+		}
+	}
+}
+
+uint8_t BAM_Init(const BAM_Config_t *pConfig){
+	if (pConfig->pChannels == NULL || pConfig->ChannelCount == 0 ||
+	    pConfig->ChannelCount > BAM_MAX_CHANNELS || pConfig->FrameHz == 0){
+		return DISABLE;
+	}
+
+	/*
+	 * 1. Timing: base tick = 1 / (FrameHz x 255). The longest plane (128 ticks) must fit
+	 * into 16 bits -> base <= 512 counts -> smallest prescaler that gets there.
+	 */
+	uint32_t frame_ticks = BAM_LEVEL_MAX * (uint32_t)pConfig->FrameHz;
+	if (frame_ticks * BAM_MIN_PLANE_US > 1000000U){
+		return DISABLE; // bit 0 plane shorter than the interrupt
+	}
+	uint32_t timer_clk = RCC_GetTimerClock1();
+	uint32_t max_base = (TIM_ARR_MAX_16BIT + 1U) >> (BAM_BITS - 1U);
+	uint32_t divider = (timer_clk + (frame_ticks * max_base) - 1U) / (frame_ticks * max_base);
+	if (divider == 0){
+		divider = 1;
+	}
+	if (divider > TIM_PSC_MAX + 1U){
+		return DISABLE;
+	}
+	uint32_t base = timer_clk / (divider * frame_ticks);
+
+	BAM_Stop();
+
+	// 2. Ports: collect the distinct ones and the pins driven on each
+	uint8_t port_count = 0;
+	for (uint8_t ch = 0; ch < pConfig->ChannelCount; ch++){
+		const BAM_Channel_t *pChannel = &pConfig->pChannels[ch];
+		uint8_t p = 0;
+
+		if (pChannel->PinNumber > 15){
+			return DISABLE;
+		}
+		while (p < port_count && BAMPorts[p] != pChannel->pGPIOx){
+			p++;
+		}
+		if (p == port_count){
+			if (port_count == BAM_MAX_PORTS){
+				return DISABLE;
+			}
+			BAMPorts[p] = pChannel->pGPIOx;
+			BAMPortMask[p] = 0;
+			port_count++;
+		}
+		BAMPortMask[p] |= (uint16_t)(1U << pChannel->PinNumber);
+		BAMChannelPort[ch] = p;
+	}
+
+	if (pBAMChannels == NULL){
+		TIM_PeriClockControl(BAM_TIM, ENABLE); // first init only: the clock is reference-counted
+	}
+	pBAMChannels = pConfig->pChannels;
+	BAMChannelCount = pConfig->ChannelCount;
+	BAMPortCount = port_count;
+	for (uint8_t b = 0; b < BAM_BITS; b++){
+		BAMPlaneArr[b] = (uint16_t)((base << b) - 1U);
+	}
+
+	// 3. Both buffers: everything off
+	for (uint8_t ch = 0; ch < BAMChannelCount; ch++){
+		BAMLevels[ch] = 0;
+	}
+	BAM_BuildPlanes(BAMPlanes[0]);
+	BAM_BuildPlanes(BAMPlanes[1]);
+	BAMFront = 0;
+	BAMSwapPending = 0;
+	BAMNextPlane = 0;
+
+	/*
+	 * 4. Timer: ARPE (CR1 bit 7) so ARR always takes effect at a plane boundary.
+	 * UG loads PSC and the first period (plane 0), then the preload already
+	 * holds plane 0 again: the first update starts plane 0 with the right length.
+	 */
+	TIM_RegDef_t *pTIMx = BAM_TIM;
+	pTIMx->CR1 = (1U << 7);
+	pTIMx->PSC = divider - 1U;
+	pTIMx->ARR = BAMPlaneArr[0];
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
+
+	if (TIM_RegisterUpdateCallback(pTIMx, BAM_Tick) != ENABLE){ // UIE on (again after a BAM_Stop)
+		return DISABLE;
+	}
+	SET_BIT(pTIMx->CR1, 0);
+	return ENABLE;
+}
+
+void BAM_SetLevel(uint8_t Channel, uint8_t Level){
+	if (Channel < BAMChannelCount){
+		BAMLevels[Channel] = Level;
+	}
+}
+
+void BAM_Commit(void){
+	/*
+	 * Withdraw a commit that has not been shown yet, so the interrupt cannot swap
+	 * to the back buffer while it is being rewritten. The single byte store is atomic,
+	 * and the interrupt only swaps when it sees BAMSwapPending = 1: after this line
+	 * the back buffer belongs to us.
+	 */
+	BAMSwapPending = 0;
+	uint8_t back = BAMFront ^ 1U;
+
+	BAM_BuildPlanes(BAMPlanes[back]);
+	BAMSwapPending = 1;
+}
+
+uint8_t BAM_IsCommitPending(void){
+	return BAMSwapPending;
+}
+
+void BAM_Stop(void){
+	TIM_RegDef_t *pTIMx = BAM_TIM;
+
+	if (pBAMChannels == NULL || !READ_BIT(pTIMx->CR1, 0)){
+		return;
+	}
+	CLEAR_BIT(pTIMx->CR1, 0);
+	TIM_UnregisterUpdateCallback(pTIMx, BAM_Tick);
+
+	for (uint8_t p = 0; p < BAMPortCount; p++){
+		GPIO_WriteToOutputPins(BAMPorts[p], BAMPortMask[p], 0);
+	}
+}
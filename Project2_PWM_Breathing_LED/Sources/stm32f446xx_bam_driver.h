@@ -0,0 +1,105 @@
+/*
+ * stm32f446xx_bam_driver.h
+ *
+ *  Created on: 2026/1/23
+ *      Author: Yuheng
+ *
+ * Description:
+ * Software PWM for many plain GPIO outputs, using bit-angle modulation (BAM).
+ *
+ * Why?
+ * TIM2 has four PWM channels; a panel of 32+ dimmable LEDs does not fit in any
+ * number of timer channels. Classic software PWM (one compare per channel, or one
+ * interrupt per brightness step) costs CPU in proportion to channels x steps.
+ *
+ * Bit-angle modulation:
+ * An 8-bit level is split into its bits. Each bit gets a time slot ("bit plane")
+ * as long as its weight: bit 0 lasts 1 tick, bit 1 lasts 2, ... bit 7 lasts 128.
+ * During plane b, an output is ON if bit b of its level is 1.
+ *   level 5 = 0b101:  plane 0 (1)  plane 1 (2)  plane 2 (4)          ...
+ *                     ON           off          ON  ON  ON  ON
+ *   -> ON for 1 + 4 = 5 ticks out of 255, the same average as PWM with duty 5/255.
+ *
+ * Cost:
+ * ONE timer interrupt per plane (8 per frame), whatever the number of channels.
+ * At the start of each plane, the interrupt writes one precomputed BSRR word per
+ * port (GPIO_BSRR_WORD, same path as GPIO_WriteToOutputPins): every pin of that port
+ * switches in one bus cycle. The per-channel work (splitting levels into bits)
+ * happens once per change, in BAM_Commit, in the main loop.
+ *
+ * Double buffering:
+ * BAM_SetLevel only changes a level table. BAM_Commit builds the bit planes into
+ * the BACK buffer; the interrupt swaps the buffers at the start of the next frame
+ * (plane 0). A frame is always shown completely old or completely new: no tearing,
+ * even for a commit in the middle of a frame.
+ *
+ * Timing: the timer's ARR is preloaded (ARPE) with the length of the NEXT plane
+ * during the current one, so every plane boundary is an exact hardware update event.
+ *
+ * Timer: BAM_TIM (TIM3 by default: it is otherwise only used by the one-pulse API).
+ * Pins must already be push-pull outputs (GPIO_Init, GPIO_MODE_OUT).
+ */
+
+#ifndef SOURCES_STM32F446XX_BAM_DRIVER_H_
+#define SOURCES_STM32F446XX_BAM_DRIVER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#define BAM_TIM                 TIM3
+#define BAM_BITS                8           // levels 0 .. 255
+#define BAM_LEVEL_MAX           ((1U << BAM_BITS) - 1U)
+#define BAM_MAX_CHANNELS        64
+#define BAM_MAX_PORTS           4           // different GPIO ports among the channels
+
+typedef struct{
+	GPIO_RegDef_t *pGPIOx;
+	uint8_t PinNumber;                      // 0-15
+} BAM_Channel_t;
+
+typedef struct{
+	const BAM_Channel_t *pChannels;         // channel n = pChannels[n], may live in flash
+	uint8_t ChannelCount;                   // 1 .. BAM_MAX_CHANNELS
+	uint16_t FrameHz;                       // full frames (all planes) per second, e.g. 200
+} BAM_Config_t;
+
+/*
+ * ==========================================
+ * 2. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * (Re)start with every channel off. Returns DISABLE if there are too many channels or
+ * ports, a pin number is out of range, or FrameHz cannot be reached with a 16-bit timer
+ * (a BAM that was already running is stopped if the ports or pins are the problem).
+ */
+uint8_t BAM_Init(const BAM_Config_t *pConfig);
+
+/*
+ * Level of one channel (0 .. BAM_LEVEL_MAX) in the level table.
+ * Nothing changes on the pins until BAM_Commit.
+ */
+void BAM_SetLevel(uint8_t Channel, uint8_t Level);
+
+/*
+ * Build the planes of the level table into the back buffer and show them from the
+ * next frame on. A newer commit before that frame replaces this one.
+ * Call from main (not reentrant).
+ */
+void BAM_Commit(void);
+
+/*
+ * 1 while a commit waits for the next frame.
+ */
+uint8_t BAM_IsCommitPending(void);
+
+void BAM_Stop(void);
+
+#endif /* SOURCES_STM32F446XX_BAM_DRIVER_H_ */
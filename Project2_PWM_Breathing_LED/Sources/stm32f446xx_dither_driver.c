@@ -0,0 +1,132 @@
+/*
+ * stm32f446xx_dither_driver.c
+ *
+ *  Created on: 2026/1/22
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_dither_driver.h"
+#include "stm32f446xx_timer_driver.h"
+#include "stm32f446xx_dma_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+#define DITHER_DMA_STREAM       1   // DMA1 Stream 1 channel 3: TIM2_UP
+#define DITHER_DMA_REQUEST      3
+
+static TIM_RegDef_t *volatile pDitherTIM; // NULL = stopped
+static volatile uint32_t *pDitherCCR;
+static uint8_t DitherEngine;
+static volatile uint32_t DitherDuty;    // fixed point, read by the update interrupt
+static uint32_t DitherAcc;              // fraction left over from the previous period
+
+/*
+ * DMA engine: one modulator cycle of CCR values
+ */
+static uint32_t DitherPattern[DITHER_CYCLE_LENGTH];
+
+/*
+ * Same modulator as the update interrupt, run for one full cycle from acc = 0.
+ * After 2^FRAC_BITS periods the leftover fraction is 0 again, so the pattern adds up
+ * to exactly Duty: its average is exactly Duty / 2^FRAC_BITS counts.
+ */
+static void DITHER_FillPattern(uint32_t Duty){
+	uint32_t acc = 0;
+
+	for (uint32_t i = 0; i < DITHER_CYCLE_LENGTH; i++){
+		acc = (acc & DITHER_FRAC_MASK) + Duty;
+		DitherPattern[i] = acc >> DITHER_FRAC_BITS;
+	}
+}
+
+/*
+ * Update interrupt engine: two lines of arithmetic and one store per period.
+ * CCRx is preloaded, so the value written now is used for the NEXT period.
+ */
+static void DITHER_UpdateHook(TIM_RegDef_t *pTIMx){
+	if (pTIMx != pDitherTIM || DitherEngine != DITHER_ENGINE_UPDATE_ISR){
+		return;
+	}
+	uint32_t acc = (DitherAcc & DITHER_FRAC_MASK) + DitherDuty;
+	DitherAcc = acc;
+	*pDitherCCR = acc >> DITHER_FRAC_BITS;
+}
+
+static uint32_t DITHER_Clamp(TIM_RegDef_t *pTIMx, uint32_t Duty){
+	uint32_t max = DITHER_DUTY(pTIMx->ARR + 1U);
+	return (Duty > max) ? max : Duty;
+}
+
+uint8_t DITHER_Start(DITHER_Handle_t *pDitherHandle){
+	TIM_RegDef_t *pTIMx = pDitherHandle->pTIMx;
+	DITHER_Config_t *pConfig = &pDitherHandle->DITHER_Config;
+
+	if (pConfig->Channel < 1 || pConfig->Channel > TIM_CHANNELS ||
+	    (pConfig->Engine == DITHER_ENGINE_DMA && pTIMx != TIM2) ||
+	    pConfig->Engine > DITHER_ENGINE_DMA){
+		return DISABLE;
+	}
+
+	DITHER_Stop();
+
+	pDitherCCR = &pTIMx->CCR1 + (pConfig->Channel - 1U); // CCR1..CCR4 are consecutive
+	DitherEngine = pConfig->Engine;
+	DitherAcc = 0;
+	DitherDuty = DITHER_Clamp(pTIMx, pConfig->InitialDuty);
+	pDitherTIM = pTIMx; // last: from here on the update hook uses the settings above
+
+	if (DitherEngine == DITHER_ENGINE_UPDATE_ISR){
+		if (TIM_RegisterUpdateCallback(pTIMx, DITHER_UpdateHook) != ENABLE){
+			pDitherTIM = NULL;
+			return DISABLE;
+		}
+		return ENABLE;
+	}
+
+	// DMA engine: TIM2_UP -> CCRx, one pattern word per period, forever
+	DITHER_FillPattern(DitherDuty);
+
+	DMA_Handle_t DMAHandle;
+	DMAHandle.pDMAx = DMA1;
+	DMAHandle.DMA_Config.Stream = DITHER_DMA_STREAM;
+	DMAHandle.DMA_Config.Channel = DITHER_DMA_REQUEST;
+	DMAHandle.DMA_Config.Direction = DMA_DIR_MEM_TO_PERIPH;
+	DMAHandle.DMA_Config.DataSize = DMA_SIZE_WORD;
+	DMAHandle.DMA_Config.MemIncrement = ENABLE;
+	DMAHandle.DMA_Config.Circular = ENABLE;
+	DMAHandle.DMA_Config.Priority = DMA_PRIORITY_HIGH;
+	DMAHandle.DMA_Config.PeriphAddr = (uint32_t)pDitherCCR;
+	DMAHandle.DMA_Config.MemAddr = (uint32_t)DitherPattern;
+	DMAHandle.DMA_Config.Count = DITHER_CYCLE_LENGTH;
+	DMAHandle.DMA_Config.HalfCallback = NULL;
+	DMAHandle.DMA_Config.CompleteCallback = NULL;
+	DMA_Init(&DMAHandle);
+	DMA_Start(DMA1, DITHER_DMA_STREAM);
+
+	SET_BIT(pTIMx->DIER, 8); // UDE: update DMA request enable
+	return ENABLE;
+}
+
+void DITHER_SetDuty(uint32_t Duty){
+	if (pDitherTIM == NULL){
+		return;
+	}
+	DitherDuty = DITHER_Clamp(pDitherTIM, Duty);
+
+	if (DitherEngine == DITHER_ENGINE_DMA){
+		DITHER_FillPattern(DitherDuty);
+	}
+}
+
+void DITHER_Stop(void){
+	if (pDitherTIM == NULL){
+		return;
+	}
+	if (DitherEngine == DITHER_ENGINE_DMA){
+		CLEAR_BIT(pDitherTIM->DIER, 8);
+		DMA_Stop(DMA1, DITHER_DMA_STREAM);
+	}else{
+		TIM_UnregisterUpdateCallback(pDitherTIM, DITHER_UpdateHook);
+	}
+	pDitherTIM = NULL;
+}
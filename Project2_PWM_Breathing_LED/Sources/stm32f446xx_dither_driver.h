@@ -0,0 +1,108 @@
+/*
+ * stm32f446xx_dither_driver.h
+ *
+ *  Created on: 2026/1/22
+ *      Author: Yuheng
+ *
+ * Description:
+ * Sigma-delta dithering of one PWM channel: duty cycles with a FRACTION of a timer count.
+ *
+ * Why?
+ * Resolution = ARR + 1 counts per period, and ARR + 1 = TimerClock / ((PSC + 1) * PWM_Freq).
+ * At 1 kHz that is 1000 steps (PSC = 89, ARR = 999 at 90 MHz, or PSC = 15 at 16 MHz).
+ * A camera-safe carrier of 20 kHz leaves 4500 steps (~12 bits) even at PSC = 0: too coarse
+ * for the bottom of a dimming curve, where one count is a visible jump.
+ *
+ * Idea:
+ * The LED (and the eye, and the camera) average over many periods. To get CCR = 10.25,
+ * write 10, 10, 10, 11, 10, 10, 10, 11, ... : the average is exactly 10.25.
+ * The duty is given in fixed point (Q format, DITHER_FRAC_BITS fraction bits) and
+ * a first-order sigma-delta modulator decides, period by period, whether the CCR is
+ * rounded down or up:
+ *   acc = (acc & FRAC_MASK) + Duty     (Duty in 1 / 2^FRAC_BITS counts)
+ *   CCR = acc >> FRAC_BITS             (= integer part, +1 whenever the fraction overflows)
+ * The "+1" periods are spread as evenly as possible (the error never exceeds one count,
+ * and the running average converges within 2^FRAC_BITS periods).
+ * At 20 kHz with FRAC_BITS = 4: 4500 x 16 = 72000 steps (~16 bits), averaged
+ * over 16 periods = 0.8 ms (1.25 kHz worst-case ripple of +-1 count).
+ *
+ * Two engines:
+ * - DITHER_ENGINE_UPDATE_ISR: the TIM update interrupt runs the two lines above.
+ *   Duty changes take effect at the next period. Cost: one IRQ per period.
+ * - DITHER_ENGINE_DMA: the modulator output for one full cycle (2^FRAC_BITS periods)
+ *   is precomputed into a pattern buffer, and DMA1 streams it into CCRx in a loop
+ *   on every TIM2 update (same stream as DMA waveform playback: not both at once).
+ *   Zero CPU; SetDuty recomputes the pattern (may tear for one cycle: the average of
+ *   that one cycle is between the old and the new duty).
+ *
+ * Verification: Tools/dither_analysis.py models the exact same modulator and
+ * checks the averaged output for every duty, or measures a logic-analyzer capture.
+ *
+ * Requirements: timer running with preload enabled on the channel (TIM_PWM_Init).
+ * DMA engine: TIM2 only, DMA1 clock enabled (DMA_PeriClockControl(DMA1, ENABLE)).
+ */
+
+#ifndef SOURCES_STM32F446XX_DITHER_DRIVER_H_
+#define SOURCES_STM32F446XX_DITHER_DRIVER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#ifndef DITHER_FRAC_BITS
+#define DITHER_FRAC_BITS        4           // 1-8: extra bits of resolution (and cycle length)
+#endif
+#define DITHER_CYCLE_LENGTH     (1U << DITHER_FRAC_BITS)    // periods per modulator cycle
+#define DITHER_FRAC_MASK        (DITHER_CYCLE_LENGTH - 1U)
+
+_Static_assert(DITHER_FRAC_BITS >= 1 && DITHER_FRAC_BITS <= 8, "DITHER_FRAC_BITS must be 1-8");
+
+/*
+ * Fixed-point duty from CCR counts, e.g. DITHER_DUTY(10) + DITHER_CYCLE_LENGTH / 4 = 10.25
+ */
+#define DITHER_DUTY(CCR)        ((uint32_t)(CCR) << DITHER_FRAC_BITS)
+
+/* @DITHER_ENGINE */
+#define DITHER_ENGINE_UPDATE_ISR    0
+#define DITHER_ENGINE_DMA           1
+
+typedef struct{
+	uint8_t Channel;        // 1-4
+	uint8_t Engine;         // Possible values: @DITHER_ENGINE
+	uint32_t InitialDuty;   // fixed point, 0 .. DITHER_DUTY(ARR + 1)
+} DITHER_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;    // UPDATE_ISR: any timer with channels except TIM5 (time base), DMA: TIM2
+	DITHER_Config_t DITHER_Config;
+} DITHER_Handle_t;
+
+/*
+ * ==========================================
+ * 2. API Function Prototypes
+ * ==========================================
+ * One dithered channel at a time.
+ */
+
+/*
+ * Returns DISABLE (and does nothing) if the timer / channel / engine combination is not supported.
+ */
+uint8_t DITHER_Start(DITHER_Handle_t *pDitherHandle);
+
+/*
+ * New duty in fixed point (clamped to DITHER_DUTY(ARR + 1)).
+ * UPDATE_ISR engine: a single 32-bit store, safe from anywhere.
+ */
+void DITHER_SetDuty(uint32_t Duty);
+
+/*
+ * Stop dithering. CCRx keeps the last value written.
+ */
+void DITHER_Stop(void);
+
+#endif /* SOURCES_STM32F446XX_DITHER_DRIVER_H_ */
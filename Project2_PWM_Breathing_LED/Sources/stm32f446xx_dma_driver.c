@@ -0,0 +1,180 @@
+/*
+ * stm32f446xx_dma_driver.c
+ *
+ *  Created on: 2026/1/19
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_dma_driver.h"
+#include "stm32f446xx_pclk_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Callbacks per stream: [0] = DMA1, [1] = DMA2
+ */
+typedef struct{
+	DMA_Callback_t Half;
+	DMA_Callback_t Complete;
+} DMA_StreamHooks_t;
+
+static DMA_StreamHooks_t StreamHooks[2][8];
+
+/*
+ * Position of a stream's 6 flag bits inside LISR/HISR (and LIFCR/HIFCR):
+ * streams 0/4 -> bit 0, 1/5 -> bit 6, 2/6 -> bit 16, 3/7 -> bit 22
+ * Inside the group: FEIF 0, DMEIF 2, TEIF 3, HTIF 4, TCIF 5
+ */
+static const uint8_t FlagShift[4] = {0, 6, 16, 22};
+
+#define DMA_FLAG_HT     (1U << 4)
+#define DMA_FLAG_TC     (1U << 5)
+#define DMA_FLAGS_ALL   0x3DU   // FEIF | DMEIF | TEIF | HTIF | TCIF
+
+static uint8_t DMA_GetIndex(DMA_RegDef_t *pDMAx){
+	return (pDMAx == DMA2) ? 1 : 0;
+}
+
+static uint8_t DMA_GetIRQNumber(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	if (pDMAx == DMA1){
+		return (Stream < 7) ? (DMA1_STREAM0_IRQ + Stream) : DMA1_STREAM7_IRQ;
+	}
+	return (Stream < 5) ? (DMA2_STREAM0_IRQ + Stream) : (DMA2_STREAM5_IRQ + (Stream - 5U));
+}
+
+static uint32_t DMA_ReadFlags(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	uint32_t isr = (Stream < 4) ? pDMAx->LISR : pDMAx->HISR;
+	return (isr >> FlagShift[Stream & 3U]) & DMA_FLAGS_ALL;
+}
+
+static void DMA_ClearFlags(DMA_RegDef_t *pDMAx, uint8_t Stream, uint32_t Flags){
+	// IFCR bits are write-1-to-clear, zeros are ignored -> no read-modify-write needed
+	if (Stream < 4){
+		pDMAx->LIFCR = Flags << FlagShift[Stream];
+	}else{
+		pDMAx->HIFCR = Flags << FlagShift[Stream - 4U];
+	}
+}
+
+void DMA_PeriClockControl(DMA_RegDef_t *pDMAx, uint8_t EnableOrDisable){
+	uint8_t pclk_id = (pDMAx == DMA2) ? PCLK_DMA2 : PCLK_DMA1;
+
+	if (EnableOrDisable == ENABLE){
+		PCLK_Acquire(pclk_id);
+	}
+	else if (EnableOrDisable == DISABLE){
+		PCLK_Release(pclk_id);
+	}
+}
+
+void DMA_Init(DMA_Handle_t *pDMAHandle){
+	DMA_RegDef_t *pDMAx = pDMAHandle->pDMAx;
+	DMA_Config_t DMA_Config = pDMAHandle->DMA_Config;
+
+	if (DMA_Config.Stream > 7 || DMA_Config.Channel > 7){
+		return;
+	}
+	DMA_Stream_RegDef_t *pStream = DMA_STREAM(pDMAx, DMA_Config.Stream);
+
+	// 1. A stream can only be configured while EN = 0, and old flags block a new start
+	DMA_Stop(pDMAx, DMA_Config.Stream);
+	DMA_ClearFlags(pDMAx, DMA_Config.Stream, DMA_FLAGS_ALL);
+
+	// 2. Addresses and length
+	pStream->PAR = DMA_Config.PeriphAddr;
+	pStream->M0AR = DMA_Config.MemAddr;
+	pStream->NDTR = DMA_Config.Count;
+
+	/*
+	 * 3. CR
+	 * CHSEL (27:25) request channel, PL (17:16) priority,
+	 * MSIZE (14:13) = PSIZE (12:11) item size, MINC (10) memory increment,
+	 * PINC (9) = 0: the peripheral register stays the same, CIRC (8) circular,
+	 * DIR (7:6), HTIE (3) / TCIE (4) half / complete interrupt
+	 */
+	uint32_t cr = ((uint32_t)DMA_Config.Channel << 25) |
+	              ((uint32_t)(DMA_Config.Priority & 3U) << 16) |
+	              ((uint32_t)(DMA_Config.DataSize & 3U) << 13) |
+	              ((uint32_t)(DMA_Config.DataSize & 3U) << 11) |
+	              ((uint32_t)(DMA_Config.Direction & 3U) << 6);
+	if (DMA_Config.MemIncrement == ENABLE){
+		cr |= (1U << 10);
+	}
+	if (DMA_Config.Circular == ENABLE){
+		cr |= (1U << 8);
+	}
+	if (DMA_Config.HalfCallback != NULL){
+		cr |= (1U << 3);
+	}
+	if (DMA_Config.CompleteCallback != NULL){
+		cr |= (1U << 4);
+	}
+	pStream->CR = cr;
+
+	// 4. FCR DMDIS (bit 2) = 0: direct mode, no FIFO in between
+	pStream->FCR = 0;
+
+	// 5. Callbacks
+	DMA_StreamHooks_t *pHooks = &StreamHooks[DMA_GetIndex(pDMAx)][DMA_Config.Stream];
+	pHooks->Half = DMA_Config.HalfCallback;
+	pHooks->Complete = DMA_Config.CompleteCallback;
+	if (pHooks->Half != NULL || pHooks->Complete != NULL){
+		NVIC_ISER_Config(DMA_GetIRQNumber(pDMAx, DMA_Config.Stream));
+	}
+}
+
+void DMA_Start(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	if (Stream > 7){
+		return;
+	}
+	DMA_ClearFlags(pDMAx, Stream, DMA_FLAGS_ALL);
+	SET_BIT(DMA_STREAM(pDMAx, Stream)->CR, 0);
+}
+
+void DMA_Stop(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	if (Stream > 7){
+		return;
+	}
+	DMA_Stream_RegDef_t *pStream = DMA_STREAM(pDMAx, Stream);
+
+	CLEAR_BIT(pStream->CR, 0);
+	// The current item is finished before EN reads 0 (RM0390 - 9.3.17)
+	while (READ_BIT(pStream->CR, 0));
+}
+
+uint16_t DMA_GetRemaining(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	return (uint16_t)DMA_STREAM(pDMAx, Stream)->NDTR;
+}
+
+void DMA_IRQHandling(DMA_RegDef_t *pDMAx, uint8_t Stream){
+	uint32_t flags = DMA_ReadFlags(pDMAx, Stream);
+	DMA_StreamHooks_t *pHooks = &StreamHooks[DMA_GetIndex(pDMAx)][Stream];
+
+	DMA_ClearFlags(pDMAx, Stream, flags);
+
+	if ((flags & DMA_FLAG_HT) && pHooks->Half != NULL){
+		pHooks->Half(pDMAx, Stream);
+	}
+	if ((flags & DMA_FLAG_TC) && pHooks->Complete != NULL){
+		pHooks->Complete(pDMAx, Stream);
+	}
+}
+
+void DMA1_Stream0_IRQHandler(void){ DMA_IRQHandling(DMA1, 0); }
+void DMA1_Stream1_IRQHandler(void){ DMA_IRQHandling(DMA1, 1); }
+void DMA1_Stream2_IRQHandler(void){ DMA_IRQHandling(DMA1, 2); }
+void DMA1_Stream3_IRQHandler(void){ DMA_IRQHandling(DMA1, 3); }
+void DMA1_Stream4_IRQHandler(void){ DMA_IRQHandling(DMA1, 4); }
+void DMA1_Stream5_IRQHandler(void){ DMA_IRQHandling(DMA1, 5); }
+void DMA1_Stream6_IRQHandler(void){ DMA_IRQHandling(DMA1, 6); }
+void DMA1_Stream7_IRQHandler(void){ DMA_IRQHandling(DMA1, 7); }
+
+void DMA2_Stream0_IRQHandler(void){ DMA_IRQHandling(DMA2, 0); }
+void DMA2_Stream1_IRQHandler(void){ DMA_IRQHandling(DMA2, 1); }
+void DMA2_Stream2_IRQHandler(void){ DMA_IRQHandling(DMA2, 2); }
+void DMA2_Stream3_IRQHandler(void){ DMA_IRQHandling(DMA2, 3); }
+void DMA2_Stream4_IRQHandler(void){ DMA_IRQHandling(DMA2, 4); }
+void DMA2_Stream5_IRQHandler(void){ DMA_IRQHandling(DMA2, 5); }
+void DMA2_Stream6_IRQHandler(void){ DMA_IRQHandling(DMA2, 6); }
+void DMA2_Stream7_IRQHandler(void){ DMA_IRQHandling(DMA2, 7); }
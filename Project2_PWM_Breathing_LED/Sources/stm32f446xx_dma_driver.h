@@ -0,0 +1,122 @@
+/*
+ * stm32f446xx_dma_driver.h
+ *
+ *  Created on: 2026/1/19
+ *      Author: Yuheng
+ *
+ * Description:
+ * Minimal DMA stream driver (DMA1 / DMA2, peripheral <-> memory).
+ *
+ * Why?
+ * Some jobs are "copy one register to/from RAM on every hardware event":
+ * storing capture timestamps, feeding new compare values to a timer...
+ * Doing that in an interrupt costs an IRQ entry/exit for every single word.
+ * A DMA stream does the copy on the bus by itself, the CPU is only told
+ * when half / all of the buffer is done (or never, in circular mode).
+ *
+ * Streams and channels:
+ * Every peripheral request is wired to ONE fixed (stream, channel) pair,
+ * e.g. TIM2_CH1 -> DMA1 Stream 5 Channel 3. The mapping is in
+ * RM0390 - 9.3.3 Channel selection, Table 28 (DMA1) and Table 29 (DMA2).
+ * A stream can only serve one request at a time.
+ *
+ * Refer to RM0390 - 9 Direct memory access controller (DMA)
+ */
+
+#ifndef SOURCES_STM32F446XX_DMA_DRIVER_H_
+#define SOURCES_STM32F446XX_DMA_DRIVER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Peripheral Clock Setup
+ * ==========================================
+ * Reference-counted through the clock manager (stm32f446xx_pclk_driver.h).
+ */
+void DMA_PeriClockControl(DMA_RegDef_t *pDMAx, uint8_t EnableOrDisable);
+
+/*
+ * ==========================================
+ * 2. Configuration Structures
+ * ==========================================
+ */
+
+/* @DMA_DIRECTION (CR bits 7:6 DIR) */
+#define DMA_DIR_PERIPH_TO_MEM   0
+#define DMA_DIR_MEM_TO_PERIPH   1
+
+/* @DMA_DATA_SIZE (CR PSIZE bits 12:11 / MSIZE bits 14:13) */
+#define DMA_SIZE_BYTE           0
+#define DMA_SIZE_HALFWORD       1
+#define DMA_SIZE_WORD           2
+
+/* @DMA_PRIORITY (CR bits 17:16 PL) */
+#define DMA_PRIORITY_LOW        0
+#define DMA_PRIORITY_MEDIUM     1
+#define DMA_PRIORITY_HIGH       2
+#define DMA_PRIORITY_VERY_HIGH  3
+
+/*
+ * Called from the stream interrupt.
+ * In circular mode: Half = first half of the buffer is done (safe to refill it),
+ * Complete = second half is done and the stream started over from the beginning.
+ */
+typedef void (*DMA_Callback_t)(DMA_RegDef_t *pDMAx, uint8_t Stream);
+
+typedef struct{
+	uint8_t Stream;                 // 0-7
+	uint8_t Channel;                // 0-7, request line of the peripheral (see Table 28/29)
+	uint8_t Direction;              // Possible values: @DMA_DIRECTION
+	uint8_t DataSize;               // Possible values: @DMA_DATA_SIZE (same on both sides)
+	uint8_t MemIncrement;           // ENABLE: walk through the buffer, DISABLE: always the same word
+	uint8_t Circular;               // ENABLE: restart at the beginning forever
+	uint8_t Priority;               // Possible values: @DMA_PRIORITY
+	uint32_t PeriphAddr;            // e.g. (uint32_t)&TIM2->CCR1
+	uint32_t MemAddr;               // buffer
+	uint16_t Count;                 // number of items (not bytes), 1-65535
+	DMA_Callback_t HalfCallback;    // optional (NULL)
+	DMA_Callback_t CompleteCallback;// optional (NULL)
+} DMA_Config_t;
+
+typedef struct{
+	DMA_RegDef_t *pDMAx;            // DMA1 or DMA2
+	DMA_Config_t DMA_Config;
+} DMA_Handle_t;
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Stop the stream, program it from the handle and enable its interrupt if a
+ * callback is given. The stream is NOT started (see DMA_Start).
+ * Direct mode (no FIFO): one peripheral request moves exactly one item.
+ */
+void DMA_Init(DMA_Handle_t *pDMAHandle);
+
+void DMA_Start(DMA_RegDef_t *pDMAx, uint8_t Stream);
+
+/*
+ * Disable the stream and wait until the hardware has really let go of it
+ * (EN reads back 0), so it can be reprogrammed right after.
+ */
+void DMA_Stop(DMA_RegDef_t *pDMAx, uint8_t Stream);
+
+/*
+ * Items still to transfer (NDTR). In circular mode: Count - NDTR is where the
+ * stream will write/read next.
+ */
+uint16_t DMA_GetRemaining(DMA_RegDef_t *pDMAx, uint8_t Stream);
+
+/*
+ * Common IRQ body: clears the stream flags and calls its callbacks.
+ * Every DMAx_StreamN_IRQHandler is implemented in the driver.
+ */
+void DMA_IRQHandling(DMA_RegDef_t *pDMAx, uint8_t Stream);
+
+#endif /* SOURCES_STM32F446XX_DMA_DRIVER_H_ */
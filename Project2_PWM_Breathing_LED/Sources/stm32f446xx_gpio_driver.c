@@ -6,90 +6,65 @@
  */
 
 #include "stm32f446xx_gpio_driver.h"
+#include "stm32f446xx_pclk_driver.h"
 #include <stdint.h>
 #include <stdio.h>
 
+/*
+ * Helper function: Calculates Port Code (0 for A, 1 for B, 2 for C...)
+ * Logic: (Current_Addr - Base_Addr) / Block_Size
+ * Inspiration comes from Leetcode 242. Valid Anagram
+ * ==========================================
+ * Note: static in C functions to encapsulate
+ * it means "Private", which is the opposite of what it means in Java (global)
+ * since Get_Port_Code is just a calculation tool
+ * it does not need to be exposed to the user (main.c)
+ */
+static uint8_t Get_Port_Code(GPIO_RegDef_t *pGPIOx){
+	return ((uint32_t)pGPIOx - (uint32_t)GPIOA_BASEADDR) / 0x400;
+}
+
 /*
  * Peripheral Clock Setup
  * Must be called FIRST before using any GPIO Port.
  * 'EnableOrDisable' should be ENABLE or DISABLE macros.
+ *
+ * [UPDATED: Reference-counted]
+ * Instead of an if/else chain over GPIOx_PCLK_EN/DIS, the port code (0 for A, 1 for B...)
+ * is used directly as an offset into the clock manager's table (PCLK_GPIOA + code).
+ * ENABLE takes a reference, DISABLE drops one; the clock is only really switched off
+ * when the last user of the port has released it.
  */
 void GPIO_PeriClockControl(GPIO_RegDef_t *pGPIOx, uint8_t EnableOrDisable){
+	uint8_t port_code = Get_Port_Code(pGPIOx);
+	if (port_code > (PCLK_GPIOH - PCLK_GPIOA)){
+		return; // not a GPIO port
+	}
+
 	if (EnableOrDisable == ENABLE){
-		if (pGPIOx == GPIOA){
-			GPIOA_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOB){
-			GPIOB_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOC){
-			GPIOC_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOD){
-			GPIOD_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOE){
-			GPIOE_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOF){
-			GPIOF_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOG){
-			GPIOG_PCLK_EN();
-		}
-		else if (pGPIOx == GPIOH){
-			GPIOH_PCLK_EN();
-		}
+		PCLK_Acquire(PCLK_GPIOA + port_code);
 	}
 	else if (EnableOrDisable == DISABLE){
-		if (pGPIOx == GPIOA){
-			GPIOA_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOB){
-			GPIOB_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOC){
-			GPIOC_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOD){
-			GPIOD_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOE){
-			GPIOE_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOF){
-			GPIOF_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOG){
-			GPIOG_PCLK_DIS();
-		}
-		else if (pGPIOx == GPIOH){
-			GPIOH_PCLK_DIS();
-		}
+		PCLK_Release(PCLK_GPIOA + port_code);
 	}
 	// if it gets here, argument EnableOrDisable passed in is invalid input
-	else{
-		return;
-	}
 }
 
 /*
- * Helper function: Calculates Port Code (0 for A, 1 for B, 2 for C...)
- * Logic: (Current_Addr - Base_Addr) / Block_Size
- * Inspiration comes from Leetcode 242. Valid Anagram
- * ==========================================
- * Note: static in C functions to encapsulate
- * it means "Private", which is the opposite of what it means in Java (global)
- * since Get_Port_Code is just a calculation tool
- * it does not need to be exposed to the user (main.c)
+ * EXTI lines that hold a SYSCFG clock reference (bit y = line y)
  */
-static uint8_t Get_Port_Code(GPIO_RegDef_t *pGPIOx){
-	return ((uint32_t)pGPIOx - (uint32_t)GPIOA_BASEADDR) / 0x400;
-}
+static uint16_t SyscfgLines;
 
 void GPIO_SYSCFG_Config(GPIO_RegDef_t* pGPIOx, uint8_t PinNumber){
-	// Enable SYSCFG
-	SYSCFG_PCLK_EN();
+	/*
+	 * Enable SYSCFG: one reference per EXTI line that uses it, taken the first time
+	 * the line is routed. Re-routing a line (or re-initialising the pin) takes no
+	 * new one, otherwise every GPIO_Init in IT mode would grow the count forever.
+	 */
+	if ((SyscfgLines & (1U << PinNumber)) == 0){
+		SyscfgLines |= (uint16_t)(1U << PinNumber);
+		PCLK_Acquire(PCLK_SYSCFG);
+	}
 
 	// calculate where the target Pin fits in EXTICR
 	// e.g. Pin 13 -> 13 / 4 = 3
@@ -330,6 +305,75 @@ void GPIO_Init(GPIO_Handle_t *pGPIOHandle){
 	}
 }
 
+/*
+ * Helpers for GPIO_InitMask: spread a pin mask into register fields (no loop, no branch)
+ * Spread2: pin y -> bit 2y    (MODER / OSPEEDR / PUPDR, 2 bits per pin), e.g. 0b101 -> 0b010001
+ * Spread4: pin y -> bit 4y    (AFRL / AFRH, 4 bits per pin, 8 pins per register)
+ * Multiplying the result by a field value copies that value into every selected field,
+ * multiplying by 3 (or 0xF) gives the clear mask.
+ */
+static uint32_t GPIO_Spread2(uint16_t PinMask){
+	uint32_t x = PinMask;
+
+	x = (x | (x << 8)) & 0x00FF00FFU;
+	x = (x | (x << 4)) & 0x0F0F0F0FU;
+	x = (x | (x << 2)) & 0x33333333U;
+	x = (x | (x << 1)) & 0x55555555U;
+	return x;
+}
+
+static uint32_t GPIO_Spread4(uint8_t PinMask){
+	uint32_t x = PinMask;
+
+	x = (x | (x << 12)) & 0x000F000FU;
+	x = (x | (x << 6)) & 0x03030303U;
+	x = (x | (x << 3)) & 0x11111111U;
+	return x;
+}
+
+/*
+ * Same configuration for every pin in PinMask.
+ * GPIO_Init does a separate read-modify-write (clear, then set) of every register
+ * per pin: 16 pins = about 80 RMW sequences. Here the fields of all pins are combined
+ * first, in CPU registers, and every GPIO register is read once and written once.
+ *
+ * Order: OTYPER, OSPEEDR, PUPDR, AFR first, MODER last. A pin only starts to drive
+ * (output / alternate function) once everything else is already set, so the whole
+ * group switches to its final state in one write.
+ */
+void GPIO_InitMask(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, const GPIO_PinConfig_t *pConfig){
+	uint32_t lanes2 = GPIO_Spread2(PinMask); // 01 in the 2-bit field of each selected pin
+	uint32_t clear2 = lanes2 * 3U;
+
+	if (PinMask == 0 || pConfig->GPIO_PinMode > GPIO_MODE_ANALOG){
+		return; // interrupt modes need SYSCFG / EXTI / NVIC per pin: GPIO_Init
+	}
+
+	if (pConfig->GPIO_PinOPType <= GPIO_OP_TYPE_OD){
+		uint32_t otyper = pGPIOx->OTYPER & ~(uint32_t)PinMask;
+		pGPIOx->OTYPER = (pConfig->GPIO_PinOPType == GPIO_OP_TYPE_OD) ? (otyper | PinMask) : otyper;
+	}
+	if (pConfig->GPIO_PinSpeed <= GPIO_SPEED_VERY_HIGH){
+		pGPIOx->OSPEEDR = (pGPIOx->OSPEEDR & ~clear2) | (lanes2 * pConfig->GPIO_PinSpeed);
+	}
+	if (pConfig->GPIO_PinPuPdControl <= GPIO_PIN_PD){
+		pGPIOx->PUPDR = (pGPIOx->PUPDR & ~clear2) | (lanes2 * pConfig->GPIO_PinPuPdControl);
+	}
+	if (pConfig->GPIO_PinMode == GPIO_MODE_ALTN){
+		uint32_t lanes_l = GPIO_Spread4((uint8_t)PinMask);        // pins 0-7  -> AFRL
+		uint32_t lanes_h = GPIO_Spread4((uint8_t)(PinMask >> 8)); // pins 8-15 -> AFRH
+		uint32_t af = pConfig->GPIO_PinAltFunMode & 0xFU;
+
+		if (lanes_l != 0){
+			pGPIOx->AFR[0] = (pGPIOx->AFR[0] & ~(lanes_l * 0xFU)) | (lanes_l * af);
+		}
+		if (lanes_h != 0){
+			pGPIOx->AFR[1] = (pGPIOx->AFR[1] & ~(lanes_h * 0xFU)) | (lanes_h * af);
+		}
+	}
+	pGPIOx->MODER = (pGPIOx->MODER & ~clear2) | (lanes2 * pConfig->GPIO_PinMode);
+}
+
 /*
  * AHB1 Bus Reset Macros Implementation
  */
@@ -442,6 +486,15 @@ void GPIO_WriteToOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t Val
     }
 }
 
+/*
+ * Writing to Output Pins: same BSRR path as above, but for a whole group of pins.
+ * Set and reset halves are written together, so all pins of PinMask switch
+ * on the same bus cycle (no read-modify-write of ODR).
+ */
+void GPIO_WriteToOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, uint16_t Value){
+	pGPIOx->BSRR = GPIO_BSRR_WORD(PinMask, Value);
+}
+
 /*
  * Writing to Output Port: writes to the entire port at once
  * RM390 states that "Reserved bits Must be kept at reset value (0)"
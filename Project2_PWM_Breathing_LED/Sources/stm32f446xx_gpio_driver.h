@@ -103,6 +103,8 @@ typedef struct{
  * Bit 0 = GPIOA, Bit 1 = GPIOB, etc.
  * Kept here for backward compatibility with Project 1 code.
  * (Alternatively, could use RCC->AHB1ENR structure access)
+ * NOTE: these bypass the reference counts of the clock manager,
+ * new code should use GPIO_PeriClockControl / PCLK_Acquire instead.
  */
 #define GPIOA_PCLK_EN()     ( RCC->AHB1ENR |= (1 << 0) )
 #define GPIOB_PCLK_EN()     ( RCC->AHB1ENR |= (1 << 1) )
@@ -176,6 +178,8 @@ void GPIOH_REG_RESET(void);
  * Peripheral Clock Setup
  * Must be called FIRST before using any GPIO Port.
  * 'EnableOrDisable' should be ENABLE or DISABLE macros.
+ * Reference-counted through the clock manager (stm32f446xx_pclk_driver.h):
+ * every ENABLE must eventually be matched by one DISABLE.
  */
 void GPIO_PeriClockControl(GPIO_RegDef_t *pGPIOx, uint8_t EnableOrDisable);
 
@@ -187,6 +191,15 @@ void GPIO_PeriClockControl(GPIO_RegDef_t *pGPIOx, uint8_t EnableOrDisable);
 void GPIO_Init(GPIO_Handle_t *pGPIOHandle);
 void GPIO_DeInit(GPIO_RegDef_t *pGPIOx);
 
+/*
+ * Batched initialization: the same configuration for every pin in PinMask
+ * (e.g. 0xFFFF for a 16-bit bus), with ONE read and ONE write per register
+ * instead of one read-modify-write per register and pin.
+ * pConfig->GPIO_PinNumber is ignored. Modes IN / OUT / ALTN / ANALOG only:
+ * interrupt modes are ignored here (they need GPIO_Init, pin by pin).
+ */
+void GPIO_InitMask(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, const GPIO_PinConfig_t *pConfig);
+
 /*
  * Data Read and Write
  * Reading from Input Pin: returns 0 or 1.
@@ -202,6 +215,16 @@ uint16_t GPIO_ReadFromInputPort(GPIO_RegDef_t *pGPIOx);
  */
 void GPIO_WriteToOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber, uint8_t Value);
 void GPIO_WriteToOutputPort(GPIO_RegDef_t *pGPIOx, uint16_t Value);
+
+/*
+ * Writing to Output Pins: several pins of one port in ONE atomic BSRR write.
+ * Only the pins in PinMask change: the ones set in Value go high, the others low.
+ * GPIO_BSRR_WORD builds the same word ahead of time, for code that stores
+ * precomputed writes (e.g. the bit planes of stm32f446xx_bam_driver.c).
+ */
+#define GPIO_BSRR_WORD(PinMask, Value) \
+	((uint32_t)((PinMask) & (Value)) | ((uint32_t)((PinMask) & (uint16_t)~(Value)) << 16))
+void GPIO_WriteToOutputPins(GPIO_RegDef_t *pGPIOx, uint16_t PinMask, uint16_t Value);
 void GPIO_ToggleOutputPin(GPIO_RegDef_t *pGPIOx, uint8_t PinNumber);
 
 /*
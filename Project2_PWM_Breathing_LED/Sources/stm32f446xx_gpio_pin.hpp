@@ -0,0 +1,239 @@
+/*
+ * stm32f446xx_gpio_pin.hpp
+ *
+ *  Created on: 2026/1/26
+ *      Author: Yuheng
+ *
+ * Description:
+ * Header-only C++ layer over the GPIO registers: a pin is a TYPE, not a runtime argument.
+ *   using LED = gpio::Pin<gpio::PortA, 5>;
+ *   LED::init<gpio::Mode::Output>();
+ *   LED::set();
+ *
+ * Why?
+ * GPIO_WriteToOutputPin(GPIOA, 5, GPIO_PIN_SET) receives the port and the pin number at
+ * runtime: the call, the compare on Value and the shift (1U << (PinNumber + 16)) happen
+ * on every single write. Here port and pin are template parameters, so the BSRR word is a
+ * constant and every access is inlined:
+ *   set / clear / write  -> ONE store of an immediate to BSRR
+ *   read                 -> ONE load of IDR (+ bit extract)
+ *   toggle               -> one load of ODR, one store to BSRR (atomic, unlike ODR ^=)
+ * Tools/check_pin_codegen.py compiles these for the Cortex-M4 and counts the instructions.
+ *
+ * Compile-time checks (static_assert, nothing left for runtime):
+ * - pin number 0-15, and the pin must exist on the STM32F446RE (LQFP64): PA, PB, PC, PD2, PH0/PH1
+ * - AF number only with Mode::AltFn, 0-15
+ * - open drain only for outputs / alternate functions, no pull resistor in analog mode
+ * - PA13 / PA14 (SWDIO / SWCLK) only as AF0: anything else locks out the debugger
+ * - PinGroup: all pins on one port (one BSRR write), no pin twice
+ *
+ * PinGroup<Pins...> handles several pins of one port at once (e.g. a parallel bus),
+ * configured with GPIO_InitMask (one write per register).
+ *
+ * Requirements: C++17 (-std=gnu++17, fold expressions). The C drivers stay the
+ * reference: init() calls GPIO_InitMask, the clock still comes from GPIO_PeriClockControl.
+ */
+
+#ifndef SOURCES_STM32F446XX_GPIO_PIN_HPP_
+#define SOURCES_STM32F446XX_GPIO_PIN_HPP_
+
+#include <stdint.h>
+
+extern "C" {
+#include "stm32f446xx.h"
+#include "stm32f446xx_gpio_driver.h"
+}
+
+namespace gpio {
+
+/*
+ * ==========================================
+ * 1. Configuration Types
+ * ==========================================
+ * Same values as the C macros, so they go straight into GPIO_PinConfig_t.
+ */
+enum class Port : uint32_t {
+	A = GPIOA_BASEADDR,
+	B = GPIOB_BASEADDR,
+	C = GPIOC_BASEADDR,
+	D = GPIOD_BASEADDR,
+	E = GPIOE_BASEADDR,
+	F = GPIOF_BASEADDR,
+	G = GPIOG_BASEADDR,
+	H = GPIOH_BASEADDR,
+};
+
+constexpr Port PortA = Port::A;
+constexpr Port PortB = Port::B;
+constexpr Port PortC = Port::C;
+constexpr Port PortD = Port::D;
+constexpr Port PortE = Port::E;
+constexpr Port PortF = Port::F;
+constexpr Port PortG = Port::G;
+constexpr Port PortH = Port::H;
+
+enum class Mode : uint8_t {
+	Input = GPIO_MODE_IN,
+	Output = GPIO_MODE_OUT,
+	AltFn = GPIO_MODE_ALTN,
+	Analog = GPIO_MODE_ANALOG,
+};
+
+enum class Pull : uint8_t {
+	None = GPIO_NO_PUPD,
+	Up = GPIO_PIN_PU,
+	Down = GPIO_PIN_PD,
+};
+
+enum class OutType : uint8_t {
+	PushPull = GPIO_OP_TYPE_PP,
+	OpenDrain = GPIO_OP_TYPE_OD,
+};
+
+enum class Speed : uint8_t {
+	Low = GPIO_SPEED_LOW,
+	Medium = GPIO_SPEED_MEDIUM,
+	High = GPIO_SPEED_HIGH,
+	VeryHigh = GPIO_SPEED_VERY_HIGH,
+};
+
+namespace detail {
+
+/*
+ * Pins bonded out on the STM32F446RE (LQFP64, NUCLEO-F446RE), one mask per port A-H.
+ * Other packages: adjust this table.
+ */
+constexpr uint16_t BondedPins[8] = {0xFFFF, 0xFFFF, 0xFFFF, 0x0004, 0x0000, 0x0000, 0x0000, 0x0003};
+
+constexpr uint8_t PortIndex(Port P){
+	return static_cast<uint8_t>((static_cast<uint32_t>(P) - GPIOA_BASEADDR) / 0x400U);
+}
+
+constexpr bool PinExists(Port P, uint8_t N){
+	return N <= 15 && ((BondedPins[PortIndex(P)] >> N) & 1U) != 0;
+}
+
+/*
+ * Register block of a port. The address is a template constant: after inlining,
+ * the compiler loads it once as a literal, there is no pointer to pass around.
+ */
+template <Port P>
+inline GPIO_RegDef_t *Regs(){
+	return reinterpret_cast<GPIO_RegDef_t *>(static_cast<uint32_t>(P));
+}
+
+/*
+ * Valid configurations only (shared by Pin and PinGroup), then GPIO_InitMask
+ */
+template <Port P, uint16_t Mask, Mode M, Pull U, OutType T, Speed S, uint8_t AF>
+inline void InitMask(){
+	static_assert(AF <= 15, "alternate function number must be 0-15");
+	static_assert(M == Mode::AltFn || AF == 0, "an AF number only makes sense with Mode::AltFn");
+	static_assert(T == OutType::PushPull || M == Mode::Output || M == Mode::AltFn,
+	              "open drain is an output setting: use Mode::Output or Mode::AltFn");
+	static_assert(M != Mode::Analog || U == Pull::None, "analog pins must not have a pull resistor");
+	static_assert(P != Port::A || (Mask & 0x6000U) == 0 || (M == Mode::AltFn && AF == 0),
+	              "PA13 / PA14 are SWDIO / SWCLK: any setting other than AF0 locks out the debugger");
+
+	static const GPIO_PinConfig_t Config = {
+		0, // GPIO_PinNumber: unused by GPIO_InitMask
+		static_cast<uint8_t>(M),
+		static_cast<uint8_t>(S),
+		static_cast<uint8_t>(U),
+		static_cast<uint8_t>(T),
+		AF,
+	};
+	GPIO_InitMask(Regs<P>(), Mask, &Config);
+}
+
+} // namespace detail
+
+/*
+ * ==========================================
+ * 2. Single Pin
+ * ==========================================
+ */
+template <Port P, uint8_t N>
+struct Pin{
+	static_assert(N <= 15, "pin number must be 0-15");
+	static_assert(detail::PinExists(P, N), "this pin is not bonded out on the STM32F446RE (LQFP64)");
+
+	static constexpr Port port = P;
+	static constexpr uint8_t number = N;
+	static constexpr uint16_t mask = static_cast<uint16_t>(1U << N);
+
+	template <Mode M, Pull U = Pull::None, OutType T = OutType::PushPull, Speed S = Speed::Low, uint8_t AF = 0>
+	static void init(){
+		detail::InitMask<P, mask, M, U, T, S, AF>();
+	}
+
+	static void set(){
+		detail::Regs<P>()->BSRR = mask;                              // BSy
+	}
+
+	static void clear(){
+		detail::Regs<P>()->BSRR = static_cast<uint32_t>(mask) << 16; // BRy
+	}
+
+	static void write(bool Value){
+		detail::Regs<P>()->BSRR = Value ? mask : (static_cast<uint32_t>(mask) << 16);
+	}
+
+	/*
+	 * BSRR instead of ODR ^= mask: an interrupt that changes another pin of the port
+	 * between the read and the write cannot be undone by this write.
+	 */
+	static void toggle(){
+		uint32_t odr = detail::Regs<P>()->ODR;
+		detail::Regs<P>()->BSRR = ((odr & mask) << 16) | (~odr & mask);
+	}
+
+	static bool read(){
+		return (detail::Regs<P>()->IDR & mask) != 0;
+	}
+};
+
+/*
+ * ==========================================
+ * 3. Pin Group (several pins of ONE port)
+ * ==========================================
+ * using Bus = gpio::PinGroup<gpio::Pin<gpio::PortB, 0>, gpio::Pin<gpio::PortB, 1>, ...>;
+ * write() / read() use the port's bit positions (bit y = pin y), the other pins of the
+ * port are left alone.
+ */
+template <typename First, typename... Rest>
+struct PinGroup{
+	static constexpr Port port = First::port;
+	static constexpr uint16_t mask = static_cast<uint16_t>(First::mask | (Rest::mask | ... | 0U));
+
+	static_assert(((Rest::port == port) && ... && true), "all pins of a PinGroup must be on the same port");
+	static_assert((First::mask + (Rest::mask + ... + 0U)) == mask, "a pin appears twice in the PinGroup");
+
+	template <Mode M, Pull U = Pull::None, OutType T = OutType::PushPull, Speed S = Speed::Low, uint8_t AF = 0>
+	static void init(){
+		detail::InitMask<port, mask, M, U, T, S, AF>();
+	}
+
+	static void set(){
+		detail::Regs<port>()->BSRR = mask;
+	}
+
+	static void clear(){
+		detail::Regs<port>()->BSRR = static_cast<uint32_t>(mask) << 16;
+	}
+
+	/*
+	 * Pins of the group whose bit is 1 in Value go high, the others low, in one write.
+	 */
+	static void write(uint16_t Value){
+		detail::Regs<port>()->BSRR = GPIO_BSRR_WORD(mask, Value);
+	}
+
+	static uint16_t read(){
+		return static_cast<uint16_t>(detail::Regs<port>()->IDR & mask);
+	}
+};
+
+} // namespace gpio
+
+#endif /* SOURCES_STM32F446XX_GPIO_PIN_HPP_ */
@@ -0,0 +1,150 @@
+/*
+ * stm32f446xx_pclk_driver.c
+ *
+ *  Created on: 2026/1/13
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_pclk_driver.h"
+#include <stdint.h>
+
+/*
+ * Bus -> enable register
+ * Indexed by PCLK_BUS_xxx.
+ */
+static volatile uint32_t * const BusEnableReg[3] = {
+	&RCC->AHB1ENR,
+	&RCC->APB1ENR,
+	&RCC->APB2ENR,
+};
+
+/*
+ * Peripheral ID -> {bus, bit}
+ * Indexed by PCLK_xxx (see @PCLK_IDS). Designated initializers keep
+ * every line pinned to its ID, so a typo cannot silently shift the table.
+ */
+static const PCLK_Entry_t PclkTable[PCLK_COUNT] = {
+	/* AHB1 (RCC_AHB1ENR) */
+	[PCLK_GPIOA]  = {PCLK_BUS_AHB1, 0},
+	[PCLK_GPIOB]  = {PCLK_BUS_AHB1, 1},
+	[PCLK_GPIOC]  = {PCLK_BUS_AHB1, 2},
+	[PCLK_GPIOD]  = {PCLK_BUS_AHB1, 3},
+	[PCLK_GPIOE]  = {PCLK_BUS_AHB1, 4},
+	[PCLK_GPIOF]  = {PCLK_BUS_AHB1, 5},
+	[PCLK_GPIOG]  = {PCLK_BUS_AHB1, 6},
+	[PCLK_GPIOH]  = {PCLK_BUS_AHB1, 7},
+	[PCLK_CRC]    = {PCLK_BUS_AHB1, 12},
+	[PCLK_DMA1]   = {PCLK_BUS_AHB1, 21},
+	[PCLK_DMA2]   = {PCLK_BUS_AHB1, 22},
+	/* APB1 (RCC_APB1ENR) */
+	[PCLK_TIM2]   = {PCLK_BUS_APB1, 0},
+	[PCLK_TIM3]   = {PCLK_BUS_APB1, 1},
+	[PCLK_TIM4]   = {PCLK_BUS_APB1, 2},
+	[PCLK_TIM5]   = {PCLK_BUS_APB1, 3},
+	[PCLK_TIM6]   = {PCLK_BUS_APB1, 4},
+	[PCLK_TIM7]   = {PCLK_BUS_APB1, 5},
+	[PCLK_TIM12]  = {PCLK_BUS_APB1, 6},
+	[PCLK_TIM13]  = {PCLK_BUS_APB1, 7},
+	[PCLK_TIM14]  = {PCLK_BUS_APB1, 8},
+	[PCLK_WWDG]   = {PCLK_BUS_APB1, 11},
+	[PCLK_SPI2]   = {PCLK_BUS_APB1, 14},
+	[PCLK_SPI3]   = {PCLK_BUS_APB1, 15},
+	[PCLK_USART2] = {PCLK_BUS_APB1, 17},
+	[PCLK_USART3] = {PCLK_BUS_APB1, 18},
+	[PCLK_UART4]  = {PCLK_BUS_APB1, 19},
+	[PCLK_UART5]  = {PCLK_BUS_APB1, 20},
+	[PCLK_I2C1]   = {PCLK_BUS_APB1, 21},
+	[PCLK_I2C2]   = {PCLK_BUS_APB1, 22},
+	[PCLK_I2C3]   = {PCLK_BUS_APB1, 23},
+	[PCLK_CAN1]   = {PCLK_BUS_APB1, 25},
+	[PCLK_CAN2]   = {PCLK_BUS_APB1, 26},
+	[PCLK_PWR]    = {PCLK_BUS_APB1, 28},
+	[PCLK_DAC]    = {PCLK_BUS_APB1, 29},
+	/* APB2 (RCC_APB2ENR) */
+	[PCLK_TIM1]   = {PCLK_BUS_APB2, 0},
+	[PCLK_TIM8]   = {PCLK_BUS_APB2, 1},
+	[PCLK_USART1] = {PCLK_BUS_APB2, 4},
+	[PCLK_USART6] = {PCLK_BUS_APB2, 5},
+	[PCLK_ADC1]   = {PCLK_BUS_APB2, 8},
+	[PCLK_ADC2]   = {PCLK_BUS_APB2, 9},
+	[PCLK_ADC3]   = {PCLK_BUS_APB2, 10},
+	[PCLK_SDIO]   = {PCLK_BUS_APB2, 11},
+	[PCLK_SPI1]   = {PCLK_BUS_APB2, 12},
+	[PCLK_SPI4]   = {PCLK_BUS_APB2, 13},
+	[PCLK_SYSCFG] = {PCLK_BUS_APB2, 14},
+	[PCLK_TIM9]   = {PCLK_BUS_APB2, 16},
+	[PCLK_TIM10]  = {PCLK_BUS_APB2, 17},
+	[PCLK_TIM11]  = {PCLK_BUS_APB2, 18},
+	[PCLK_SAI1]   = {PCLK_BUS_APB2, 22},
+	[PCLK_SAI2]   = {PCLK_BUS_APB2, 23},
+};
+
+/*
+ * Number of users per peripheral.
+ * uint8_t is plenty: 255 simultaneous owners of one peripheral would be a bug anyway.
+ * A count that reaches PCLK_REF_MAX sticks there (the clock then stays on for good):
+ * wrapping to 0 would let the next Release gate the clock under live users.
+ */
+#define PCLK_REF_MAX        0xFFU
+
+static uint8_t PclkRefCount[PCLK_COUNT];
+
+/*
+ * Nestable interrupt masking: the timer, DMA and BAM paths acquire and release
+ * clocks from interrupt context too, and both the count and the ENR update are
+ * read-modify-writes.
+ */
+static uint32_t PCLK_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void PCLK_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+void PCLK_Acquire(uint8_t PclkId){
+	if (PclkId >= PCLK_COUNT){
+		return;
+	}
+
+	uint32_t primask = PCLK_EnterCritical();
+	if (PclkRefCount[PclkId] == 0){
+		volatile uint32_t *pENR = BusEnableReg[PclkTable[PclkId].Bus];
+		SET_BIT(*pENR, PclkTable[PclkId].Bit);
+
+		/*
+		 * Dummy read-back: the peripheral is only usable 2 clock cycles after
+		 * the enable bit is written (STM32F446 errata 2.2.13 "Delay after an RCC
+		 * peripheral clock enabling"). Reading the register provides that delay.
+		 */
+		(void)*pENR;
+	}
+	if (PclkRefCount[PclkId] < PCLK_REF_MAX){
+		PclkRefCount[PclkId]++;
+	}
+	PCLK_ExitCritical(primask);
+}
+
+void PCLK_Release(uint8_t PclkId){
+	if (PclkId >= PCLK_COUNT){
+		return;
+	}
+
+	uint32_t primask = PCLK_EnterCritical();
+	if (PclkRefCount[PclkId] != 0 && PclkRefCount[PclkId] != PCLK_REF_MAX){
+		if (--PclkRefCount[PclkId] == 0){
+			CLEAR_BIT(*BusEnableReg[PclkTable[PclkId].Bus], PclkTable[PclkId].Bit);
+		}
+	}
+	PCLK_ExitCritical(primask);
+}
+
+uint8_t PCLK_GetRefCount(uint8_t PclkId){
+	if (PclkId >= PCLK_COUNT){
+		return 0;
+	}
+	return PclkRefCount[PclkId];
+}
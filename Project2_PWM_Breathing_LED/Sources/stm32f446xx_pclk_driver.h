@@ -0,0 +1,139 @@
+/*
+ * stm32f446xx_pclk_driver.h
+ *
+ * Created on: 2026/1/13
+ * Author: Yuheng
+ *
+ * Description:
+ * Peripheral Clock (PCLK) Gating Manager.
+ *
+ * Why?
+ * Before this, every peripheral had its own enable macro (GPIOA_PCLK_EN, TIM2_PCLK_EN, ...)
+ * and GPIO_PeriClockControl walked an if/else chain to find the right one.
+ * Nobody ever turned a clock OFF, because nobody knew whether another driver
+ * was still using that peripheral. A clocked-but-idle peripheral still burns power.
+ *
+ * How it works:
+ * 1. Table-driven: every peripheral has an ID (@PCLK_IDS). The ID is an index into a
+ *    const table that stores which bus register (AHB1ENR/APB1ENR/APB2ENR) and which bit
+ *    gates it -> O(1) lookup, no branch chains.
+ * 2. Reference-counted: each driver calls PCLK_Acquire() when it starts using a
+ *    peripheral and PCLK_Release() when it is done.
+ *    - First Acquire (0 -> 1): the clock is switched ON.
+ *    - Last Release  (1 -> 0): the clock is switched OFF.
+ *    Two drivers sharing GPIOA can no longer switch it off under each other's feet.
+ *
+ * Refer to RM0390 - 6.3.10 / 6.3.13 / 6.3.14 (RCC_AHB1ENR, RCC_APB1ENR, RCC_APB2ENR)
+ */
+
+#ifndef SOURCES_STM32F446XX_PCLK_DRIVER_H_
+#define SOURCES_STM32F446XX_PCLK_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Bus Identifiers
+ * ==========================================
+ */
+#define PCLK_BUS_AHB1       0   // RCC_AHB1ENR, offset 0x30
+#define PCLK_BUS_APB1       1   // RCC_APB1ENR, offset 0x40
+#define PCLK_BUS_APB2       2   // RCC_APB2ENR, offset 0x44
+
+/*
+ * ==========================================
+ * 2. Peripheral IDs
+ * ==========================================
+ * @PCLK_IDS
+ * Index into the clock table. Groups that drivers compute by offset
+ * (GPIOA..GPIOH, TIM2..TIM7, TIM12..TIM14) MUST stay consecutive.
+ */
+/* AHB1 */
+#define PCLK_GPIOA          0
+#define PCLK_GPIOB          1
+#define PCLK_GPIOC          2
+#define PCLK_GPIOD          3
+#define PCLK_GPIOE          4
+#define PCLK_GPIOF          5
+#define PCLK_GPIOG          6
+#define PCLK_GPIOH          7
+#define PCLK_CRC            8
+#define PCLK_DMA1           9
+#define PCLK_DMA2           10
+/* APB1 */
+#define PCLK_TIM2           11
+#define PCLK_TIM3           12
+#define PCLK_TIM4           13
+#define PCLK_TIM5           14
+#define PCLK_TIM6           15
+#define PCLK_TIM7           16
+#define PCLK_TIM12          17
+#define PCLK_TIM13          18
+#define PCLK_TIM14          19
+#define PCLK_WWDG           20
+#define PCLK_SPI2           21
+#define PCLK_SPI3           22
+#define PCLK_USART2         23
+#define PCLK_USART3         24
+#define PCLK_UART4          25
+#define PCLK_UART5          26
+#define PCLK_I2C1           27
+#define PCLK_I2C2           28
+#define PCLK_I2C3           29
+#define PCLK_CAN1           30
+#define PCLK_CAN2           31
+#define PCLK_PWR            32
+#define PCLK_DAC            33
+/* APB2 */
+#define PCLK_TIM1           34
+#define PCLK_TIM8           35
+#define PCLK_USART1         36
+#define PCLK_USART6         37
+#define PCLK_ADC1           38
+#define PCLK_ADC2           39
+#define PCLK_ADC3           40
+#define PCLK_SDIO           41
+#define PCLK_SPI1           42
+#define PCLK_SPI4           43
+#define PCLK_SYSCFG         44
+#define PCLK_TIM9           45
+#define PCLK_TIM10          46
+#define PCLK_TIM11          47
+#define PCLK_SAI1           48
+#define PCLK_SAI2           49
+
+#define PCLK_COUNT          50  // number of entries in the table, keep last
+
+/*
+ * ==========================================
+ * 3. Table Entry
+ * ==========================================
+ * Two bytes per peripheral, stored in flash.
+ */
+typedef struct{
+	uint8_t Bus;   // Possible values: PCLK_BUS_AHB1 / APB1 / APB2
+	uint8_t Bit;   // bit position inside the bus enable register
+} PCLK_Entry_t;
+
+/*
+ * ==========================================
+ * 4. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Take / drop a reference on a peripheral clock.
+ * Invalid IDs are ignored. Release on a peripheral with no references is ignored too.
+ * Safe to call from interrupts (masked internally). A count that reaches 255
+ * saturates: that clock then stays on, Release no longer touches it.
+ */
+void PCLK_Acquire(uint8_t PclkId);
+void PCLK_Release(uint8_t PclkId);
+
+/*
+ * Current number of users (0 = clock is gated off by this manager).
+ */
+uint8_t PCLK_GetRefCount(uint8_t PclkId);
+
+#endif /* SOURCES_STM32F446XX_PCLK_DRIVER_H_ */
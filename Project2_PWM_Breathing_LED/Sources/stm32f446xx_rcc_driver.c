@@ -0,0 +1,388 @@
+/*
+ * stm32f446xx_rcc_driver.c
+ *
+ *  Created on: 2026/1/10
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_rcc_driver.h"
+#include "stm32f446xx_pclk_driver.h"
+#include <stdint.h>
+
+/*
+ * IMPORTANT: SystemInit() is called by Reset_Handler BEFORE .data is copied
+ * and .bss is zeroed (see startup_stm32f446retx.s).
+ * So nothing in this file may depend on a global/static variable.
+ * Lookup tables are 'const' -> they live in flash (.rodata) and are readable immediately.
+ */
+
+/*
+ * HPRE decoding (RCC_CFGR bits 7:4)
+ * Index = register value, content = right shift amount (divide by 2^n)
+ * 0xxx -> /1, 1000 -> /2, 1001 -> /4, ... 1100 -> /64 (note: /32 does not exist!)
+ */
+static const uint8_t AHBPrescShift[16] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 3, 4, 6, 7, 8, 9};
+
+/*
+ * PPRE1/PPRE2 decoding (RCC_CFGR bits 12:10 and 15:13)
+ * 0xx -> /1, 100 -> /2, 101 -> /4, 110 -> /8, 111 -> /16
+ */
+static const uint8_t APBPrescShift[8] = {0, 0, 0, 0, 1, 2, 3, 4};
+
+/*
+ * Helper: busy-wait until a status bit reaches the wanted level.
+ * The RCC/PWR ready flags are set by hardware a few microseconds after
+ * the corresponding enable bit, so these loops are short.
+ */
+static void RCC_WaitForFlag(volatile uint32_t *pReg, uint8_t Bit, uint8_t Level){
+	if (Level == SET){
+		while (!READ_BIT(*pReg, Bit));
+	}else{
+		while (READ_BIT(*pReg, Bit));
+	}
+}
+
+/*
+ * Helper: PLL output frequency from raw register fields.
+ * 64-bit math because (16 MHz * 432) would overflow 32 bits.
+ */
+static uint32_t RCC_CalcPLLOutput(uint32_t SourceFreq, uint32_t PLLM, uint32_t PLLN, uint32_t Div){
+	return (uint32_t)(((uint64_t)SourceFreq * PLLN) / (PLLM * Div));
+}
+
+void RCC_ClockConfig(const RCC_Config_t *pRCCConfig){
+	uint8_t use_pll = (pRCCConfig->RCC_SysClkSource == RCC_SYSCLK_SRC_PLLP);
+	uint32_t source_freq = (pRCCConfig->RCC_PLLSource == RCC_PLL_SRC_HSI) ? HSI_VALUE : HSE_VALUE;
+	uint32_t sysclk = HSI_VALUE;
+	if (use_pll){
+		sysclk = RCC_CalcPLLOutput(source_freq, pRCCConfig->RCC_PLLM, pRCCConfig->RCC_PLLN,
+		                           (pRCCConfig->RCC_PLLP + 1U) * 2U);
+	}
+	uint32_t hclk = sysclk >> AHBPrescShift[pRCCConfig->RCC_AHBPrescaler & 0xF];
+
+	/*
+	 * Flash wait states needed for the NEW HCLK
+	 * e.g. 180 MHz -> (180M - 1) / 30M = 5 wait states
+	 *      16 MHz  -> 0 wait states
+	 */
+	uint32_t new_latency = (hclk - 1U) / FLASH_HZ_PER_WAIT_STATE;
+	uint32_t old_latency = (FLASH->ACR >> FLASH_ACR_LATENCY) & 0xFU;
+
+	/*
+	 * Lowest regulator scale that still supports the NEW HCLK.
+	 * Lower core voltage = lower leakage and dynamic power.
+	 */
+	uint32_t vos = PWR_VOS_SCALE1;
+	if (hclk <= RCC_SCALE3_MAX_HCLK){
+		vos = PWR_VOS_SCALE3;
+	}else if (hclk <= RCC_SCALE2_MAX_HCLK){
+		vos = PWR_VOS_SCALE2;
+	}
+
+	/*
+	 * 1. Park SYSCLK on HSI
+	 * The PLL cannot be re-programmed while it is clocking the CPU.
+	 * HSI is always on after reset, so it is a safe place to stand.
+	 * (Flash latency is still the old, higher value here -> always safe.)
+	 */
+	SET_BIT(RCC->CR, RCC_CR_HSION);
+	RCC_WaitForFlag(&RCC->CR, RCC_CR_HSIRDY, SET);
+	RCC->CFGR &= ~(3U << RCC_CFGR_SW);
+	while (((RCC->CFGR >> RCC_CFGR_SWS) & 3U) != RCC_SYSCLK_HSI);
+
+	/*
+	 * 2. Over-Drive off (RM0390 - 5.1.4 Exiting Over-drive mode)
+	 * Only allowed while SYSCLK is HSI/HSE, which is exactly where we are now.
+	 * It is switched back on below if the new clock needs it.
+	 * PWR registers are dead without their clock: the caller provides it (see the header).
+	 */
+	if (READ_BIT(PWR->CR, PWR_CR_ODEN)){
+		PWR->CR &= ~((1U << PWR_CR_ODSWEN) | (1U << PWR_CR_ODEN));
+		RCC_WaitForFlag(&PWR->CSR, PWR_CSR_ODSWRDY, RESET);
+	}
+
+	/*
+	 * 3. Regulator Voltage Scale
+	 * VOS may only be changed while the PLL is OFF, so turn the PLL off first.
+	 */
+	CLEAR_BIT(RCC->CR, RCC_CR_PLLON);
+	RCC_WaitForFlag(&RCC->CR, RCC_CR_PLLRDY, RESET);
+	PWR->CR = (PWR->CR & ~(3U << PWR_CR_VOS)) | (vos << PWR_CR_VOS);
+
+	if (use_pll){
+		/*
+		 * 4. External oscillator (only if selected as PLL source)
+		 * HSEBYP must be written while HSE is still off.
+		 */
+		if (pRCCConfig->RCC_PLLSource != RCC_PLL_SRC_HSI){
+			if (pRCCConfig->RCC_PLLSource == RCC_PLL_SRC_HSE_BYP){
+				SET_BIT(RCC->CR, RCC_CR_HSEBYP);
+			}
+			SET_BIT(RCC->CR, RCC_CR_HSEON);
+			RCC_WaitForFlag(&RCC->CR, RCC_CR_HSERDY, SET);
+		}
+
+		/*
+		 * 5. Program and start the PLL
+		 * RCC_PLLCFGR layout:
+		 * bits 5:0   PLLM
+		 * bits 14:6  PLLN
+		 * bits 17:16 PLLP
+		 * bit  22    PLLSRC (0: HSI, 1: HSE)
+		 * bits 27:24 PLLQ
+		 * bits 30:28 PLLR (kept at its current value, we do not use it)
+		 */
+		uint32_t pllcfgr = RCC->PLLCFGR & (7U << 28);
+		pllcfgr |= ((uint32_t)pRCCConfig->RCC_PLLM & 0x3FU);
+		pllcfgr |= (((uint32_t)pRCCConfig->RCC_PLLN & 0x1FFU) << 6);
+		pllcfgr |= (((uint32_t)pRCCConfig->RCC_PLLP & 0x3U) << 16);
+		pllcfgr |= (((uint32_t)pRCCConfig->RCC_PLLQ & 0xFU) << 24);
+		if (pRCCConfig->RCC_PLLSource != RCC_PLL_SRC_HSI){
+			pllcfgr |= (1U << RCC_PLLCFGR_PLLSRC);
+		}
+		RCC->PLLCFGR = pllcfgr;
+
+		SET_BIT(RCC->CR, RCC_CR_PLLON);
+		RCC_WaitForFlag(&RCC->CR, RCC_CR_PLLRDY, SET);
+
+		/*
+		 * 6. Over-Drive (RM0390 - 5.1.4 Entering Over-drive mode)
+		 * Needed to reach 180 MHz. Must be done after the PLL is locked
+		 * but BEFORE SYSCLK is switched to it.
+		 * Sequence: ODEN -> wait ODRDY -> ODSWEN -> wait ODSWRDY
+		 */
+		if (hclk > RCC_OVERDRIVE_THRESHOLD){
+			SET_BIT(PWR->CR, PWR_CR_ODEN);
+			RCC_WaitForFlag(&PWR->CSR, PWR_CSR_ODRDY, SET);
+			SET_BIT(PWR->CR, PWR_CR_ODSWEN);
+			RCC_WaitForFlag(&PWR->CSR, PWR_CSR_ODSWRDY, SET);
+		}
+	}else{
+		/*
+		 * HSI only: nothing else needs the external oscillator, stop it (saves power).
+		 */
+		CLEAR_BIT(RCC->CR, RCC_CR_HSEON);
+	}
+
+	/*
+	 * 7. Flash wait states (going UP)
+	 * If the clock is getting faster, the flash must be slowed down FIRST.
+	 * Reading back ACR confirms the new latency is in effect (RM0390 - 3.4.1).
+	 */
+	if (new_latency > old_latency){
+		FLASH->ACR = (FLASH->ACR & ~(0xFU << FLASH_ACR_LATENCY)) | (new_latency << FLASH_ACR_LATENCY);
+		while (((FLASH->ACR >> FLASH_ACR_LATENCY) & 0xFU) != new_latency);
+	}
+
+	/*
+	 * 8. Bus prescalers
+	 * Set them before the switch so APB1 never sees more than 45 MHz.
+	 */
+	uint32_t cfgr = RCC->CFGR;
+	cfgr &= ~((0xFU << RCC_CFGR_HPRE) | (7U << RCC_CFGR_PPRE1) | (7U << RCC_CFGR_PPRE2));
+	cfgr |= (((uint32_t)pRCCConfig->RCC_AHBPrescaler & 0xFU) << RCC_CFGR_HPRE);
+	cfgr |= (((uint32_t)pRCCConfig->RCC_APB1Prescaler & 0x7U) << RCC_CFGR_PPRE1);
+	cfgr |= (((uint32_t)pRCCConfig->RCC_APB2Prescaler & 0x7U) << RCC_CFGR_PPRE2);
+	RCC->CFGR = cfgr;
+
+	/*
+	 * 9. Switch SYSCLK to the PLL and wait until the hardware confirms (SWS)
+	 * (In HSI mode we are already there.)
+	 */
+	if (use_pll){
+		RCC->CFGR = (RCC->CFGR & ~(3U << RCC_CFGR_SW)) | (RCC_SYSCLK_PLLP << RCC_CFGR_SW);
+		while (((RCC->CFGR >> RCC_CFGR_SWS) & 3U) != RCC_SYSCLK_PLLP);
+	}
+
+	/*
+	 * 10. Flash wait states (going DOWN)
+	 * If the clock got slower, the extra wait states can be removed now.
+	 */
+	if (new_latency < old_latency){
+		FLASH->ACR = (FLASH->ACR & ~(0xFU << FLASH_ACR_LATENCY)) | (new_latency << FLASH_ACR_LATENCY);
+	}
+}
+
+/*
+ * Clock change listeners (e.g. TIM_ClockChangeCallback)
+ * Lives in .bss, which is fine: only RCC_SetSystemClock() reads it, and that
+ * is never called before main().
+ */
+static RCC_ClockChangeCallback_t ClockChangeCallbacks[RCC_MAX_CLOCK_CALLBACKS];
+static uint8_t ClockChangeCallbackCount;
+
+uint8_t RCC_RegisterClockChangeCallback(RCC_ClockChangeCallback_t Callback){
+	for (uint8_t i = 0; i < ClockChangeCallbackCount; i++){
+		if (ClockChangeCallbacks[i] == Callback){
+			return ENABLE;
+		}
+	}
+	if (ClockChangeCallbackCount >= RCC_MAX_CLOCK_CALLBACKS){
+		return DISABLE;
+	}
+	ClockChangeCallbacks[ClockChangeCallbackCount++] = Callback;
+	return ENABLE;
+}
+
+void RCC_SetSystemClock(const RCC_Config_t *pRCCConfig){
+	RCC_ClockTree_t clock_tree;
+
+	// PWR clock only for the Over-Drive / VOS steps, through the clock manager
+	PCLK_Acquire(PCLK_PWR);
+	RCC_ClockConfig(pRCCConfig);
+	PCLK_Release(PCLK_PWR);
+
+	// Decode once, hand the same snapshot to everyone
+	RCC_GetClockTree(&clock_tree);
+	for (uint8_t i = 0; i < ClockChangeCallbackCount; i++){
+		ClockChangeCallbacks[i](&clock_tree);
+	}
+}
+
+void FLASH_ARTConfig(uint8_t Prefetch, uint8_t ICache, uint8_t DCache){
+	/*
+	 * 1. Turn both caches off first.
+	 * The reset bits (ICRST/DCRST) are only honoured while the cache is disabled,
+	 * and a cache must never be re-enabled with stale lines from a previous
+	 * latency/clock setting.
+	 */
+	FLASH->ACR &= ~((1U << FLASH_ACR_ICEN) | (1U << FLASH_ACR_DCEN));
+
+	// 2. Flush: pulse the reset bits (set, then clear)
+	FLASH->ACR |= ((1U << FLASH_ACR_ICRST) | (1U << FLASH_ACR_DCRST));
+	FLASH->ACR &= ~((1U << FLASH_ACR_ICRST) | (1U << FLASH_ACR_DCRST));
+
+	// 3. Apply the requested features, keeping LATENCY untouched
+	uint32_t acr = FLASH->ACR & ~(1U << FLASH_ACR_PRFTEN);
+	if (Prefetch == ENABLE){
+		acr |= (1U << FLASH_ACR_PRFTEN);
+	}
+	if (ICache == ENABLE){
+		acr |= (1U << FLASH_ACR_ICEN);
+	}
+	if (DCache == ENABLE){
+		acr |= (1U << FLASH_ACR_DCEN);
+	}
+	FLASH->ACR = acr;
+}
+
+/*
+ * SYSCLK
+ * Decoded from SWS (what the hardware is ACTUALLY using, not what we asked for).
+ */
+uint32_t RCC_GetSYSCLK(void){
+	uint32_t sws = (RCC->CFGR >> RCC_CFGR_SWS) & 3U;
+
+	if (sws == RCC_SYSCLK_HSI){
+		return HSI_VALUE;
+	}
+	if (sws == RCC_SYSCLK_HSE){
+		return HSE_VALUE;
+	}
+
+	uint32_t pllcfgr = RCC->PLLCFGR;
+	uint32_t source_freq = READ_BIT(pllcfgr, RCC_PLLCFGR_PLLSRC) ? HSE_VALUE : HSI_VALUE;
+	uint32_t pllm = pllcfgr & 0x3FU;
+	uint32_t plln = (pllcfgr >> 6) & 0x1FFU;
+	uint32_t div;
+
+	if (sws == RCC_SYSCLK_PLLP){
+		div = (((pllcfgr >> 16) & 3U) + 1U) * 2U; // 00 -> 2, 01 -> 4, 10 -> 6, 11 -> 8
+	}else{
+		div = (pllcfgr >> 28) & 7U;                // PLLR: value is the divider itself
+	}
+	return RCC_CalcPLLOutput(source_freq, pllm, plln, div);
+}
+
+uint32_t RCC_GetHCLK(void){
+	return RCC_GetSYSCLK() >> AHBPrescShift[(RCC->CFGR >> RCC_CFGR_HPRE) & 0xFU];
+}
+
+uint32_t RCC_GetPCLK1(void){
+	return RCC_GetHCLK() >> APBPrescShift[(RCC->CFGR >> RCC_CFGR_PPRE1) & 7U];
+}
+
+uint32_t RCC_GetPCLK2(void){
+	return RCC_GetHCLK() >> APBPrescShift[(RCC->CFGR >> RCC_CFGR_PPRE2) & 7U];
+}
+
+/*
+ * APB Timer Clocks
+ * APB prescaler == 1 -> timers get PCLKx
+ * APB prescaler  > 1 -> timers get 2 x PCLKx
+ */
+uint32_t RCC_GetTimerClock1(void){
+	uint32_t ppre1 = (RCC->CFGR >> RCC_CFGR_PPRE1) & 7U;
+	return (ppre1 < RCC_APB_DIV2) ? RCC_GetPCLK1() : (RCC_GetPCLK1() * 2U);
+}
+
+uint32_t RCC_GetTimerClock2(void){
+	uint32_t ppre2 = (RCC->CFGR >> RCC_CFGR_PPRE2) & 7U;
+	return (ppre2 < RCC_APB_DIV2) ? RCC_GetPCLK2() : (RCC_GetPCLK2() * 2U);
+}
+
+void RCC_GetClockTree(RCC_ClockTree_t *pClockTree){
+	pClockTree->SYSCLK  = RCC_GetSYSCLK();
+	pClockTree->HCLK    = RCC_GetHCLK();
+	pClockTree->PCLK1   = RCC_GetPCLK1();
+	pClockTree->PCLK2   = RCC_GetPCLK2();
+	pClockTree->TIMCLK1 = RCC_GetTimerClock1();
+	pClockTree->TIMCLK2 = RCC_GetTimerClock2();
+}
+
+/*
+ * ==========================================
+ * SystemInit: 180 MHz from HSI
+ * ==========================================
+ * HSI is used as PLL source because it needs no board-level solder bridges.
+ * Flash latency is derived from HCLK inside RCC_ClockConfig (5 wait states at 180 MHz),
+ * prefetch and both ART caches are switched on here.
+ * The numbers come from the Boot Clock Plan in stm32f446xx_rcc_driver.h:
+ *
+ * HCLK  = 180 MHz (AHB  /1)
+ * PCLK1 = 45 MHz  (APB1 /4) -> TIM2 clock = 90 MHz
+ * PCLK2 = 90 MHz  (APB2 /2) -> TIM1/TIM8 clock = 180 MHz
+ */
+_Static_assert(SYSINIT_HCLK_HZ <= 180000000U, "HCLK above 180 MHz");
+_Static_assert(SYSINIT_PCLK1_HZ <= 45000000U, "PCLK1 above 45 MHz");
+_Static_assert(SYSINIT_PCLK2_HZ <= 90000000U, "PCLK2 above 90 MHz");
+
+const RCC_Config_t RCC_Config_180MHz = {
+	.RCC_SysClkSource  = RCC_SYSCLK_SRC_PLLP,
+	.RCC_PLLSource     = RCC_PLL_SRC_HSI,
+	.RCC_PLLM          = SYSINIT_PLLM,
+	.RCC_PLLN          = SYSINIT_PLLN,
+	.RCC_PLLP          = RCC_PLLP_DIV(SYSINIT_PLLP),
+	.RCC_PLLQ          = SYSINIT_PLLQ,
+	.RCC_AHBPrescaler  = RCC_AHB_DIV(SYSINIT_AHB_DIV),
+	.RCC_APB1Prescaler = RCC_APB_DIV(SYSINIT_APB1_DIV),
+	.RCC_APB2Prescaler = RCC_APB_DIV(SYSINIT_APB2_DIV),
+};
+
+/*
+ * Low-power profile: 16 MHz HSI, PLL and Over-Drive off, regulator Scale 3, 0 wait states.
+ * All buses at /1 so every timer clock is exactly 16 MHz.
+ */
+const RCC_Config_t RCC_Config_16MHz = {
+	.RCC_SysClkSource  = RCC_SYSCLK_SRC_HSI,
+	.RCC_PLLSource     = RCC_PLL_SRC_HSI,
+	.RCC_AHBPrescaler  = RCC_AHB_DIV1,
+	.RCC_APB1Prescaler = RCC_APB_DIV1,
+	.RCC_APB2Prescaler = RCC_APB_DIV1,
+};
+
+void SystemInit(void){
+	/*
+	 * ART accelerator on BEFORE the clock goes up: once we run at 180 MHz with
+	 * 5 wait states, every uncached fetch costs 6 cycles instead of 1.
+	 */
+	FLASH_ARTConfig(ENABLE, ENABLE, ENABLE);
+
+	/*
+	 * PWR clock for RCC_ClockConfig. PCLK_Acquire cannot be used here: its reference
+	 * counts live in .bss, which holds garbage until Reset_Handler zeroes it.
+	 * The bit is simply left on; PCLK_GetRefCount(PCLK_PWR) starts at 0 in main().
+	 */
+	SET_BIT(RCC->APB1ENR, RCC_APB1ENR_PWREN);
+	RCC_ClockConfig(&RCC_Config_180MHz);
+}
@@ -0,0 +1,312 @@
+/*
+ * stm32f446xx_rcc_driver.h
+ *
+ * Created on: 2026/1/10
+ * Author: Yuheng
+ *
+ * Description:
+ * Header file for RCC (Reset and Clock Control) Clock-Tree Driver.
+ *
+ * Why a Clock Driver?
+ * Out of reset the STM32F446RE runs from the 16 MHz HSI oscillator, and the
+ * weak SystemInit() in the startup file does nothing about it.
+ * The Cortex-M4 core is rated for 180 MHz, so we are leaving ~11x of CPU headroom unused.
+ *
+ * This driver:
+ * 1. Configures the main PLL (from HSI or HSE), voltage scaling, Over-Drive,
+ *    flash wait states and the AHB/APB prescalers.
+ * 2. Switches SYSCLK over to the PLL.
+ * 3. Exposes a queryable clock tree (SYSCLK, HCLK, PCLK1/2 and the APB timer clocks),
+ *    so other drivers can compute their dividers instead of assuming 16 MHz.
+ *
+ * Refer to RM0390 - 6.2 Clocks (Figure 13. Clock tree)
+ */
+
+#ifndef SOURCES_STM32F446XX_RCC_DRIVER_H_
+#define SOURCES_STM32F446XX_RCC_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Oscillator Frequencies
+ * ==========================================
+ * HSI is fixed inside the chip.
+ * HSE depends on the board: on the Nucleo-F446RE the ST-LINK feeds an 8 MHz
+ * clock into PH0 (MCO, bypass mode), so 8 MHz is the default here.
+ */
+#define HSI_VALUE               16000000U
+#ifndef HSE_VALUE
+#define HSE_VALUE               8000000U
+#endif
+
+/*
+ * ==========================================
+ * 2. Boot Clock Plan (used by SystemInit)
+ * ==========================================
+ * Kept as plain numbers (dividers, not register encodings) so the resulting
+ * frequencies are known at COMPILE time.
+ * Other drivers can then size their dividers with no runtime math,
+ * e.g. the PSC/ARR solver in stm32f446xx_timer_driver.h.
+ *
+ * 16 MHz / PLLM(8)  = 2 MHz    (VCO input)
+ * 2 MHz  * PLLN(180) = 360 MHz (VCO output)
+ * 360 MHz / PLLP(2) = 180 MHz  (SYSCLK)
+ */
+#define SYSINIT_PLLM            8U
+#define SYSINIT_PLLN            180U
+#define SYSINIT_PLLP            2U
+#define SYSINIT_PLLQ            8U
+#define SYSINIT_AHB_DIV         1U
+#define SYSINIT_APB1_DIV        4U
+#define SYSINIT_APB2_DIV        2U
+
+#define SYSINIT_SYSCLK_HZ       ((HSI_VALUE / SYSINIT_PLLM) * SYSINIT_PLLN / SYSINIT_PLLP)  // 180 MHz
+#define SYSINIT_HCLK_HZ         (SYSINIT_SYSCLK_HZ / SYSINIT_AHB_DIV)                         // 180 MHz
+#define SYSINIT_PCLK1_HZ        (SYSINIT_HCLK_HZ / SYSINIT_APB1_DIV)                          // 45 MHz
+#define SYSINIT_PCLK2_HZ        (SYSINIT_HCLK_HZ / SYSINIT_APB2_DIV)                          // 90 MHz
+#define SYSINIT_TIMCLK1_HZ      ((SYSINIT_APB1_DIV == 1U) ? SYSINIT_PCLK1_HZ : (2U * SYSINIT_PCLK1_HZ)) // 90 MHz
+#define SYSINIT_TIMCLK2_HZ      ((SYSINIT_APB2_DIV == 1U) ? SYSINIT_PCLK2_HZ : (2U * SYSINIT_PCLK2_HZ)) // 180 MHz
+
+/*
+ * ==========================================
+ * 3. Configuration Structures
+ * ==========================================
+ */
+
+/*
+ * RCC Configuration Structure
+ * The "Menu" for the clock tree.
+ *
+ * PLL Formula (RM0390 - 6.3.2 RCC_PLLCFGR):
+ * f(VCO input)  = f(PLL source) / PLLM      -> must be 1-2 MHz (2 MHz recommended, less jitter)
+ * f(VCO output) = f(VCO input) * PLLN       -> must be 100-432 MHz
+ * f(SYSCLK)     = f(VCO output) / PLLP      -> must be <= 180 MHz
+ * f(48 MHz clk) = f(VCO output) / PLLQ      -> USB/SDIO, not used yet
+ *
+ * Bus Prescalers:
+ * HCLK  (AHB)  = SYSCLK / AHB prescaler     -> <= 180 MHz
+ * PCLK1 (APB1) = HCLK / APB1 prescaler      -> <= 45 MHz  (TIM2 lives here)
+ * PCLK2 (APB2) = HCLK / APB2 prescaler      -> <= 90 MHz
+ */
+typedef struct{
+	uint8_t  RCC_SysClkSource;   // Possible values: @RCC_SYSCLK_SOURCE
+	uint8_t  RCC_PLLSource;      // Possible values: @RCC_PLL_SOURCE (PLL fields ignored if SYSCLK = HSI)
+	uint8_t  RCC_PLLM;           // Possible values: 2-63
+	uint16_t RCC_PLLN;           // Possible values: 50-432
+	uint8_t  RCC_PLLP;           // Possible values: @RCC_PLLP_DIV
+	uint8_t  RCC_PLLQ;           // Possible values: 2-15
+	uint8_t  RCC_AHBPrescaler;   // Possible values: @RCC_AHB_PRESCALER
+	uint8_t  RCC_APB1Prescaler;  // Possible values: @RCC_APB_PRESCALER
+	uint8_t  RCC_APB2Prescaler;  // Possible values: @RCC_APB_PRESCALER
+} RCC_Config_t;
+
+/*
+ * Clock Tree Snapshot
+ * Every value is in Hz.
+ *
+ * Why separate Timer clocks?
+ * If an APB prescaler is 1, the timers on that bus run at PCLKx.
+ * Otherwise the hardware DOUBLES it for the timers (RM0390 - 6.2, TIMPRE = 0).
+ * e.g. PCLK1 = 45 MHz (APB1 /4) -> TIM2 is clocked at 90 MHz, NOT 45 MHz.
+ */
+typedef struct{
+	uint32_t SYSCLK;
+	uint32_t HCLK;
+	uint32_t PCLK1;
+	uint32_t PCLK2;
+	uint32_t TIMCLK1;  // APB1 timers: TIM2-7, TIM12-14
+	uint32_t TIMCLK2;  // APB2 timers: TIM1, TIM8-11
+} RCC_ClockTree_t;
+
+/*
+ * Clock Change Callback
+ * Drivers that derive dividers from the clock tree (e.g. the timer driver's PSC)
+ * register one of these. It is called AFTER every RCC_SetSystemClock() switch
+ * with the new tree, so the driver can re-tune itself.
+ */
+typedef void (*RCC_ClockChangeCallback_t)(const RCC_ClockTree_t *pClockTree);
+#define RCC_MAX_CLOCK_CALLBACKS 8
+
+/*
+ * ==========================================
+ * 4. Configuration Macros
+ * ==========================================
+ * These are the raw register encodings, so the driver can write them directly.
+ */
+/* @RCC_SYSCLK_SOURCE (RCC_CFGR bits 1:0 SW) */
+#define RCC_SYSCLK_SRC_HSI      0   // 16 MHz straight from HSI, PLL switched off (lowest power)
+#define RCC_SYSCLK_SRC_PLLP     2   // main PLL, P output
+
+/* @RCC_PLL_SOURCE (RCC_PLLCFGR bit 22 PLLSRC) */
+#define RCC_PLL_SRC_HSI         0
+#define RCC_PLL_SRC_HSE         1   // HSE crystal
+#define RCC_PLL_SRC_HSE_BYP     2   // HSE bypass (external clock on OSC_IN, e.g. ST-LINK MCO)
+
+/* @RCC_PLLP_DIV (RCC_PLLCFGR bits 17:16 PLLP) */
+#define RCC_PLLP_DIV2           0
+#define RCC_PLLP_DIV4           1
+#define RCC_PLLP_DIV6           2
+#define RCC_PLLP_DIV8           3
+
+/* @RCC_AHB_PRESCALER (RCC_CFGR bits 7:4 HPRE) */
+#define RCC_AHB_DIV1            0
+#define RCC_AHB_DIV2            8
+#define RCC_AHB_DIV4            9
+#define RCC_AHB_DIV8            10
+#define RCC_AHB_DIV16           11
+#define RCC_AHB_DIV64           12
+#define RCC_AHB_DIV128          13
+#define RCC_AHB_DIV256          14
+#define RCC_AHB_DIV512          15
+
+/* @RCC_APB_PRESCALER (RCC_CFGR bits 12:10 PPRE1 and 15:13 PPRE2) */
+#define RCC_APB_DIV1            0
+#define RCC_APB_DIV2            4
+#define RCC_APB_DIV4            5
+#define RCC_APB_DIV8            6
+#define RCC_APB_DIV16           7
+
+/*
+ * Divider value -> register encoding
+ * e.g. RCC_APB_DIV(4) -> RCC_APB_DIV4 (5)
+ * Only valid dividers should be passed; anything else falls through to the largest one.
+ */
+#define RCC_PLLP_DIV(DIV)       (((DIV) / 2U) - 1U)
+#define RCC_AHB_DIV(DIV)        ((DIV) == 1U   ? RCC_AHB_DIV1   : (DIV) == 2U   ? RCC_AHB_DIV2   : \
+                                 (DIV) == 4U   ? RCC_AHB_DIV4   : (DIV) == 8U   ? RCC_AHB_DIV8   : \
+                                 (DIV) == 16U  ? RCC_AHB_DIV16  : (DIV) == 64U  ? RCC_AHB_DIV64  : \
+                                 (DIV) == 128U ? RCC_AHB_DIV128 : (DIV) == 256U ? RCC_AHB_DIV256 : RCC_AHB_DIV512)
+#define RCC_APB_DIV(DIV)        ((DIV) == 1U ? RCC_APB_DIV1 : (DIV) == 2U ? RCC_APB_DIV2 : \
+                                 (DIV) == 4U ? RCC_APB_DIV4 : (DIV) == 8U ? RCC_APB_DIV8 : RCC_APB_DIV16)
+
+/*
+ * Register Bit Positions
+ * Used in several places by the driver, so they get names instead of magic numbers.
+ */
+#define RCC_CR_HSION            0
+#define RCC_CR_HSIRDY           1
+#define RCC_CR_HSEON            16
+#define RCC_CR_HSERDY           17
+#define RCC_CR_HSEBYP           18
+#define RCC_CR_PLLON            24
+#define RCC_CR_PLLRDY           25
+
+#define RCC_PLLCFGR_PLLSRC      22
+
+#define RCC_CFGR_SW             0   // bits 1:0 system clock switch
+#define RCC_CFGR_SWS            2   // bits 3:2 system clock switch status
+#define RCC_CFGR_HPRE           4
+#define RCC_CFGR_PPRE1          10
+#define RCC_CFGR_PPRE2          13
+
+#define RCC_SYSCLK_HSI          0   // SW/SWS encoding
+#define RCC_SYSCLK_HSE          1
+#define RCC_SYSCLK_PLLP         2
+#define RCC_SYSCLK_PLLR         3
+
+#define RCC_APB1ENR_PWREN       28
+
+#define PWR_CR_VOS              14  // bits 15:14 regulator voltage scaling
+#define PWR_CR_ODEN             16
+#define PWR_CR_ODSWEN           17
+#define PWR_CSR_ODRDY           16
+#define PWR_CSR_ODSWRDY         17
+
+#define FLASH_ACR_LATENCY       0   // bits 3:0 wait states
+#define FLASH_ACR_PRFTEN        8   // prefetch enable
+#define FLASH_ACR_ICEN          9   // instruction cache enable
+#define FLASH_ACR_DCEN          10  // data cache enable
+#define FLASH_ACR_ICRST         11  // instruction cache reset (only while ICEN = 0)
+#define FLASH_ACR_DCRST         12  // data cache reset (only while DCEN = 0)
+
+/*
+ * Flash wait states vs HCLK (RM0390 - Table 5, VDD 2.7 V - 3.6 V)
+ * Every additional wait state buys 30 MHz of HCLK.
+ */
+#define FLASH_HZ_PER_WAIT_STATE 30000000U
+
+/*
+ * Regulator limits (RM0390 - 5.1.4 and Table 15)
+ * Scale 3: HCLK <= 120 MHz  (lowest core voltage, lowest power)
+ * Scale 2: HCLK <= 144 MHz
+ * Scale 1: HCLK <= 168 MHz, up to 180 MHz with Over-Drive
+ */
+#define RCC_OVERDRIVE_THRESHOLD 168000000U
+#define RCC_SCALE3_MAX_HCLK     120000000U
+#define RCC_SCALE2_MAX_HCLK     144000000U
+#define PWR_VOS_SCALE3          1U
+#define PWR_VOS_SCALE2          2U
+#define PWR_VOS_SCALE1          3U
+
+/*
+ * ==========================================
+ * 5. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Clock Configuration
+ * Brings the whole tree up in the order required by the Reference Manual:
+ * regulator -> PLL -> Over-Drive -> flash wait states -> prescalers -> SYSCLK switch.
+ * Does NOT notify anyone (it also runs from SystemInit, before .bss exists).
+ * The PWR clock (RCC_APB1ENR PWREN) must already be on: RCC_SetSystemClock takes it
+ * through PCLK_Acquire, SystemInit sets the bit directly.
+ */
+void RCC_ClockConfig(const RCC_Config_t *pRCCConfig);
+
+/*
+ * Runtime Frequency Scaling
+ * Same as RCC_ClockConfig, then calls every registered callback with the new tree.
+ * Use this from application code, e.g.
+ *   RCC_SetSystemClock(&RCC_Config_16MHz);   // idle: PLL off, regulator Scale 3
+ *   RCC_SetSystemClock(&RCC_Config_180MHz);  // heavy work pending: full speed
+ */
+void RCC_SetSystemClock(const RCC_Config_t *pRCCConfig);
+
+/*
+ * Register a driver to be told about clock switches.
+ * Returns ENABLE on success, DISABLE if the table (RCC_MAX_CLOCK_CALLBACKS) is full.
+ * Registering the same callback twice is harmless (it is only stored once).
+ */
+uint8_t RCC_RegisterClockChangeCallback(RCC_ClockChangeCallback_t Callback);
+
+/*
+ * Ready-made configurations (stored in flash)
+ * RCC_Config_180MHz: the SystemInit plan (PLL from HSI, Over-Drive)
+ * RCC_Config_16MHz:  HSI only, all buses /1, PLL off -> TIM2 clock = 16 MHz
+ */
+extern const RCC_Config_t RCC_Config_180MHz;
+extern const RCC_Config_t RCC_Config_16MHz;
+
+/*
+ * Flash ART Accelerator (RM0390 - 3.4.2 Adaptive real-time memory accelerator)
+ * With 5 wait states at 180 MHz, every flash fetch would stall the core for 5 cycles.
+ * - Prefetch: reads the next 128-bit line while the current one executes (sequential code).
+ * - I-Cache:  64 lines of 128 bits, catches loops and branches back (our ISRs and drivers).
+ * - D-Cache:  8 lines of 128 bits, for literal pools / const tables in flash.
+ * Each argument is ENABLE or DISABLE. Caches are flushed whenever they are (re-)enabled.
+ */
+void FLASH_ARTConfig(uint8_t Prefetch, uint8_t ICache, uint8_t DCache);
+
+/*
+ * Clock Tree Queries
+ * These decode the live RCC registers, so they are always correct even if
+ * someone else (a debugger, a later re-configuration) touched the clocks.
+ */
+uint32_t RCC_GetSYSCLK(void);
+uint32_t RCC_GetHCLK(void);
+uint32_t RCC_GetPCLK1(void);
+uint32_t RCC_GetPCLK2(void);
+uint32_t RCC_GetTimerClock1(void);
+uint32_t RCC_GetTimerClock2(void);
+void RCC_GetClockTree(RCC_ClockTree_t *pClockTree);
+
+/*
+ * Called by Reset_Handler (startup_stm32f446retx.s) before main().
+ * Overrides the weak, empty SystemInit in the startup file.
+ */
+void SystemInit(void);
+
+#endif /* SOURCES_STM32F446XX_RCC_DRIVER_H_ */
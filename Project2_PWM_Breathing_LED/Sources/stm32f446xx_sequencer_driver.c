@@ -0,0 +1,168 @@
+/*
+ * stm32f446xx_sequencer_driver.c
+ *
+ *  Created on: 2026/1/21
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_sequencer_driver.h"
+#include "stm32f446xx_timer_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Running or paused sequencer of each channel (CH1 = [0]), NULL = none.
+ */
+static SEQ_t *volatile Active[TIM_CHANNELS];
+
+/*
+ * Nestable interrupt masking: Active[] and the sequencer objects are shared
+ * between main, callbacks and the tick (TIM2 IRQ).
+ */
+static uint32_t SEQ_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void SEQ_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/*
+ * Take a sequencer out of whatever slot it is in (interrupts masked).
+ * Looks at every slot: the channel in its config may have changed since it was started.
+ */
+static void SEQ_Detach(SEQ_t *pSeq){
+	for (uint8_t i = 0; i < TIM_CHANNELS; i++){
+		if (Active[i] == pSeq){
+			Active[i] = NULL;
+		}
+	}
+	pSeq->State = SEQ_STATE_IDLE;
+}
+
+/*
+ * Tick: TIM2 update interrupt (once per PWM period)
+ * The common case, a keyframe that is still being held, is a load, a decrement and a store.
+ */
+static void SEQ_Tick(TIM_RegDef_t *pTIMx){
+	(void)pTIMx;
+
+	for (uint8_t ch = 0; ch < TIM_CHANNELS; ch++){
+		SEQ_t *pSeq = Active[ch];
+
+		if (pSeq == NULL || pSeq->State != SEQ_STATE_RUNNING){
+			continue;
+		}
+
+		uint16_t countdown = (uint16_t)(pSeq->Countdown - 1U);
+		pSeq->Countdown = countdown;
+		if (countdown != 0){
+			continue;
+		}
+
+		// Keyframe over: next one, or the end of the sequence
+		const SEQ_Config_t *pConfig = &pSeq->SEQ_Config;
+		uint16_t index = (uint16_t)(pSeq->Index + 1U);
+		uint8_t wrapped = 0;
+
+		if (index >= pConfig->Length){
+			if (pConfig->Loop != ENABLE){
+				// One-shot: the last keyframe stays in CCRx
+				Active[ch] = NULL;
+				pSeq->State = SEQ_STATE_IDLE;
+				if (pConfig->CompleteCallback != NULL){
+					pConfig->CompleteCallback(pSeq);
+				}
+				continue;
+			}
+			index = 0;
+			wrapped = 1;
+		}
+
+		pSeq->Index = index;
+		pSeq->Countdown = pConfig->UpdatesPerFrame;
+		*pSeq->pCCR = pConfig->pFrames[index]; // preloaded: active from the next update event
+
+		if (wrapped && pConfig->CompleteCallback != NULL){
+			pConfig->CompleteCallback(pSeq);
+		}
+	}
+}
+
+uint8_t SEQ_Init(void){
+	return TIM_RegisterUpdateCallback(SEQ_TIM, SEQ_Tick);
+}
+
+uint8_t SEQ_Start(SEQ_t *pSeq){
+	const SEQ_Config_t *pConfig = &pSeq->SEQ_Config;
+
+	if (pConfig->pFrames == NULL || pConfig->Length == 0 || pConfig->UpdatesPerFrame == 0 ||
+		pConfig->Channel < 1 || pConfig->Channel > TIM_CHANNELS){
+		return DISABLE;
+	}
+	uint8_t slot = (uint8_t)(pConfig->Channel - 1U);
+	uint32_t primask = SEQ_EnterCritical();
+
+	SEQ_Detach(pSeq);
+	if (Active[slot] != NULL){
+		Active[slot]->State = SEQ_STATE_IDLE; // someone else's sequence on this channel
+	}
+
+	// CCR1-CCR4 are consecutive registers
+	pSeq->pCCR = &SEQ_TIM->CCR1 + slot;
+	pSeq->Index = 0;
+	pSeq->Countdown = pConfig->UpdatesPerFrame;
+	*pSeq->pCCR = pConfig->pFrames[0];
+	pSeq->State = SEQ_STATE_RUNNING;
+	Active[slot] = pSeq;
+
+	SEQ_ExitCritical(primask);
+	return ENABLE;
+}
+
+void SEQ_Stop(SEQ_t *pSeq){
+	uint32_t primask = SEQ_EnterCritical();
+	SEQ_Detach(pSeq);
+	SEQ_ExitCritical(primask);
+}
+
+/*
+ * Check-then-set on State: the tick may end a one-shot sequence (DONE) in between,
+ * and a Pause stored after that would turn DONE back into PAUSED.
+ */
+void SEQ_Pause(SEQ_t *pSeq){
+	uint32_t primask = SEQ_EnterCritical();
+	if (pSeq->State == SEQ_STATE_RUNNING){
+		pSeq->State = SEQ_STATE_PAUSED;
+	}
+	SEQ_ExitCritical(primask);
+}
+
+void SEQ_Resume(SEQ_t *pSeq){
+	uint32_t primask = SEQ_EnterCritical();
+	if (pSeq->State == SEQ_STATE_PAUSED){
+		pSeq->State = SEQ_STATE_RUNNING;
+	}
+	SEQ_ExitCritical(primask);
+}
+
+void SEQ_SetSpeed(SEQ_t *pSeq, uint16_t UpdatesPerFrame){
+	if (UpdatesPerFrame == 0){
+		return;
+	}
+	uint32_t primask = SEQ_EnterCritical();
+
+	pSeq->SEQ_Config.UpdatesPerFrame = UpdatesPerFrame;
+	if (pSeq->Countdown > UpdatesPerFrame){
+		pSeq->Countdown = UpdatesPerFrame;
+	}
+
+	SEQ_ExitCritical(primask);
+}
+
+uint8_t SEQ_GetState(const SEQ_t *pSeq){
+	return pSeq->State;
+}
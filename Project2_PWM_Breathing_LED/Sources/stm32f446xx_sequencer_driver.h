@@ -0,0 +1,134 @@
+/*
+ * stm32f446xx_sequencer_driver.h
+ *
+ *  Created on: 2026/1/21
+ *      Author: Yuheng
+ *
+ * Description:
+ * Interrupt-driven duty sequencer: plays a list of CCR keyframes on a TIM2 channel,
+ * one keyframe every N update events.
+ *
+ * Why?
+ * The original fade was a for loop calling TIM_SetCompare1 with a delay between steps:
+ * the CPU was stuck in that loop for the whole animation. DMA playback (timer driver,
+ * Section 8) frees the CPU completely, but it cannot be paused, slowed down or told
+ * to call back at the end without stopping and reprogramming the stream.
+ * The sequencer sits in between: the TIM2 update interrupt advances the animation,
+ * the main loop is free, and the animation can be controlled while it runs.
+ *
+ * How it works:
+ *   update event:  |  |  |  |  |  |  |  |  |   (every PWM period, 1 ms at 1 kHz)
+ *   Countdown:     3  2  1  3  2  1  3  2  1   (UpdatesPerFrame = 3)
+ *   CCRx:          f[0]     f[1]     f[2]      (written when Countdown reaches 0)
+ * With preload enabled on the channel, a new value takes effect at the NEXT update
+ * event: no glitch, the PWM period in progress is finished with the old duty.
+ *
+ * ISR cost:
+ * One sequencer per channel, looked up by channel number (no search). For a channel
+ * in the middle of a keyframe, the update interrupt only decrements its countdown.
+ * On a keyframe boundary it does one table load and one store to the CCR register,
+ * whose address was worked out in SEQ_Start.
+ *
+ * Ticks on: SEQ_TIM (TIM2), through TIM_RegisterUpdateCallback, next to the software timers.
+ * Do not run the sequencer and DMA waveform playback (TIM_Waveform_Start) on the same channel.
+ */
+
+#ifndef SOURCES_STM32F446XX_SEQUENCER_DRIVER_H_
+#define SOURCES_STM32F446XX_SEQUENCER_DRIVER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f446xx.h"
+#include "stm32f446xx_timer_driver.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#define SEQ_TIM                 TIM2
+#define SEQ_MAX_UPDATES         0xFFFFU     // longest hold of one keyframe
+
+/*
+ * @SEQ_STATES
+ */
+#define SEQ_STATE_IDLE          0   // stopped, or played to the end
+#define SEQ_STATE_RUNNING       1
+#define SEQ_STATE_PAUSED        2   // CCRx holds the current keyframe
+
+/*
+ * ==========================================
+ * 2. Sequencer Object
+ * ==========================================
+ * Owned by the user (static or global, like SWTIMER_t): the update interrupt keeps
+ * a pointer to it while it runs.
+ */
+struct SEQ_Sequencer;
+
+/*
+ * Called from the TIM2 update interrupt: keep it short.
+ * Looping sequences call it at the end of every pass, one-shot sequences once,
+ * after the last keyframe has been held for its full time (the sequencer is already idle).
+ */
+typedef void (*SEQ_Callback_t)(struct SEQ_Sequencer *pSeq);
+
+typedef struct{
+	const uint32_t *pFrames;        // CCR values, may live in flash
+	uint16_t Length;                // number of keyframes
+	uint8_t Channel;                // 1-4
+	uint16_t UpdatesPerFrame;       // 1-SEQ_MAX_UPDATES, update events per keyframe (the speed)
+	uint8_t Loop;                   // ENABLE: start over after the last keyframe, DISABLE: play once
+	SEQ_Callback_t CompleteCallback;// optional (NULL)
+} SEQ_Config_t;
+
+typedef struct SEQ_Sequencer{
+	SEQ_Config_t SEQ_Config;
+	volatile uint32_t *pCCR;        // &SEQ_TIM->CCRx, set by SEQ_Start
+	volatile uint16_t Index;        // keyframe currently in CCRx
+	volatile uint16_t Countdown;    // update events left on this keyframe
+	volatile uint8_t State;         // Possible values: @SEQ_STATES
+} SEQ_t;
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ * May be called from main, from a callback, or from an interrupt.
+ */
+
+/*
+ * Hook the sequencers to the TIM2 update event.
+ * TIM2 must already be running (TIM_PWM_Init, channel preload enabled).
+ * Returns DISABLE if the hook cannot be registered: no sequence would ever advance.
+ */
+uint8_t SEQ_Init(void);
+
+/*
+ * (Re)start from the first keyframe, written to CCRx right away.
+ * A sequencer already running on the same channel is stopped (its callback is not called).
+ * Returns DISABLE (and does nothing) if the configuration is not usable:
+ * no frames, Channel out of 1-4, or UpdatesPerFrame = 0.
+ */
+uint8_t SEQ_Start(SEQ_t *pSeq);
+
+/*
+ * Stop without calling the callback. CCRx keeps the current keyframe.
+ */
+void SEQ_Stop(SEQ_t *pSeq);
+
+/*
+ * Freeze on the current keyframe / go on from where it was paused
+ * (the rest of the keyframe's time is kept).
+ */
+void SEQ_Pause(SEQ_t *pSeq);
+void SEQ_Resume(SEQ_t *pSeq);
+
+/*
+ * Change the speed while running: update events per keyframe (0 is ignored).
+ * The current keyframe is cut short if it has already been held for longer than that.
+ */
+void SEQ_SetSpeed(SEQ_t *pSeq, uint16_t UpdatesPerFrame);
+
+uint8_t SEQ_GetState(const SEQ_t *pSeq);
+
+#endif /* SOURCES_STM32F446XX_SEQUENCER_DRIVER_H_ */
@@ -0,0 +1,241 @@
+/*
+ * stm32f446xx_swtimer_driver.c
+ *
+ *  Created on: 2026/1/18
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_swtimer_driver.h"
+#include "stm32f446xx_timer_driver.h"
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * The wheel: one list head per slot, 4 x 64 x 4 bytes = 1 KB of RAM.
+ */
+static SWTIMER_t *Wheel[SWTIMER_LEVELS][SWTIMER_LEVEL_SIZE];
+
+/*
+ * Expired timers waiting for PendSV to call their callback.
+ */
+static SWTIMER_t *PendingHead;
+
+/*
+ * Next tick the wheel will process.
+ * A timer with Expires == CurrentTick fires on the next TIM2 update event.
+ */
+static volatile uint32_t CurrentTick;
+
+/*
+ * Nestable interrupt masking: the lists are shared between main, callbacks (PendSV)
+ * and the tick (TIM2 IRQ).
+ */
+static uint32_t SWTIMER_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void SWTIMER_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/*
+ * List helpers
+ * ppPrev points at whatever points at this node (the slot head or the previous
+ * node's pNext), so unlinking never has to walk the list.
+ */
+static void SWTIMER_Link(SWTIMER_t **ppHead, SWTIMER_t *pTimer){
+	pTimer->pNext = *ppHead;
+	if (pTimer->pNext != NULL){
+		pTimer->pNext->ppPrev = &pTimer->pNext;
+	}
+	*ppHead = pTimer;
+	pTimer->ppPrev = ppHead;
+}
+
+static void SWTIMER_Unlink(SWTIMER_t *pTimer){
+	*pTimer->ppPrev = pTimer->pNext;
+	if (pTimer->pNext != NULL){
+		pTimer->pNext->ppPrev = pTimer->ppPrev;
+	}
+	pTimer->pNext = NULL;
+	pTimer->ppPrev = NULL;
+}
+
+/*
+ * Put a timer into the slot of its expiry tick, at the coarsest level it needs.
+ * Level L covers timers due within 64^(L+1) ticks; the slot index is the L-th
+ * 6-bit digit of the expiry tick (like reading the hour hand of a clock).
+ */
+static void SWTIMER_AddToWheel(SWTIMER_t *pTimer){
+	uint32_t delta = pTimer->Expires - CurrentTick;
+	SWTIMER_t **ppSlot;
+
+	if ((int32_t)delta < 0){
+		// Already late (e.g. a periodic callback that ran too long): fire on the next tick
+		ppSlot = &Wheel[0][CurrentTick & SWTIMER_LEVEL_MASK];
+	}else{
+		if (delta > SWTIMER_MAX_TIMEOUT){
+			pTimer->Expires = CurrentTick + SWTIMER_MAX_TIMEOUT;
+		}
+
+		uint8_t level = 0;
+		while (level < (SWTIMER_LEVELS - 1) && delta >= (1UL << (SWTIMER_LEVEL_BITS * (level + 1)))){
+			level++;
+		}
+		ppSlot = &Wheel[level][(pTimer->Expires >> (SWTIMER_LEVEL_BITS * level)) & SWTIMER_LEVEL_MASK];
+	}
+
+	SWTIMER_Link(ppSlot, pTimer);
+	pTimer->State = SWTIMER_STATE_ARMED;
+}
+
+/*
+ * Redistribute one slot of a higher level into the lower levels.
+ * Returns the slot index, so the caller knows whether the next level also rolled over.
+ */
+static uint32_t SWTIMER_Cascade(uint8_t Level, uint32_t Index){
+	SWTIMER_t *pList = Wheel[Level][Index];
+	Wheel[Level][Index] = NULL;
+
+	while (pList != NULL){
+		SWTIMER_t *pTimer = pList;
+		pList = pList->pNext;
+		SWTIMER_AddToWheel(pTimer);
+	}
+	return Index;
+}
+
+/*
+ * Tick: TIM2 update interrupt (once per PWM period)
+ */
+static void SWTIMER_Tick(TIM_RegDef_t *pTIMx){
+	(void)pTIMx;
+	uint32_t primask = SWTIMER_EnterCritical();
+	uint32_t index = CurrentTick & SWTIMER_LEVEL_MASK;
+
+	/*
+	 * 1. Level 0 wrapped around -> pull the next block of 64 ticks down from level 1.
+	 * If level 1 wrapped too, pull from level 2, and so on.
+	 */
+	if (index == 0){
+		for (uint8_t level = 1; level < SWTIMER_LEVELS; level++){
+			if (SWTIMER_Cascade(level, (CurrentTick >> (SWTIMER_LEVEL_BITS * level)) & SWTIMER_LEVEL_MASK) != 0){
+				break;
+			}
+		}
+	}
+
+	/*
+	 * 2. Everything in this level-0 slot expires now: move it to the pending list.
+	 */
+	SWTIMER_t *pList = Wheel[0][index];
+	Wheel[0][index] = NULL;
+	CurrentTick++;
+
+	while (pList != NULL){
+		SWTIMER_t *pTimer = pList;
+		pList = pList->pNext;
+		SWTIMER_Link(&PendingHead, pTimer);
+		pTimer->State = SWTIMER_STATE_PENDING;
+	}
+
+	// 3. Defer the callbacks: ICSR bit 28 PENDSVSET
+	if (PendingHead != NULL){
+		SCB->ICSR = (1U << 28);
+	}
+
+	SWTIMER_ExitCritical(primask);
+}
+
+uint8_t SWTIMER_Init(void){
+	/*
+	 * PendSV priority = lowest (0xF0, only the top 4 bits exist on STM32F4)
+	 * so callbacks never hold up a real interrupt, including the tick itself.
+	 */
+	SCB->SHP[10] = 0xF0;
+
+	return TIM_RegisterUpdateCallback(SWTIMER_TICK_TIM, SWTIMER_Tick);
+}
+
+void SWTIMER_Setup(SWTIMER_t *pTimer, SWTIMER_Callback_t Callback, void *pArg){
+	pTimer->pNext = NULL;
+	pTimer->ppPrev = NULL;
+	pTimer->Expires = 0;
+	pTimer->Period = 0;
+	pTimer->Callback = Callback;
+	pTimer->pArg = pArg;
+	pTimer->State = SWTIMER_STATE_IDLE;
+}
+
+void SWTIMER_Start(SWTIMER_t *pTimer, uint32_t Timeout, uint32_t Period){
+	uint32_t primask = SWTIMER_EnterCritical();
+
+	if (pTimer->State != SWTIMER_STATE_IDLE){
+		SWTIMER_Unlink(pTimer); // restart: from the wheel or from the pending list
+	}
+	if (Timeout > SWTIMER_MAX_TIMEOUT){
+		Timeout = SWTIMER_MAX_TIMEOUT;
+	}
+	pTimer->Expires = CurrentTick + Timeout;
+	pTimer->Period = Period;
+	SWTIMER_AddToWheel(pTimer);
+
+	SWTIMER_ExitCritical(primask);
+}
+
+void SWTIMER_Stop(SWTIMER_t *pTimer){
+	uint32_t primask = SWTIMER_EnterCritical();
+
+	if (pTimer->State != SWTIMER_STATE_IDLE){
+		SWTIMER_Unlink(pTimer);
+		pTimer->State = SWTIMER_STATE_IDLE;
+	}
+
+	SWTIMER_ExitCritical(primask);
+}
+
+uint8_t SWTIMER_IsActive(const SWTIMER_t *pTimer){
+	return (pTimer->State != SWTIMER_STATE_IDLE);
+}
+
+uint32_t SWTIMER_GetTicks(void){
+	return CurrentTick;
+}
+
+/*
+ * Deferred context: runs after every other interrupt is done.
+ * One timer is taken off the pending list at a time, with interrupts masked only
+ * for the list operation; the callback itself runs with interrupts enabled,
+ * and may freely Start/Stop timers (including its own).
+ */
+void PendSV_Handler(void){
+	while (1){
+		uint32_t primask = SWTIMER_EnterCritical();
+		SWTIMER_t *pTimer = PendingHead;
+
+		if (pTimer == NULL){
+			SWTIMER_ExitCritical(primask);
+			break;
+		}
+
+		SWTIMER_Unlink(pTimer);
+		SWTIMER_Callback_t callback = pTimer->Callback;
+		void *pArg = pTimer->pArg;
+
+		if (pTimer->Period != 0){
+			pTimer->Expires += pTimer->Period; // from the previous expiry -> no drift
+			SWTIMER_AddToWheel(pTimer);
+		}else{
+			pTimer->State = SWTIMER_STATE_IDLE;
+		}
+
+		SWTIMER_ExitCritical(primask);
+
+		if (callback != NULL){
+			callback(pArg);
+		}
+	}
+}
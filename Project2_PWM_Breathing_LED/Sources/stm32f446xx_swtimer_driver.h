@@ -0,0 +1,129 @@
+/*
+ * stm32f446xx_swtimer_driver.h
+ *
+ *  Created on: 2026/1/18
+ *      Author: Yuheng
+ *
+ * Description:
+ * Software timers on a hierarchical timing wheel, driven by ONE hardware timer.
+ *
+ * Why?
+ * Blink periods, debounce windows, fade steps... every one of them used to be a
+ * blocking delay. Giving each one its own hardware timer does not scale either
+ * (there are only 14 timers, and TIM2/TIM5 are already taken).
+ *
+ * Tick source:
+ * The TIM2 update event, which already fires every PWM period (1 ms at 1 kHz).
+ * 1 tick = 1 TIM2 period. No extra hardware is used.
+ *
+ * Timing wheel (like a clock with 4 hands):
+ * - Level 0 has 64 slots, one per tick: timers due in the next 64 ticks.
+ * - Level 1 has 64 slots of 64 ticks each, level 2 of 4096 ticks, level 3 of 262144 ticks.
+ * - Each slot is a linked list. A timer is put directly into the slot of its expiry tick,
+ *   at the coarsest level it needs -> Start is O(1) (no sorting).
+ * - Stop unlinks the node from its list -> O(1) (doubly linked, no search).
+ * - Every tick only looks at ONE level-0 slot, and every timer in it is due -> no scan.
+ * - Every 64 ticks the next level-1 slot is "cascaded": its timers are redistributed into
+ *   level 0 (and every 4096 ticks level 2 into level 1, ...). Each timer moves at most 3 times.
+ * Longest timeout: 64^4 - 1 ticks (~4.6 hours at 1 ms), longer ones are clamped.
+ *
+ * Deferred callbacks:
+ * The TIM2 interrupt only moves expired timers onto a pending list and pends PendSV.
+ * PendSV runs at the LOWEST priority, after every other interrupt has finished, and
+ * calls the callbacks there. A slow callback therefore never delays the tick or any
+ * other interrupt.
+ *
+ * Refer to: Varghese & Lauck, "Hashed and Hierarchical Timing Wheels" (1987),
+ *           PM0214 - 2.3.2 Exception types (PendSV)
+ */
+
+#ifndef SOURCES_STM32F446XX_SWTIMER_DRIVER_H_
+#define SOURCES_STM32F446XX_SWTIMER_DRIVER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "stm32f446xx.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#define SWTIMER_TICK_TIM        TIM2
+#define SWTIMER_TICK_HZ         1000U       // = PWM frequency of TIM2, checked in main.c
+
+#define SWTIMER_LEVEL_BITS      6
+#define SWTIMER_LEVEL_SIZE      (1U << SWTIMER_LEVEL_BITS)  // 64 slots per level
+#define SWTIMER_LEVEL_MASK      (SWTIMER_LEVEL_SIZE - 1U)
+#define SWTIMER_LEVELS          4
+#define SWTIMER_MAX_TIMEOUT     ((1UL << (SWTIMER_LEVEL_BITS * SWTIMER_LEVELS)) - 1U)
+
+#define SWTIMER_MS_TO_TICKS(MS) (((MS) * SWTIMER_TICK_HZ) / 1000U)
+
+/*
+ * @SWTIMER_STATES
+ */
+#define SWTIMER_STATE_IDLE      0   // not running
+#define SWTIMER_STATE_ARMED     1   // waiting in the wheel
+#define SWTIMER_STATE_PENDING   2   // expired, callback not called yet
+
+/*
+ * ==========================================
+ * 2. Timer Object
+ * ==========================================
+ * Owned by the user (static or global, NOT on the stack of a function that returns
+ * while the timer runs). The driver only links it into its lists, no malloc.
+ */
+typedef void (*SWTIMER_Callback_t)(void *pArg);
+
+typedef struct SWTIMER_Timer{
+	struct SWTIMER_Timer *pNext;    // next node in the same slot / pending list
+	struct SWTIMER_Timer **ppPrev;  // the pointer that points at this node -> O(1) unlink
+	uint32_t Expires;               // absolute tick
+	uint32_t Period;                // 0 = one-shot, otherwise reload in ticks
+	SWTIMER_Callback_t Callback;
+	void *pArg;
+	volatile uint8_t State;         // Possible values: @SWTIMER_STATES
+} SWTIMER_t;
+
+/*
+ * ==========================================
+ * 3. API Function Prototypes
+ * ==========================================
+ * Start/Stop may be called from main, from a callback, or from an interrupt.
+ */
+
+/*
+ * Hook the wheel to the TIM2 update event and set PendSV to the lowest priority.
+ * TIM2 must already be running (TIM_PWM_Init).
+ * Returns DISABLE if the hook cannot be registered: the wheel would never tick.
+ */
+uint8_t SWTIMER_Init(void);
+
+/*
+ * Attach a callback to a timer object (timer must be stopped).
+ */
+void SWTIMER_Setup(SWTIMER_t *pTimer, SWTIMER_Callback_t Callback, void *pArg);
+
+/*
+ * (Re)start a timer.
+ * Timeout: ticks until the first expiry. The callback runs no earlier than
+ *          Timeout full ticks from now (the current, partial tick is not counted).
+ * Period:  0 for one-shot, otherwise the timer reloads itself every Period ticks.
+ *          Reloads are relative to the previous expiry, so a periodic timer does not drift.
+ */
+void SWTIMER_Start(SWTIMER_t *pTimer, uint32_t Timeout, uint32_t Period);
+
+/*
+ * Stop a timer. If it already expired but its callback has not run yet, the callback is cancelled.
+ */
+void SWTIMER_Stop(SWTIMER_t *pTimer);
+
+uint8_t SWTIMER_IsActive(const SWTIMER_t *pTimer);
+
+/*
+ * Number of ticks processed since SWTIMER_Init.
+ */
+uint32_t SWTIMER_GetTicks(void);
+
+#endif /* SOURCES_STM32F446XX_SWTIMER_DRIVER_H_ */
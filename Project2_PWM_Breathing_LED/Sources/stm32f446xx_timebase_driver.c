@@ -0,0 +1,167 @@
+/*
+ * stm32f446xx_timebase_driver.c
+ *
+ *  Created on: 2026/1/16
+ *      Author: Yuheng
+ */
+#include "stm32f446xx.h"
+#include "stm32f446xx_timebase_driver.h"
+#include "stm32f446xx_timer_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include "stm32f446xx_rcc_driver.h"
+#include <stdint.h>
+
+/*
+ * Microseconds elapsed when CNT was last 0.
+ * Current time = BaseUs + CNT.
+ * - The overflow interrupt adds 2^32 every time CNT wraps.
+ * - A clock switch folds CNT into BaseUs and restarts CNT from 0.
+ */
+static volatile uint64_t BaseUs;
+
+/*
+ * Interrupt masking that can be nested (safe to call from an ISR or with
+ * interrupts already disabled): save PRIMASK, disable, later restore the saved value.
+ */
+static uint32_t TIMEBASE_EnterCritical(void){
+	uint32_t primask;
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	return primask;
+}
+
+static void TIMEBASE_ExitCritical(uint32_t primask){
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
+/*
+ * PSC for a 1 MHz counter
+ * PSC + 1 = TimerClock / 1 MHz, e.g. 90 MHz -> 89, 16 MHz -> 15
+ */
+static uint32_t TIMEBASE_CalcPrescaler(uint32_t TimerClock){
+	uint32_t divider = (TimerClock + (TIMEBASE_TICK_HZ / 2U)) / TIMEBASE_TICK_HZ;
+	return (divider == 0) ? 0 : (divider - 1U);
+}
+
+/*
+ * Current time, must be called with interrupts masked.
+ * If CNT wrapped but the overflow ISR has not run yet (we are in a higher-priority
+ * ISR, or interrupts are masked), UIF is still set: account for that wrap here,
+ * and re-read CNT so the value is guaranteed to be from after the wrap.
+ */
+static uint64_t TIMEBASE_ReadLocked(void){
+	uint64_t base = BaseUs;
+	uint32_t cnt = TIMEBASE_TIM->CNT;
+
+	if (READ_BIT(TIMEBASE_TIM->SR, 0)){
+		cnt = TIMEBASE_TIM->CNT;
+		base += (1ULL << 32);
+	}
+	return base + cnt;
+}
+
+void TIMEBASE_Init(void){
+	TIM_PeriClockControl(TIMEBASE_TIM, ENABLE);
+
+	BaseUs = 0;
+	TIMEBASE_TIM->CR1 = 0;
+	TIMEBASE_TIM->PSC = TIMEBASE_CalcPrescaler(RCC_GetTimerClock1());
+	TIMEBASE_TIM->ARR = TIM_ARR_MAX_32BIT; // free-running over the full 32 bits
+
+	/*
+	 * CR1 bit 2 URS (Update Request Source) = 1:
+	 * only a real overflow raises UIF / the interrupt.
+	 * Software updates (EGR UG) below and in the clock callback stay silent.
+	 */
+	SET_BIT(TIMEBASE_TIM->CR1, 2);
+
+	// EGR bit 0 UG: load PSC now (it is preloaded) and reset CNT to 0
+	SET_BIT(TIMEBASE_TIM->EGR, 0);
+	TIMEBASE_TIM->SR = 0;
+
+	// DIER bit 0 UIE: overflow interrupt (once every ~71.6 minutes)
+	SET_BIT(TIMEBASE_TIM->DIER, 0);
+	NVIC_ISER_Config(TIMEBASE_IRQ);
+
+	RCC_RegisterClockChangeCallback(TIMEBASE_ClockChangeCallback);
+
+	SET_BIT(TIMEBASE_TIM->CR1, 0); // CEN
+}
+
+uint64_t TIMEBASE_GetTicksUs64(void){
+	uint32_t primask = TIMEBASE_EnterCritical();
+	uint64_t now = TIMEBASE_ReadLocked();
+	TIMEBASE_ExitCritical(primask);
+	return now;
+}
+
+uint32_t get_ticks_us(void){
+	/*
+	 * The low 32 bits of BaseUs only change on a clock switch (the overflow adds 2^32),
+	 * so in the normal case this is one load of BaseUs plus one CNT read.
+	 */
+	return (uint32_t)TIMEBASE_GetTicksUs64();
+}
+
+uint32_t get_ticks_ms(void){
+	// Divide the 64-bit value: dividing the wrapping 32-bit us count would jump at the wrap
+	return (uint32_t)(TIMEBASE_GetTicksUs64() / 1000U);
+}
+
+uint8_t timeout_expired_ms(uint32_t Start, uint32_t Timeout){
+	return ((uint32_t)(get_ticks_ms() - Start) >= Timeout);
+}
+
+uint8_t timeout_expired_us(uint32_t Start, uint32_t Timeout){
+	return ((uint32_t)(get_ticks_us() - Start) >= Timeout);
+}
+
+void delay_us(uint32_t Us){
+	/*
+	 * Start may be read just before CNT ticks, so waiting for "elapsed > Us"
+	 * (not >=) guarantees AT LEAST Us microseconds.
+	 */
+	uint32_t start = get_ticks_us();
+	while ((uint32_t)(get_ticks_us() - start) <= Us);
+}
+
+void delay_ms(uint32_t Ms){
+	uint64_t end = TIMEBASE_GetTicksUs64() + (uint64_t)Ms * 1000U + 1U;
+	while (TIMEBASE_GetTicksUs64() < end);
+}
+
+void TIMEBASE_ClockChangeCallback(const RCC_ClockTree_t *pClockTree){
+	uint32_t primask = TIMEBASE_EnterCritical();
+
+	/*
+	 * 1. Fold the elapsed time into BaseUs (including a wrap the ISR has not handled yet)
+	 * 2. New PSC, then UG: PSC is loaded immediately and CNT restarts from 0
+	 *    (URS = 1, so this does not look like an overflow).
+	 * Waiting for the next update event instead would leave the counter at the wrong
+	 * rate for up to 71 minutes.
+	 * Note: between the clock switch and this callback the counter ran at the new clock
+	 * with the old PSC, a few microseconds of error at most.
+	 */
+	BaseUs = TIMEBASE_ReadLocked();
+	TIMEBASE_TIM->PSC = TIMEBASE_CalcPrescaler(pClockTree->TIMCLK1);
+	SET_BIT(TIMEBASE_TIM->EGR, 0);
+	TIMEBASE_TIM->SR = 0;
+
+	TIMEBASE_ExitCritical(primask);
+}
+
+/*
+ * Overflow: CNT went from 0xFFFFFFFF back to 0
+ * Masked, because a higher-priority ISR reading the time between "clear UIF"
+ * and "BaseUs += 2^32" would see the time jump back by 71 minutes.
+ */
+void TIM5_IRQHandler(void){
+	uint32_t primask = TIMEBASE_EnterCritical();
+
+	if (READ_BIT(TIMEBASE_TIM->SR, 0)){
+		TIMEBASE_TIM->SR = ~(1U << 0); // rc_w0: write 0 to clear UIF, 1 leaves other flags untouched
+		BaseUs += (1ULL << 32);
+	}
+
+	TIMEBASE_ExitCritical(primask);
+}
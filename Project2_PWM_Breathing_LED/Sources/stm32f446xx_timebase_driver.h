@@ -0,0 +1,95 @@
+/*
+ * stm32f446xx_timebase_driver.h
+ *
+ *  Created on: 2026/1/16
+ *      Author: Yuheng
+ *
+ * Description:
+ * Monotonic time base (milliseconds / microseconds) built on TIM5.
+ *
+ * Why not software_delay()?
+ * software_delay(count) is a busy loop: how long "count" takes depends on the
+ * optimization level (-O0 vs -O2), on flash wait states / ART, and on the CPU clock.
+ * The old "500000 ~ 125ms" estimate was only right for one build at 16 MHz.
+ *
+ * Why TIM5 and not SysTick?
+ * - TIM5 has a 32-bit counter. Running it at 1 MHz gives 1 us per count and it only
+ *   wraps every ~71.6 minutes, so reading the time is ONE register read (CNT).
+ * - SysTick is 24-bit and would need a 1 kHz interrupt to build a millisecond counter.
+ *   That interrupt wakes the CPU every millisecond and breaks tickless idle.
+ * - TIM2 is busy generating the PWM.
+ * The only interrupt is the overflow every 2^32 us, used to extend the count to 64 bits.
+ *
+ * Wrap-around rule:
+ * get_ticks_ms()/get_ticks_us() are 32-bit and wrap. ALWAYS compare with subtraction:
+ *   if ((get_ticks_ms() - start) >= timeout)   -> correct across the wrap
+ *   if (get_ticks_ms() >= start + timeout)     -> WRONG near the wrap
+ * timeout_expired_ms()/timeout_expired_us() do this for you.
+ *
+ * Refer to RM0390 - 18 General-purpose timers (TIM2 to TIM5)
+ */
+
+#ifndef SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_
+#define SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_
+
+#include <stdint.h>
+#include "stm32f446xx.h"
+#include "stm32f446xx_rcc_driver.h"
+
+/*
+ * ==========================================
+ * 1. Configuration
+ * ==========================================
+ */
+#define TIMEBASE_TIM            TIM5
+#define TIMEBASE_IRQ            TIM5_IRQ
+#define TIMEBASE_TICK_HZ        1000000U    // 1 count = 1 us
+
+/*
+ * ==========================================
+ * 2. API Function Prototypes
+ * ==========================================
+ */
+
+/*
+ * Start the time base (counts from 0).
+ * Call once at startup. Survives RCC_SetSystemClock(): the prescaler is
+ * re-tuned through the RCC clock-change callback without losing time.
+ */
+void TIMEBASE_Init(void);
+
+/*
+ * Time since TIMEBASE_Init.
+ * 64-bit version never wraps (584 000 years), the 32-bit versions wrap
+ * (us after ~71.6 min, ms after ~49.7 days), see the wrap-around rule above.
+ * Safe to call from interrupts.
+ */
+uint64_t TIMEBASE_GetTicksUs64(void);
+uint32_t get_ticks_us(void);
+uint32_t get_ticks_ms(void);
+
+/*
+ * Non-blocking deadline checks
+ * Returns 1 once at least Timeout has passed since Start, 0 otherwise.
+ * Usage:
+ *   uint32_t start = get_ticks_ms();
+ *   ...
+ *   if (timeout_expired_ms(start, 125)) { toggle; start += 125; }
+ */
+uint8_t timeout_expired_ms(uint32_t Start, uint32_t Timeout);
+uint8_t timeout_expired_us(uint32_t Start, uint32_t Timeout);
+
+/*
+ * Calibrated blocking delays
+ * Same duration at any optimization level and any clock.
+ * delay_us() busy-waits on the counter (resolution 1 us), so it also works inside an ISR.
+ */
+void delay_us(uint32_t Us);
+void delay_ms(uint32_t Ms);
+
+/*
+ * Registered automatically by TIMEBASE_Init (see RCC_RegisterClockChangeCallback).
+ */
+void TIMEBASE_ClockChangeCallback(const RCC_ClockTree_t *pClockTree);
+
+#endif /* SOURCES_STM32F446XX_TIMEBASE_DRIVER_H_ */
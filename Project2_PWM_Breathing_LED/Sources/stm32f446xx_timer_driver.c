@@ -6,59 +6,303 @@
  */
 #include "stm32f446xx.h"
 #include "stm32f446xx_timer_driver.h"
+#include "stm32f446xx_rcc_driver.h"
+#include "stm32f446xx_pclk_driver.h"
+#include "stm32f446xx_gpio_driver.h"
+#include "stm32f446xx_dma_driver.h"
 #include <stdint.h>
 #include <stdio.h>
 
+/*
+ * Timers to re-tune on a clock switch (see TIM_ClockChangeCallback)
+ * CounterFreq: the tick rate the user asked for, in Hz (e.g. 1 MHz for PSC = 89 at 90 MHz)
+ */
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	uint32_t CounterFreq;
+} TIM_Tracked_t;
+
+static TIM_Tracked_t TrackedTimers[TIM_MAX_TRACKED];
+static uint8_t TrackedTimerCount;
+
+/*
+ * Sync groups started with TIM_Sync_Start: restarted after a clock change
+ */
+static TIM_Sync_Handle_t *SyncGroups[TIM_MAX_SYNC_GROUPS];
+
+/*
+ * Update callbacks (see TIM_RegisterUpdateCallback), one row per timer (index: TIMx - 1)
+ * Unregistered entries are left NULL: the IRQ can be walking the row at the time.
+ */
+static TIM_UpdateCallback_t volatile UpdateHooks[TIM_COUNT][TIM_MAX_UPDATE_CALLBACKS];
+
+/*
+ * One-pulse "done" callbacks (see TIM_OPM_Init / TIM_OPM_DelayUs)
+ */
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	TIM_OPM_Callback_t Callback;
+} TIM_OPMDone_t;
+
+static TIM_OPMDone_t OPMDone[TIM_MAX_OPM];
+
+/*
+ * Capture callbacks (see TIM_IC_Init), one per channel
+ */
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	TIM_IC_Callback_t Callback[4];
+} TIM_ICHooks_t;
+
+static TIM_ICHooks_t ICHooks[TIM_MAX_IC];
+
+/*
+ * Helper: input clock of a timer
+ * TIM2-7 and TIM12-14 sit on APB1, TIM1 and TIM8-11 on APB2.
+ * Every APB2 peripheral has a higher address than every APB1 peripheral,
+ * so comparing against APB2_BASEADDR is enough to tell them apart.
+ */
+static uint8_t TIM_IsOnAPB2(TIM_RegDef_t *pTIMx){
+	return ((uint32_t)pTIMx >= APB2_BASEADDR);
+}
+
+/*
+ * ==========================================
+ * Timer Descriptor Table
+ * ==========================================
+ * Indexed by timer number - 1 (TIM1 = [0] ... TIM14 = [13]).
+ * DMA: stream / request channel of the update request and of CH1-CH4.
+ * Where RM0390 offers two streams for one request, the one that collides least
+ * with the other requests of the same timer is listed (e.g. TIM2_UP on S1, not S7 = CH4).
+ */
+#define TIM_NO_DMA              {TIM_DMA_NONE, 0}
+
+static const TIM_Descriptor_t TimerTable[TIM_COUNT] = {
+	// TIMx   n   bits ch  PCLK ID     update IRQ               capture IRQ              DMA   update    CH1       CH2       CH3       CH4
+	{TIM1,    1,  16,  4,  PCLK_TIM1,  TIM1_UP_TIM10_IRQ,       TIM1_CC_IRQ,             DMA2, {5, 6},  {{1, 6},  {2, 6},  {6, 6},  {4, 6}}},
+	{TIM2,    2,  32,  4,  PCLK_TIM2,  TIM2_IRQ,                TIM2_IRQ,                DMA1, {1, 3},  {{5, 3},  {6, 3},  {1, 3},  {7, 3}}},
+	{TIM3,    3,  16,  4,  PCLK_TIM3,  TIM3_IRQ,                TIM3_IRQ,                DMA1, {2, 5},  {{4, 5},  {5, 5},  {7, 5},  {2, 5}}},
+	{TIM4,    4,  16,  4,  PCLK_TIM4,  TIM4_IRQ,                TIM4_IRQ,                DMA1, {6, 2},  {{0, 2},  {3, 2},  {7, 2},  TIM_NO_DMA}},
+	{TIM5,    5,  32,  4,  PCLK_TIM5,  TIM5_IRQ,                TIM5_IRQ,                DMA1, {6, 6},  {{2, 6},  {4, 6},  {0, 6},  {1, 6}}},
+	{TIM6,    6,  16,  0,  PCLK_TIM6,  TIM6_DAC_IRQ,            TIM_IRQ_NONE,            DMA1, {1, 7},  {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM7,    7,  16,  0,  PCLK_TIM7,  TIM7_IRQ,                TIM_IRQ_NONE,            DMA1, {2, 1},  {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM8,    8,  16,  4,  PCLK_TIM8,  TIM8_UP_TIM13_IRQ,       TIM8_CC_IRQ,             DMA2, {1, 7},  {{2, 7},  {3, 7},  {4, 7},  {7, 7}}},
+	{TIM9,    9,  16,  2,  PCLK_TIM9,  TIM1_BRK_TIM9_IRQ,       TIM1_BRK_TIM9_IRQ,       NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM10,  10,  16,  1,  PCLK_TIM10, TIM1_UP_TIM10_IRQ,       TIM1_UP_TIM10_IRQ,       NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM11,  11,  16,  1,  PCLK_TIM11, TIM1_TRG_COM_TIM11_IRQ,  TIM1_TRG_COM_TIM11_IRQ,  NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM12,  12,  16,  2,  PCLK_TIM12, TIM8_BRK_TIM12_IRQ,      TIM8_BRK_TIM12_IRQ,      NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM13,  13,  16,  1,  PCLK_TIM13, TIM8_UP_TIM13_IRQ,       TIM8_UP_TIM13_IRQ,       NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+	{TIM14,  14,  16,  1,  PCLK_TIM14, TIM8_TRG_COM_TIM14_IRQ,  TIM8_TRG_COM_TIM14_IRQ,  NULL, TIM_NO_DMA, {TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA, TIM_NO_DMA}},
+};
+
+/*
+ * Base address -> timer number, O(1) (no if/else chain, no search):
+ * APB1 timers are 0x400 apart starting at TIM2: TIM2 (+0x0000) .. TIM7 (+0x1400), TIM12 (+0x1800) .. TIM14 (+0x2000)
+ * APB2 timers come in two blocks: TIM1/TIM8 (+0x0000, +0x0400) and TIM9/TIM10/TIM11 (+0x4000 ..)
+ */
+static const uint8_t APB1TimerNumber[9] = {2, 3, 4, 5, 6, 7, 12, 13, 14};
+
+const TIM_Descriptor_t *TIM_GetDescriptor(TIM_RegDef_t *pTIMx){
+	uint32_t addr = (uint32_t)pTIMx;
+	uint8_t number = 0;
+
+	if ((addr & 0x3FFU) != 0){
+		return NULL;
+	}
+	if (addr >= APB1_BASEADDR && addr <= (APB1_BASEADDR + 0x2000U)){
+		number = APB1TimerNumber[(addr - APB1_BASEADDR) / 0x400U];
+	}else if (addr == APB2_BASEADDR || addr == (APB2_BASEADDR + 0x0400U)){
+		number = (addr == APB2_BASEADDR) ? 1 : 8;
+	}else if (addr >= (APB2_BASEADDR + 0x4000U) && addr <= (APB2_BASEADDR + 0x4800U)){
+		number = 9 + (addr - (APB2_BASEADDR + 0x4000U)) / 0x400U;
+	}else{
+		return NULL;
+	}
+	return &TimerTable[number - 1U];
+}
+
+/*
+ * Helper: timer base address -> clock manager ID
+ */
+static uint8_t TIM_GetPclkId(TIM_RegDef_t *pTIMx){
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	return (pDesc != NULL) ? pDesc->PclkId : PCLK_COUNT; // not a timer -> ignored by the clock manager
+}
+
+void TIM_PeriClockControl(TIM_RegDef_t *pTIMx, uint8_t EnableOrDisable){
+	if (EnableOrDisable == ENABLE){
+		PCLK_Acquire(TIM_GetPclkId(pTIMx));
+	}
+	else if (EnableOrDisable == DISABLE){
+		PCLK_Release(TIM_GetPclkId(pTIMx));
+	}
+}
+
+static void TIM_Track(TIM_RegDef_t *pTIMx, uint32_t CounterFreq){
+	for (uint8_t i = 0; i < TrackedTimerCount; i++){
+		if (TrackedTimers[i].pTIMx == pTIMx){
+			TrackedTimers[i].CounterFreq = CounterFreq; // re-init of the same timer
+			return;
+		}
+	}
+	if (TrackedTimerCount < TIM_MAX_TRACKED){
+		TrackedTimers[TrackedTimerCount].pTIMx = pTIMx;
+		TrackedTimers[TrackedTimerCount].CounterFreq = CounterFreq;
+		TrackedTimerCount++;
+	}
+}
+
+/*
+ * Helper: load the preloaded PSC/ARR/CCRx now (UG), CNT = 0.
+ * CR1 bit 2 URS for the duration: that UG raises no UIF and no DMA request,
+ * so update callbacks and waveform DMA see no extra tick.
+ * (It does NOT hold back TRGO: with MMS = reset / update, UG pulses the slaves.)
+ */
+static void TIM_ForceReload(TIM_RegDef_t *pTIMx){
+	uint32_t urs = pTIMx->CR1 & (1U << 2);
+	SET_BIT(pTIMx->CR1, 2);
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->CR1 = (pTIMx->CR1 & ~(1U << 2)) | urs;
+}
+
+static uint8_t TIM_Sync_IsMember(TIM_RegDef_t *pTIMx);
+
+void TIM_ClockChangeCallback(const RCC_ClockTree_t *pClockTree){
+	for (uint8_t i = 0; i < TrackedTimerCount; i++){
+		TIM_RegDef_t *pTIMx = TrackedTimers[i].pTIMx;
+		uint32_t counter_freq = TrackedTimers[i].CounterFreq;
+		uint32_t timer_clk = TIM_IsOnAPB2(pTIMx) ? pClockTree->TIMCLK2 : pClockTree->TIMCLK1;
+
+		// PSC + 1 = TimerClock / CounterFreq (rounded), e.g. 16 MHz / 1 MHz = 16 -> PSC = 15
+		uint32_t divider = (timer_clk + (counter_freq / 2U)) / counter_freq;
+		if (divider == 0){
+			divider = 1; // clock now slower than the wanted tick: run as fast as possible
+		}
+		pTIMx->PSC = divider - 1U;
+
+		/*
+		 * PSC is preloaded: left alone, the running period AND the next one would
+		 * still count at the old divider on the new clock (180 -> 16 MHz stretches
+		 * a 1 ms period to ~5.6 ms). UG loads it now and restarts the period at CNT = 0.
+		 * Not on timers linked to others, where a lone UG does more harm than the
+		 * stretched period (the new PSC then loads at their next update event):
+		 * - sync group members: restarted together below, phase offsets included
+		 * - slaves (SMCR SMS != 0): UG would reset a count that belongs to the master
+		 * - masters (CR2 MMS != 0, e.g. TIM2 -> TIM4 waveform divider): UG would pulse TRGO
+		 */
+		if (!TIM_Sync_IsMember(pTIMx) && (pTIMx->SMCR & 7U) == 0 && (pTIMx->CR2 & (7U << 4)) == 0){
+			TIM_ForceReload(pTIMx);
+		}
+	}
+
+	for (uint8_t i = 0; i < TIM_MAX_SYNC_GROUPS; i++){
+		if (SyncGroups[i] != NULL){
+			TIM_Sync_Start(SyncGroups[i]);
+		}
+	}
+}
+
+/*
+ * Helper: one channel as an output compare / PWM output
+ * CCMR1 holds channels 1 (bits 7:0) and 2 (bits 15:8), CCMR2 holds channels 3 and 4.
+ * Per channel byte: CCxS (1:0) = 00 output, OCxPE (3) preload, OCxM (6:4) mode
+ * CCER: 4 bits per channel, CCxE (bit 0) enable, CCxP (bit 1) active low
+ */
+static void TIM_OC_ConfigChannel(TIM_RegDef_t *pTIMx, uint8_t Channel, uint8_t Mode, uint8_t Polarity, uint8_t Preload){
+	volatile uint32_t *pCCMR = (Channel <= 2) ? &pTIMx->CCMR1 : &pTIMx->CCMR2;
+	uint8_t ccmr_shift = ((Channel - 1U) & 1U) * 8U;
+	uint8_t ccer_shift = (Channel - 1U) * 4U;
+
+	/*
+	 * Important: We should clear the bits before setting them to avoid corruption
+	 * if the register had garbage values or previous settings.
+	 * e.g. channel 1, PWM mode 1: clear bits 7:0, then OC1M = 110 -> 6 << 4
+	 */
+	*pCCMR &= ~(0xFFU << ccmr_shift);
+	*pCCMR |= ((uint32_t)(Mode & 7U) << (ccmr_shift + 4U));
+
+	/*
+	 * Enable Preload (OCxPE)
+	 * Good practice for PWM. It ensures that if we change CCRx while the timer is running,
+	 * the new value only takes effect at the next update event (end of cycle),
+	 * preventing "glitches" in the waveform.
+	 */
+	if (Preload == ENABLE){
+		SET_BIT(*pCCMR, ccmr_shift + 3U);
+	}
+
+	/*
+	 * CCER (capture/compare enable register)
+	 * CCxE connects the internal PWM signal to the physical Pin.
+	 */
+	pTIMx->CCER &= ~(0xFU << ccer_shift);
+	if (Polarity == TIM_OC_POL_LOW){
+		SET_BIT(pTIMx->CCER, ccer_shift + 1U);
+	}
+	SET_BIT(pTIMx->CCER, ccer_shift);
+}
+
 void TIM_PWM_Init(TIM_Handle_t *pTIMHandle){
 	TIM_RegDef_t* pTIMx = pTIMHandle->pTIMx;
 	TIM_Config_t TIM_Config = pTIMHandle->TIM_Config;
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	if (pDesc == NULL || pDesc->Channels == 0){
+		return; // not a timer, or a basic timer (TIM6/TIM7) without outputs
+	}
+
+	/*
+	 * 0. CR1 CMS (6:5): edge- or center-aligned
+	 * Only allowed while the counter is stopped (RM0390: switching alignment with CEN = 1 is not allowed).
+	 * CMS only exists on the 4-channel timers (TIM1-5, TIM8), the bits are reserved elsewhere.
+	 */
+	CLEAR_BIT(pTIMx->CR1, 0);
+	if (pDesc->Channels == TIM_CHANNELS){
+		pTIMx->CR1 = (pTIMx->CR1 & ~(3U << 5)) | ((uint32_t)(TIM_Config.Alignment & 3U) << 5);
+	}
 
 	// 1. Set PSC (Speed)
 	pTIMx->PSC = TIM_Config.Prescaler; // TIM_Config is NOT a pointer (it is an object), use .
 
-	// 2. Set ARR (Period/Frequency)
+	/*
+	 * Remember the counter frequency so the PWM survives a runtime clock switch
+	 * (see TIM_ClockChangeCallback / RCC_SetSystemClock)
+	 */
+	uint32_t timer_clk = TIM_IsOnAPB2(pTIMx) ? RCC_GetTimerClock2() : RCC_GetTimerClock1();
+	TIM_Track(pTIMx, timer_clk / (TIM_Config.Prescaler + 1U));
+	RCC_RegisterClockChangeCallback(TIM_ClockChangeCallback);
+
+	// 2. Set ARR (Period/Frequency), shared by every channel
 	pTIMx->ARR = TIM_Config.Period;
 
 	/*
 	 * ==========================================
-	 * 3. set CCMR1 to PWM mode 1
+	 * 3. Channels: CCMRx mode + preload, CCER polarity + enable, CCRx initial duty
 	 * ==========================================
-	 * Bit 6:4 OC1M: Output compare 1 mode
-	 * 110: PWM mode 1 - In upcounting, channel 1 is active as long as TIMx_CNT < TIMx_CCR1
-	 * thus, we set bit 6 to 1, bit 5 to 1, bit 4 to 0
-	 * Important: We should clear the bits before setting them to avoid corruption
-     * if the register had garbage values or previous settings.
+	 * e.g. PWM mode 1 (OCxM = 110): in upcounting, channel x is active as long as TIMx_CNT < TIMx_CCRx
 	 */
+	for (uint8_t ch = 1; ch <= TIM_CHANNELS; ch++){
+		TIM_PWMChannel_t *pChannel = &TIM_Config.Channel[ch - 1U];
 
-	// a) Clear bits 4, 5, 6 (OC1M field)
-	// ~(7 << 4) means ~(111 << 4) -> ~(0000000001110000) -> 1111111110001111
-	pTIMx->CCMR1 &= ~(7U << 4);
-
-	// b) Set bits to 110 (PWM Mode 1)
-	// 6 << 4 -> 110 << 4 -> 0000000001100000
-	pTIMx->CCMR1 |= (6U << 4);
-
-	/*
-	 * 4. Enable Preload (OC1PE)
-	 * Good practice for PWM. It ensures that if we change CCR1 while the timer is running,
-	 * the new value only takes effect at the next update event (end of cycle),
-	 * preventing "glitches" in the waveform.
-	 */
-	SET_BIT(pTIMx->CCMR1, 3);
+		if (pChannel->Enable != ENABLE || ch > pDesc->Channels){
+			continue;
+		}
+		TIM_OC_ConfigChannel(pTIMx, ch, pChannel->Mode, pChannel->Polarity, pChannel->Preload);
+		(&pTIMx->CCR1)[ch - 1U] = pChannel->InitialDuty; // CCR1..CCR4 are consecutive
+	}
 
 	/*
-	 * ==========================================
-	 * 5. Enable CCER (capture/compare enable register)
-	 * ==========================================
-     * This connects the internal PWM signal to the physical Pin.
-     * This bit determines if a capture of the counter value can actually be done into the input
-     * capture/compare register 1 (TIMx_CCR1) or not.
+	 * 4. EGR bit 0 UG: copy PSC and the preloaded CCRx into the active registers now,
+	 * so the very first period already has the right frequency and duty.
+	 * The UIF this raises is not a real period end: drop it.
 	 */
-	SET_BIT(pTIMx->CCER, 0);
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
 
 	/*
 	 * ==========================================
-	 * 6. Enable Counter (in CR1 - Control Register 1)
+	 * 5. Enable Counter (in CR1 - Control Register 1)
 	 * ==========================================
 	 * won't work without Counter Enabled
 	 * Bit 0 CEN: Counter enable
@@ -70,7 +314,1476 @@ void TIM_PWM_Init(TIM_Handle_t *pTIMHandle){
 	SET_BIT(pTIMx->CR1, 0);
 }
 
+void TIM_SetCompare(TIM_RegDef_t *pTIMx, uint8_t Channel, uint32_t CompareValue){
+	if (Channel < 1 || Channel > TIM_CHANNELS){
+		return;
+	}
+	// Writing to CCRx changes the duty cycle (brightness)
+	(&pTIMx->CCR1)[Channel - 1U] = CompareValue;
+}
+
+void TIM_SetCompareAll(TIM_RegDef_t *pTIMx, const uint32_t Values[TIM_CHANNELS]){
+	uint32_t primask;
+
+	/*
+	 * CCRx are preloaded: the four values go live at the next update event.
+	 * An update landing between two writes would switch the outputs one period
+	 * apart (e.g. a color flash on an RGB LED), so the writes go back to back with
+	 * interrupts masked: the window is a few cycles per period.
+	 * Not CR1 UDIS: it does not hold the update event off, it DISCARDS it,
+	 * and with it that period's UIF (a lost tick) and UDE request (a lost DMA sample).
+	 */
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	pTIMx->CCR1 = Values[0];
+	pTIMx->CCR2 = Values[1];
+	pTIMx->CCR3 = Values[2];
+	pTIMx->CCR4 = Values[3];
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+}
+
 void TIM_SetCompare1(TIM_RegDef_t *pTIMx, uint32_t CaptureValue){
-	// Writing to CCR1 changes the duty cycle (brightness)
-	pTIMx->CCR1 = CaptureValue;
+	TIM_SetCompare(pTIMx, 1, CaptureValue);
+}
+
+/*
+ * Helper: NVIC line of a timer that has a vector handler in this driver
+ * Returns TIM_IRQ_NONE for TIM5 (the time base driver owns TIM5_IRQHandler).
+ */
+static uint8_t TIM_GetIRQNumber(TIM_RegDef_t *pTIMx){
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	if (pDesc == NULL || pTIMx == TIM5){
+		return TIM_IRQ_NONE;
+	}
+	return pDesc->IRQNumber;
+}
+
+uint8_t TIM_RegisterUpdateCallback(TIM_RegDef_t *pTIMx, TIM_UpdateCallback_t Callback){
+	uint8_t irq = TIM_GetIRQNumber(pTIMx);
+
+	if (Callback == NULL || irq == TIM_IRQ_NONE){
+		return DISABLE;
+	}
+
+	TIM_UpdateCallback_t volatile *pHooks = UpdateHooks[TIM_GetDescriptor(pTIMx)->Number - 1U];
+	uint8_t free_slot = TIM_MAX_UPDATE_CALLBACKS;
+	for (uint8_t i = 0; i < TIM_MAX_UPDATE_CALLBACKS; i++){
+		if (pHooks[i] == Callback){
+			return ENABLE;
+		}
+		if (pHooks[i] == NULL && free_slot == TIM_MAX_UPDATE_CALLBACKS){
+			free_slot = i;
+		}
+	}
+	if (free_slot == TIM_MAX_UPDATE_CALLBACKS){
+		return DISABLE;
+	}
+	pHooks[free_slot] = Callback;
+
+	/*
+	 * DIER bit 0 UIE: Update interrupt enable
+	 * Clear a stale UIF first, otherwise the IRQ fires immediately for an old event.
+	 */
+	if (!READ_BIT(pTIMx->DIER, 0)){
+		pTIMx->SR = ~(1U << 0);
+		SET_BIT(pTIMx->DIER, 0);
+	}
+	NVIC_ISER_Config(irq);
+
+	return ENABLE;
+}
+
+uint8_t TIM_UnregisterUpdateCallback(TIM_RegDef_t *pTIMx, TIM_UpdateCallback_t Callback){
+	if (Callback == NULL || TIM_GetIRQNumber(pTIMx) == TIM_IRQ_NONE){
+		return DISABLE;
+	}
+
+	TIM_UpdateCallback_t volatile *pHooks = UpdateHooks[TIM_GetDescriptor(pTIMx)->Number - 1U];
+	uint8_t found = DISABLE;
+	uint8_t in_use = 0;
+	for (uint8_t i = 0; i < TIM_MAX_UPDATE_CALLBACKS; i++){
+		if (pHooks[i] == Callback){
+			pHooks[i] = NULL;
+			found = ENABLE;
+		}else if (pHooks[i] != NULL){
+			in_use = 1;
+		}
+	}
+
+	// Last callback gone: UIE off (the NVIC line stays on, it may serve capture callbacks)
+	if (found == ENABLE && !in_use){
+		CLEAR_BIT(pTIMx->DIER, 0);
+	}
+	return found;
+}
+
+static void TIM_IC_IRQHandling(TIM_RegDef_t *pTIMx);
+
+void TIM_IRQHandling(TIM_RegDef_t *pTIMx){
+	if (READ_BIT(pTIMx->SR, 0)){
+		/*
+		 * SR bits are rc_w0 (cleared by writing 0, writing 1 has no effect):
+		 * writing ~UIF clears only UIF and leaves the CCxIF flags alone.
+		 */
+		pTIMx->SR = ~(1U << 0);
+
+		const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+		for (uint8_t i = 0; pDesc != NULL && i < TIM_MAX_UPDATE_CALLBACKS; i++){
+			TIM_UpdateCallback_t Callback = UpdateHooks[pDesc->Number - 1U][i];
+			if (Callback != NULL){
+				Callback(pTIMx);
+			}
+		}
+	}
+
+	TIM_IC_IRQHandling(pTIMx);
+}
+
+void TIM2_IRQHandler(void){
+	TIM_IRQHandling(TIM2);
+}
+
+void TIM3_IRQHandler(void){
+	TIM_IRQHandling(TIM3);
+}
+
+void TIM4_IRQHandler(void){
+	TIM_IRQHandling(TIM4);
+}
+
+void TIM6_DAC_IRQHandler(void){
+	TIM_IRQHandling(TIM6);
+}
+
+void TIM7_IRQHandler(void){
+	TIM_IRQHandling(TIM7);
+}
+
+/*
+ * Shared vectors: the handler serves both timers. TIM_IRQHandling only acts on
+ * flags that are set, and a timer without clock reads SR = 0, so the unused
+ * half costs one register read.
+ * TIM1 / TIM8: update and captures come on separate vectors, both end up in
+ * TIM_IRQHandling (the break vectors, shared with TIM9 / TIM12, are in Section 9).
+ */
+void TIM1_UP_TIM10_IRQHandler(void){
+	TIM_IRQHandling(TIM1);
+	TIM_IRQHandling(TIM10);
+}
+
+void TIM1_TRG_COM_TIM11_IRQHandler(void){
+	TIM_IRQHandling(TIM11);
+}
+
+void TIM1_CC_IRQHandler(void){
+	TIM_IRQHandling(TIM1);
+}
+
+void TIM8_UP_TIM13_IRQHandler(void){
+	TIM_IRQHandling(TIM8);
+	TIM_IRQHandling(TIM13);
+}
+
+void TIM8_TRG_COM_TIM14_IRQHandler(void){
+	TIM_IRQHandling(TIM14);
+}
+
+void TIM8_CC_IRQHandler(void){
+	TIM_IRQHandling(TIM8);
+}
+
+/*
+ * ==========================================
+ * One-Pulse Mode
+ * ==========================================
+ */
+
+/*
+ * Helper: largest ARR value, TIM2 and TIM5 are the only 32-bit timers
+ */
+static uint32_t TIM_GetArrMax(TIM_RegDef_t *pTIMx){
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	return (pDesc != NULL && pDesc->CounterBits == 32) ? TIM_ARR_MAX_32BIT : TIM_ARR_MAX_16BIT;
+}
+
+/*
+ * Update hook shared by every OPM timer: the counter just stopped (pulse/delay over)
+ */
+static void TIM_OPM_UpdateHook(TIM_RegDef_t *pTIMx){
+	for (uint8_t i = 0; i < TIM_MAX_OPM; i++){
+		if (OPMDone[i].pTIMx == pTIMx && OPMDone[i].Callback != NULL){
+			OPMDone[i].Callback(pTIMx);
+		}
+	}
+}
+
+/*
+ * Returns DISABLE if a callback was given but cannot be hooked (no slot, update table full,
+ * or no vector handler): the caller would wait for a "done" that never comes.
+ */
+static uint8_t TIM_OPM_SetDoneCallback(TIM_RegDef_t *pTIMx, TIM_OPM_Callback_t Callback){
+	uint8_t free_slot = TIM_MAX_OPM;
+
+	for (uint8_t i = 0; i < TIM_MAX_OPM; i++){
+		if (OPMDone[i].pTIMx == pTIMx){
+			OPMDone[i].Callback = Callback;
+			free_slot = i;
+			break;
+		}
+		if (OPMDone[i].pTIMx == NULL && free_slot == TIM_MAX_OPM){
+			free_slot = i;
+		}
+	}
+	if (Callback == NULL){
+		return ENABLE;
+	}
+	if (free_slot == TIM_MAX_OPM){
+		return DISABLE;
+	}
+
+	OPMDone[free_slot].pTIMx = pTIMx;
+	OPMDone[free_slot].Callback = Callback;
+	if (TIM_RegisterUpdateCallback(pTIMx, TIM_OPM_UpdateHook) != ENABLE){
+		OPMDone[free_slot].pTIMx = NULL;
+		OPMDone[free_slot].Callback = NULL;
+		return DISABLE;
+	}
+	return ENABLE;
+}
+
+/*
+ * Helper: TI1 or TI2 as trigger input
+ * CCxS = 01 (input, mapped on its own pin), CCxP selects the edge (CCxNP stays 0)
+ */
+static void TIM_OPM_ConfigTrigger(TIM_RegDef_t *pTIMx, uint8_t Trigger, uint8_t Edge){
+	uint8_t input_ch = (Trigger == TIM_OPM_TRIG_TI1) ? 1 : 2;
+	uint8_t ccmr_shift = (input_ch - 1U) * 8U;
+	uint8_t ccer_shift = (input_ch - 1U) * 4U;
+
+	pTIMx->CCMR1 &= ~(0xFFU << ccmr_shift);
+	pTIMx->CCMR1 |= (1U << ccmr_shift);
+
+	pTIMx->CCER &= ~(0xFU << ccer_shift);
+	if (Edge == TIM_OPM_EDGE_FALLING){
+		SET_BIT(pTIMx->CCER, ccer_shift + 1U);
+	}
+
+	/*
+	 * SMCR
+	 * TS  (6:4) = 101 TI1FP1 / 110 TI2FP2 -> which input is the trigger
+	 * SMS (2:0) = 110 Trigger mode        -> the trigger edge sets CEN
+	 */
+	pTIMx->SMCR &= ~((7U << 4) | (7U << 0));
+	pTIMx->SMCR |= (((Trigger == TIM_OPM_TRIG_TI1) ? 5U : 6U) << 4) | (6U << 0);
+}
+
+uint8_t TIM_OPM_Init(TIM_OPM_Handle_t *pOPMHandle){
+	TIM_RegDef_t *pTIMx = pOPMHandle->pTIMx;
+	TIM_OPM_Config_t OPM_Config = pOPMHandle->OPM_Config;
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	if (pDesc == NULL || OPM_Config.Channel < 1 || OPM_Config.Channel > pDesc->Channels){
+		return DISABLE;
+	}
+	// TI1/TI2 trigger: slave mode controller, only on timers with 2+ channels (not TIM10/11/13/14)
+	if (OPM_Config.Trigger != TIM_OPM_TRIG_SOFTWARE && pDesc->Channels < 2){
+		return DISABLE;
+	}
+	// the trigger input and the output cannot share a channel
+	if ((OPM_Config.Trigger == TIM_OPM_TRIG_TI1 && OPM_Config.Channel == 1) ||
+	    (OPM_Config.Trigger == TIM_OPM_TRIG_TI2 && OPM_Config.Channel == 2)){
+		return DISABLE;
+	}
+
+	/*
+	 * Delay 0 would mean CCRx = 0: PWM mode 2 is then active whenever CNT >= 0,
+	 * including while the timer sits stopped -> the output would never go idle.
+	 */
+	uint32_t delay = (OPM_Config.Delay == 0) ? 1U : OPM_Config.Delay;
+	uint32_t width = (OPM_Config.Width == 0) ? 1U : OPM_Config.Width;
+
+	/*
+	 * ARR = Delay + Width - 1 must fit the counter (64-bit sum: no uint32 wrap-around)
+	 * e.g. TIM3 (16-bit): Delay + Width <= 65536, otherwise ARR would be truncated
+	 */
+	if ((uint64_t)delay + width - 1U > TIM_GetArrMax(pTIMx)){
+		return DISABLE;
+	}
+	if (TIM_OPM_SetDoneCallback(pTIMx, OPM_Config.DoneCallback) != ENABLE){
+		return DISABLE;
+	}
+
+	/*
+	 * 1. Stop the counter, CR1:
+	 * bit 3 OPM:  counter stops at the next update event
+	 * bit 2 URS:  the EGR UG below does not count as "pulse done"
+	 * bit 7 ARPE: ARR preloaded
+	 */
+	CLEAR_BIT(pTIMx->CR1, 0);
+	pTIMx->SMCR &= ~((7U << 4) | (7U << 0));
+	pTIMx->CR1 |= (1U << 7) | (1U << 3) | (1U << 2);
+
+	// 2. Timing
+	pTIMx->PSC = OPM_Config.Prescaler;
+	pTIMx->ARR = delay + width - 1U;
+	(&pTIMx->CCR1)[OPM_Config.Channel - 1U] = delay; // CCR1..CCR4 are consecutive
+	TIM_OC_ConfigChannel(pTIMx, OPM_Config.Channel, TIM_PWM_MODE2, OPM_Config.Polarity, ENABLE);
+
+	// 3. Load PSC/ARR/CCR from their preload registers now, CNT = 0
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
+
+	// 4. External trigger: armed from now on, the hardware sets CEN on each edge
+	if (OPM_Config.Trigger != TIM_OPM_TRIG_SOFTWARE){
+		TIM_OPM_ConfigTrigger(pTIMx, OPM_Config.Trigger, OPM_Config.TriggerEdge);
+	}
+	return ENABLE;
+}
+
+void TIM_OPM_Trigger(TIM_RegDef_t *pTIMx){
+	if (!READ_BIT(pTIMx->CR1, 0)){
+		SET_BIT(pTIMx->CR1, 0);
+	}
+}
+
+uint8_t TIM_OPM_IsBusy(TIM_RegDef_t *pTIMx){
+	return READ_BIT(pTIMx->CR1, 0) ? 1 : 0;
+}
+
+uint8_t TIM_OPM_DelayUs(TIM_RegDef_t *pTIMx, uint32_t Us, TIM_OPM_Callback_t Callback){
+	if (TIM_GetDescriptor(pTIMx) == NULL || TIM_OPM_SetDoneCallback(pTIMx, Callback) != ENABLE){
+		return DISABLE;
+	}
+
+	uint32_t timer_clk = TIM_IsOnAPB2(pTIMx) ? RCC_GetTimerClock2() : RCC_GetTimerClock1();
+	uint64_t clocks = ((uint64_t)Us * timer_clk) / 1000000U;
+	uint64_t arr_max = TIM_GetArrMax(pTIMx);
+
+	/*
+	 * Smallest prescaler that makes the period fit: (PSC + 1) = ceil(clocks / (ARR_MAX + 1))
+	 * -> best resolution for this length
+	 */
+	uint64_t divider = (clocks + arr_max) / (arr_max + 1U);
+	if (divider == 0){
+		divider = 1;
+	}
+	if (divider > (TIM_PSC_MAX + 1U)){
+		divider = TIM_PSC_MAX + 1U; // longest possible delay
+	}
+	uint64_t period = clocks / divider;
+	if (period == 0){
+		period = 1;
+	}
+	if (period > arr_max + 1U){
+		period = arr_max + 1U;
+	}
+
+	// Same one-pulse machinery, but no output channel and no slave trigger
+	CLEAR_BIT(pTIMx->CR1, 0);
+	pTIMx->SMCR &= ~((7U << 4) | (7U << 0));
+	pTIMx->CCER = 0;
+	pTIMx->CR1 |= (1U << 7) | (1U << 3) | (1U << 2);
+
+	pTIMx->PSC = (uint32_t)(divider - 1U);
+	pTIMx->ARR = (uint32_t)(period - 1U);
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
+
+	SET_BIT(pTIMx->CR1, 0); // go: the counter stops by itself after one period
+	return ENABLE;
+}
+
+/*
+ * ==========================================
+ * Input Capture
+ * ==========================================
+ */
+
+/*
+ * Helper: DMA controller, stream and request channel of a capture channel (timer descriptor)
+ * Returns NULL if the channel has no DMA request.
+ */
+static DMA_RegDef_t *TIM_IC_GetDMA(TIM_RegDef_t *pTIMx, uint8_t Channel, uint8_t *pStream, uint8_t *pRequest){
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+
+	if (pDesc == NULL || pDesc->pDMAx == NULL || Channel > pDesc->Channels ||
+	    pDesc->DMAChannel[Channel - 1U].Stream == TIM_DMA_NONE){
+		return NULL;
+	}
+	*pStream = pDesc->DMAChannel[Channel - 1U].Stream;
+	*pRequest = pDesc->DMAChannel[Channel - 1U].Request;
+	return pDesc->pDMAx;
+}
+
+static void TIM_IC_SetCallback(TIM_RegDef_t *pTIMx, uint8_t Channel, TIM_IC_Callback_t Callback){
+	TIM_ICHooks_t *pHooks = NULL;
+
+	for (uint8_t i = 0; i < TIM_MAX_IC; i++){
+		if (ICHooks[i].pTIMx == pTIMx){
+			pHooks = &ICHooks[i];
+			break;
+		}
+		if (ICHooks[i].pTIMx == NULL && pHooks == NULL){
+			pHooks = &ICHooks[i];
+		}
+	}
+	if (pHooks == NULL){
+		return;
+	}
+	pHooks->pTIMx = pTIMx;
+	pHooks->Callback[Channel - 1U] = Callback;
+}
+
+/*
+ * Called from TIM_IRQHandling: one callback per pending capture.
+ * Reading CCRx clears CCxIF by itself. CCxOF (over-capture: an edge was lost because
+ * the previous timestamp was not read in time) is cleared and otherwise ignored.
+ */
+static void TIM_IC_IRQHandling(TIM_RegDef_t *pTIMx){
+	for (uint8_t i = 0; i < TIM_MAX_IC; i++){
+		if (ICHooks[i].pTIMx != pTIMx){
+			continue;
+		}
+		for (uint8_t ch = 1; ch <= 4; ch++){
+			TIM_IC_Callback_t callback = ICHooks[i].Callback[ch - 1U];
+
+			if (callback == NULL || !READ_BIT(pTIMx->SR, ch) || !READ_BIT(pTIMx->DIER, ch)){
+				continue;
+			}
+			uint32_t timestamp = (&pTIMx->CCR1)[ch - 1U];
+			pTIMx->SR = ~(1U << (ch + 8U));
+			callback(pTIMx, ch, timestamp);
+		}
+	}
+}
+
+void TIM_IC_Init(TIM_IC_Handle_t *pICHandle){
+	TIM_RegDef_t *pTIMx = pICHandle->pTIMx;
+	TIM_IC_Config_t IC_Config = pICHandle->IC_Config;
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+	uint8_t ch = IC_Config.Channel;
+
+	if (pDesc == NULL || ch < 1 || ch > pDesc->Channels){
+		return;
+	}
+	volatile uint32_t *pCCMR = (ch <= 2) ? &pTIMx->CCMR1 : &pTIMx->CCMR2;
+	uint8_t ccmr_shift = ((ch - 1U) & 1U) * 8U;
+	uint8_t ccer_shift = (ch - 1U) * 4U;
+
+	// 1. CCxS is only writable while the channel is off (CCxE = 0)
+	CLEAR_BIT(pTIMx->CCER, ccer_shift);
+	pTIMx->DIER &= ~((1U << ch) | (1U << (ch + 8U)));
+
+	/*
+	 * 2. CCMR, channel byte:
+	 * CCxS (1:0) = 01: input, ICx mapped on TIx (its own pin)
+	 * ICxPSC (3:2): capture every 1/2/4/8 events
+	 * ICxF (7:4): digital filter
+	 */
+	*pCCMR &= ~(0xFFU << ccmr_shift);
+	*pCCMR |= ((1U | ((IC_Config.Prescaler & 3U) << 2) | ((IC_Config.Filter & 0xFU) << 4)) << ccmr_shift);
+
+	/*
+	 * 3. CCER edge: CCxP (bit 1) / CCxNP (bit 3)
+	 * 00 rising, 01 falling, 11 both
+	 */
+	pTIMx->CCER &= ~(0xFU << ccer_shift);
+	if (IC_Config.Edge == TIM_IC_EDGE_FALLING){
+		SET_BIT(pTIMx->CCER, ccer_shift + 1U);
+	}else if (IC_Config.Edge == TIM_IC_EDGE_BOTH){
+		pTIMx->CCER |= (0xAU << ccer_shift); // CCxP | CCxNP
+	}
+
+	// 4. Clear stale CCxIF / CCxOF from a previous use of the channel
+	pTIMx->SR = ~((1U << ch) | (1U << (ch + 8U)));
+
+	// 5. Interrupt: DIER CCxIE (bit ch), on the capture vector (TIM1_CC / TIM8_CC on the advanced timers)
+	TIM_IC_SetCallback(pTIMx, ch, IC_Config.CaptureCallback);
+	if (IC_Config.CaptureCallback != NULL && TIM_GetIRQNumber(pTIMx) != TIM_IRQ_NONE){
+		SET_BIT(pTIMx->DIER, ch);
+		NVIC_ISER_Config(pDesc->CCIRQNumber);
+	}
+
+	// 6. DMA: each capture raises a request, the stream copies CCRx into the next buffer word
+	uint8_t stream, request;
+	DMA_RegDef_t *pDMAx = TIM_IC_GetDMA(pTIMx, ch, &stream, &request);
+	if (IC_Config.pBuffer != NULL && IC_Config.BufferLength != 0 && pDMAx != NULL){
+		DMA_Handle_t DMAHandle;
+
+		DMAHandle.pDMAx = pDMAx;
+		DMAHandle.DMA_Config.Stream = stream;
+		DMAHandle.DMA_Config.Channel = request;
+		DMAHandle.DMA_Config.Direction = DMA_DIR_PERIPH_TO_MEM;
+		DMAHandle.DMA_Config.DataSize = DMA_SIZE_WORD;   // upper half reads 0 on 16-bit timers
+		DMAHandle.DMA_Config.MemIncrement = ENABLE;
+		DMAHandle.DMA_Config.Circular = IC_Config.Circular;
+		DMAHandle.DMA_Config.Priority = DMA_PRIORITY_HIGH;
+		DMAHandle.DMA_Config.PeriphAddr = (uint32_t)&(&pTIMx->CCR1)[ch - 1U];
+		DMAHandle.DMA_Config.MemAddr = (uint32_t)IC_Config.pBuffer;
+		DMAHandle.DMA_Config.Count = IC_Config.BufferLength;
+		DMAHandle.DMA_Config.HalfCallback = NULL;
+		DMAHandle.DMA_Config.CompleteCallback = IC_Config.BufferCallback;
+
+		DMA_Init(&DMAHandle);
+		DMA_Start(pDMAx, stream);
+		SET_BIT(pTIMx->DIER, ch + 8U); // CCxDE
+	}
+
+	// 7. Channel on
+	SET_BIT(pTIMx->CCER, ccer_shift);
+
+	// 8. Counter not running yet: free-run over the full range
+	if (!READ_BIT(pTIMx->CR1, 0)){
+		pTIMx->ARR = TIM_GetArrMax(pTIMx);
+		SET_BIT(pTIMx->EGR, 0);
+		pTIMx->SR = ~(1U << 0);
+		SET_BIT(pTIMx->CR1, 0);
+	}
+}
+
+void TIM_IC_Stop(TIM_RegDef_t *pTIMx, uint8_t Channel){
+	uint8_t stream, request;
+	DMA_RegDef_t *pDMAx;
+
+	if (Channel < 1 || Channel > 4){
+		return;
+	}
+	CLEAR_BIT(pTIMx->CCER, (Channel - 1U) * 4U);
+	pDMAx = TIM_IC_GetDMA(pTIMx, Channel, &stream, &request);
+	if (READ_BIT(pTIMx->DIER, Channel + 8U) && pDMAx != NULL){
+		DMA_Stop(pDMAx, stream);
+	}
+	pTIMx->DIER &= ~((1U << Channel) | (1U << (Channel + 8U)));
+	TIM_IC_SetCallback(pTIMx, Channel, NULL);
+}
+
+uint16_t TIM_IC_GetBufferCount(TIM_IC_Handle_t *pICHandle){
+	uint8_t stream, request;
+	TIM_IC_Config_t *pConfig = &pICHandle->IC_Config;
+	DMA_RegDef_t *pDMAx;
+
+	if (pConfig->Channel < 1 || pConfig->Channel > 4){
+		return 0;
+	}
+	pDMAx = TIM_IC_GetDMA(pICHandle->pTIMx, pConfig->Channel, &stream, &request);
+	if (pDMAx == NULL){
+		return 0;
+	}
+	return pConfig->BufferLength - DMA_GetRemaining(pDMAx, stream);
+}
+
+uint32_t TIM_IC_Delta(TIM_RegDef_t *pTIMx, uint32_t Older, uint32_t Newer){
+	uint32_t arr = pTIMx->ARR;
+
+	if (arr == TIM_ARR_MAX_32BIT || Newer >= Older){
+		return Newer - Older; // unsigned subtraction wraps at 2^32 by itself
+	}
+	return (arr + 1U) - Older + Newer;
+}
+
+/*
+ * ==========================================
+ * DMA Waveform Playback
+ * ==========================================
+ */
+#define TIM_WAVEFORM_UP_STREAM          1   // DMA1 Stream 1 channel 3: TIM2_UP
+#define TIM_WAVEFORM_UP_REQUEST         3
+#define TIM_WAVEFORM_DIV_STREAM         6   // DMA1 Stream 6 channel 2: TIM4_UP
+#define TIM_WAVEFORM_DIV_REQUEST        2
+#define TIM_WAVEFORM_DIV_TIM            TIM4
+#define TIM_DCR_DBA_CCR1                13  // CCR1 offset 0x34 / 4
+
+static uint8_t WaveformDivider;     // 1 while TIM4 is used as the sample divider
+
+uint8_t TIM_Waveform_Start(TIM_Waveform_Handle_t *pWaveformHandle){
+	TIM_RegDef_t *pTIMx = pWaveformHandle->pTIMx;
+	TIM_Waveform_Config_t Waveform_Config = pWaveformHandle->Waveform_Config;
+	uint16_t updates = (Waveform_Config.UpdatesPerSample == 0) ? 1U : Waveform_Config.UpdatesPerSample;
+
+	if (pTIMx != TIM2 || Waveform_Config.pTable == NULL || Waveform_Config.Length == 0 ||
+	    Waveform_Config.Channels < 1 || Waveform_Config.Channels > TIM_CHANNELS ||
+	    (Waveform_Config.Channels > 1 && updates > 1) ||
+	    ((uint32_t)Waveform_Config.Length * Waveform_Config.Channels) > 0xFFFFU){
+		return DISABLE;
+	}
+
+	TIM_Waveform_Stop(pTIMx);
+
+	DMA_Handle_t DMAHandle;
+	DMAHandle.pDMAx = DMA1;
+	DMAHandle.DMA_Config.Direction = DMA_DIR_MEM_TO_PERIPH;
+	DMAHandle.DMA_Config.DataSize = DMA_SIZE_WORD;
+	DMAHandle.DMA_Config.MemIncrement = ENABLE;
+	DMAHandle.DMA_Config.Circular = Waveform_Config.Circular;
+	DMAHandle.DMA_Config.Priority = DMA_PRIORITY_HIGH;
+	DMAHandle.DMA_Config.MemAddr = (uint32_t)Waveform_Config.pTable;
+	DMAHandle.DMA_Config.Count = Waveform_Config.Length * Waveform_Config.Channels;
+	DMAHandle.DMA_Config.HalfCallback = Waveform_Config.HalfCallback;
+	DMAHandle.DMA_Config.CompleteCallback = Waveform_Config.CompleteCallback;
+
+	if (updates == 1){
+		/*
+		 * Every TIM2 update requests the DMA.
+		 * One channel: write CCR1 directly.
+		 * Several: write DMAR, the timer turns ONE request into a burst of
+		 * DBL + 1 transfers to DBA, DBA + 1, ... (CCR1, CCR2, ...)
+		 */
+		DMAHandle.DMA_Config.Stream = TIM_WAVEFORM_UP_STREAM;
+		DMAHandle.DMA_Config.Channel = TIM_WAVEFORM_UP_REQUEST;
+		if (Waveform_Config.Channels == 1){
+			DMAHandle.DMA_Config.PeriphAddr = (uint32_t)&pTIMx->CCR1;
+		}else{
+			pTIMx->DCR = ((uint32_t)(Waveform_Config.Channels - 1U) << 8) | TIM_DCR_DBA_CCR1;
+			DMAHandle.DMA_Config.PeriphAddr = (uint32_t)&pTIMx->DMAR;
+		}
+		DMA_Init(&DMAHandle);
+		DMA_Start(DMA1, TIM_WAVEFORM_UP_STREAM);
+
+		SET_BIT(pTIMx->DIER, 8); // UDE: update DMA request enable
+		return ENABLE;
+	}
+
+	/*
+	 * UpdatesPerSample > 1: TIM4 as a divider of TIM2 update events
+	 * TIM2 CR2 MMS (6:4) = 010: TRGO = update event
+	 * TIM4 SMCR TS (6:4) = 001: trigger input = ITR1 (= TIM2 TRGO for TIM4)
+	 *           SMS (2:0) = 111: external clock mode 1, every TRGO pulse counts once
+	 * TIM4 ARR = N - 1 -> TIM4 update (and its DMA request) every N TIM2 periods.
+	 */
+	TIM_RegDef_t *pDIVx = TIM_WAVEFORM_DIV_TIM;
+
+	TIM_PeriClockControl(pDIVx, ENABLE);
+	WaveformDivider = 1;
+
+	pTIMx->CR2 = (pTIMx->CR2 & ~(7U << 4)) | (2U << 4);
+
+	pDIVx->CR1 = 0;
+	pDIVx->DIER = 0;
+	pDIVx->PSC = 0;
+	pDIVx->ARR = updates - 1U;
+	pDIVx->SMCR = (1U << 4) | (7U << 0);
+	SET_BIT(pDIVx->EGR, 0);   // load PSC, CNT = 0 (UDE still off: no DMA request for this one)
+	pDIVx->SR = 0;
+
+	DMAHandle.DMA_Config.Stream = TIM_WAVEFORM_DIV_STREAM;
+	DMAHandle.DMA_Config.Channel = TIM_WAVEFORM_DIV_REQUEST;
+	DMAHandle.DMA_Config.PeriphAddr = (uint32_t)&pTIMx->CCR1;
+	DMA_Init(&DMAHandle);
+	DMA_Start(DMA1, TIM_WAVEFORM_DIV_STREAM);
+
+	SET_BIT(pDIVx->DIER, 8);  // UDE
+	SET_BIT(pDIVx->CR1, 0);   // CEN: counts TIM2 updates from now on
+	return ENABLE;
+}
+
+void TIM_Waveform_Stop(TIM_RegDef_t *pTIMx){
+	if (pTIMx != TIM2){
+		return;
+	}
+	if (READ_BIT(pTIMx->DIER, 8)){
+		CLEAR_BIT(pTIMx->DIER, 8);
+		DMA_Stop(DMA1, TIM_WAVEFORM_UP_STREAM);
+		pTIMx->DCR = 0;
+	}
+
+	if (WaveformDivider){
+		TIM_RegDef_t *pDIVx = TIM_WAVEFORM_DIV_TIM;
+
+		pDIVx->CR1 = 0;
+		pDIVx->DIER = 0;
+		pDIVx->SMCR = 0;
+		DMA_Stop(DMA1, TIM_WAVEFORM_DIV_STREAM);
+		pTIMx->CR2 &= ~(7U << 4);
+		TIM_PeriClockControl(pDIVx, DISABLE);
+		WaveformDivider = 0;
+	}
+}
+
+/*
+ * ==========================================
+ * Complementary PWM (TIM1 / TIM8)
+ * ==========================================
+ */
+#define TIM_BDTR_MOE            15
+#define TIM_BDTR_AOE            14
+#define TIM_BDTR_BKP            13
+#define TIM_BDTR_BKE            12
+#define TIM_BDTR_OSSR           11
+#define TIM_BDTR_OSSI           10
+#define TIM_DTG_INVALID         0xFFFFU
+
+static TIM_Break_Callback_t BreakCallbacks[2]; // [0] = TIM1, [1] = TIM8
+
+/*
+ * Helper: dead-time clocks -> DTG (RM0390 16.4.18), rounded up.
+ *   DTG[7:5] = 0xx: DT =       DTG[6:0]  x tDTS         0 ..  127
+ *   DTG[7:5] = 10x: DT = (64 + DTG[5:0]) x 2 tDTS     128 ..  254
+ *   DTG[7:5] = 110: DT = (32 + DTG[4:0]) x 8 tDTS     256 ..  504
+ *   DTG[7:5] = 111: DT = (32 + DTG[4:0]) x 16 tDTS    512 .. 1008
+ * Returns TIM_DTG_INVALID if Clocks > 1008.
+ */
+static uint16_t TIM_CPWM_EncodeDTG(uint32_t Clocks){
+	if (Clocks <= 127U){
+		return (uint16_t)Clocks;
+	}
+	if (Clocks <= 254U){
+		return (uint16_t)(0x80U | (((Clocks + 1U) / 2U) - 64U));
+	}
+	if (Clocks <= 504U){
+		return (uint16_t)(0xC0U | (((Clocks + 7U) / 8U) - 32U));
+	}
+	if (Clocks <= 1008U){
+		return (uint16_t)(0xE0U | (((Clocks + 15U) / 16U) - 32U));
+	}
+	return TIM_DTG_INVALID;
+}
+
+/*
+ * Helper: dead-time in ns -> DTG, with the smallest CR1 CKD (tDTS = 1, 2 or 4 timer clocks)
+ * that makes it fit: the finest resolution for this length.
+ * Returns TIM_DTG_INVALID if even CKD = 4 is not enough.
+ */
+static uint16_t TIM_CPWM_CalcDeadTime(uint32_t DeadTimeNs, uint8_t *pCKD){
+	// TIM1 and TIM8 both run on TIMCLK2
+	uint64_t clocks = ((uint64_t)DeadTimeNs * RCC_GetTimerClock2() + 999999999U) / 1000000000U;
+
+	for (uint8_t ckd = 0; ckd <= 2; ckd++){
+		uint32_t divider = 1UL << ckd;
+		uint64_t dts = (clocks + divider - 1U) / divider;
+
+		if (dts <= 1008U){
+			*pCKD = ckd;
+			return TIM_CPWM_EncodeDTG((uint32_t)dts);
+		}
+	}
+	return TIM_DTG_INVALID;
+}
+
+static int8_t TIM_CPWM_Index(TIM_RegDef_t *pTIMx){
+	if (pTIMx == TIM1){
+		return 0;
+	}
+	if (pTIMx == TIM8){
+		return 1;
+	}
+	return -1;
+}
+
+uint8_t TIM_CPWM_Init(TIM_CPWM_Handle_t *pCPWMHandle){
+	TIM_RegDef_t *pTIMx = pCPWMHandle->pTIMx;
+	TIM_CPWM_Config_t *pConfig = &pCPWMHandle->CPWM_Config;
+	int8_t index = TIM_CPWM_Index(pTIMx);
+	uint8_t ckd = 0;
+
+	if (index < 0 || (pTIMx->BDTR & (3U << 8)) != 0){
+		return DISABLE;
+	}
+	uint16_t dtg = TIM_CPWM_CalcDeadTime(pConfig->DeadTimeNs, &ckd);
+	if (dtg == TIM_DTG_INVALID){
+		return DISABLE;
+	}
+
+	// 1. Outputs off, counter stopped while everything is rewired
+	CLEAR_BIT(pTIMx->BDTR, TIM_BDTR_MOE);
+	CLEAR_BIT(pTIMx->CR1, 0);
+
+	/*
+	 * 2. CR1 CKD (9:8): dead-time clock tDTS = (1 << CKD) timer clocks
+	 *    CR2 OISx (bit 8 + 2(x-1)) / OISxN (bit 9 + 2(x-1)): output levels while MOE = 0
+	 */
+	pTIMx->CR1 = (pTIMx->CR1 & ~(3U << 8)) | ((uint32_t)ckd << 8);
+	pTIMx->CR2 &= ~(0x3FU << 8);
+	for (uint8_t ch = 0; ch < TIM_CPWM_CHANNELS; ch++){
+		if (pConfig->Complementary[ch].IdleState){
+			SET_BIT(pTIMx->CR2, 8U + 2U * ch);
+		}
+		if (pConfig->Complementary[ch].IdleStateN){
+			SET_BIT(pTIMx->CR2, 9U + 2U * ch);
+		}
+	}
+
+	// 3. RCR is preloaded: the UG inside TIM_PWM_Init loads it
+	pTIMx->RCR = pConfig->RepetitionCounter;
+
+	// 4. PSC, ARR, CHx side of every channel, UG, CEN: same as every other PWM timer
+	TIM_Handle_t base;
+	base.pTIMx = pTIMx;
+	base.TIM_Config = pConfig->Base;
+	TIM_PWM_Init(&base);
+
+	/*
+	 * 5. CHxN side: CCER CCxNE (bit 2) / CCxNP (bit 3) of each 4-bit channel field
+	 * (after TIM_PWM_Init, which rewrites the whole field of an enabled channel)
+	 */
+	for (uint8_t ch = 0; ch < TIM_CPWM_CHANNELS; ch++){
+		TIM_CPWMChannel_t *pChannel = &pConfig->Complementary[ch];
+		uint8_t shift = ch * 4U;
+
+		pTIMx->CCER &= ~(0xCU << shift);
+		if (pChannel->Enable != ENABLE){
+			continue;
+		}
+		if (pChannel->Polarity == TIM_OC_POL_LOW){
+			SET_BIT(pTIMx->CCER, shift + 3U);
+		}
+		SET_BIT(pTIMx->CCER, shift + 2U);
+	}
+
+	/*
+	 * 6. BDTR in ONE write: with a lock level, the first write is also the last.
+	 * OSSR = 1: a disabled output (CCxE = 0) is driven to its inactive level instead of floating
+	 * OSSI = 1: while MOE = 0, the outputs are driven to their idle level (OISx) instead of floating
+	 * MOE stays 0.
+	 */
+	uint32_t bdtr = dtg | (1U << TIM_BDTR_OSSR) | (1U << TIM_BDTR_OSSI) | ((uint32_t)(pConfig->LockLevel & 3U) << 8);
+	if (pConfig->Break != TIM_BREAK_DISABLE){
+		bdtr |= (1U << TIM_BDTR_BKE);
+		if (pConfig->Break == TIM_BREAK_ACTIVE_HIGH){
+			bdtr |= (1U << TIM_BDTR_BKP);
+		}
+	}
+	if (pConfig->AutomaticOutput == ENABLE){
+		bdtr |= (1U << TIM_BDTR_AOE);
+	}
+	pTIMx->BDTR = bdtr;
+
+	/*
+	 * 7. Break interrupt (DIER bit 7 BIE), only to report it: the outputs are already off
+	 * by the time it runs. SR bit 7 BIF may be set by a break during init: drop it.
+	 */
+	BreakCallbacks[index] = pConfig->BreakCallback;
+	pTIMx->SR = ~(1U << 7);
+	if (pConfig->Break != TIM_BREAK_DISABLE && pConfig->BreakCallback != NULL){
+		SET_BIT(pTIMx->DIER, 7);
+		NVIC_ISER_Config((pTIMx == TIM1) ? TIM1_BRK_TIM9_IRQ : TIM8_BRK_TIM12_IRQ);
+	}else{
+		CLEAR_BIT(pTIMx->DIER, 7);
+	}
+
+	return ENABLE;
+}
+
+void TIM_CPWM_OutputControl(TIM_RegDef_t *pTIMx, uint8_t EnableOrDisable){
+	if (TIM_CPWM_Index(pTIMx) < 0){
+		return;
+	}
+	if (EnableOrDisable == ENABLE){
+		SET_BIT(pTIMx->BDTR, TIM_BDTR_MOE);
+		if (BreakCallbacks[TIM_CPWM_Index(pTIMx)] != NULL && READ_BIT(pTIMx->BDTR, TIM_BDTR_BKE)){
+			pTIMx->SR = ~(1U << 7);
+			SET_BIT(pTIMx->DIER, 7); // re-arm the break report (see TIM_CPWM_BreakIRQHandling)
+		}
+	}else if (EnableOrDisable == DISABLE){
+		CLEAR_BIT(pTIMx->BDTR, TIM_BDTR_MOE);
+	}
+}
+
+uint8_t TIM_CPWM_IsOutputEnabled(TIM_RegDef_t *pTIMx){
+	if (TIM_CPWM_Index(pTIMx) < 0){
+		return 0;
+	}
+	return READ_BIT(pTIMx->BDTR, TIM_BDTR_MOE) ? 1 : 0;
+}
+
+uint8_t TIM_CPWM_SetDeadTime(TIM_RegDef_t *pTIMx, uint32_t DeadTimeNs){
+	uint8_t ckd = 0;
+
+	if (TIM_CPWM_Index(pTIMx) < 0 || (pTIMx->BDTR & (3U << 8)) != 0 || READ_BIT(pTIMx->BDTR, TIM_BDTR_MOE)){
+		return DISABLE;
+	}
+	uint16_t dtg = TIM_CPWM_CalcDeadTime(DeadTimeNs, &ckd);
+	if (dtg == TIM_DTG_INVALID){
+		return DISABLE;
+	}
+	pTIMx->CR1 = (pTIMx->CR1 & ~(3U << 8)) | ((uint32_t)ckd << 8);
+	pTIMx->BDTR = (pTIMx->BDTR & ~0xFFU) | dtg;
+	return ENABLE;
+}
+
+/*
+ * Break interrupt: vector shared with TIM9 / TIM12, whose update and capture
+ * interrupts (enabled through the descriptor table) are served here too.
+ * BIF (SR bit 7) cannot be cleared while the break input is still active, so the
+ * interrupt would fire again and again: report once, then mask BIE until
+ * TIM_CPWM_OutputControl(ENABLE) re-arms it.
+ */
+static void TIM_CPWM_BreakIRQHandling(TIM_RegDef_t *pTIMx, uint8_t Index){
+	if (READ_BIT(pTIMx->SR, 7) && READ_BIT(pTIMx->DIER, 7)){
+		CLEAR_BIT(pTIMx->DIER, 7);
+		pTIMx->SR = ~(1U << 7);
+		if (BreakCallbacks[Index] != NULL){
+			BreakCallbacks[Index](pTIMx);
+		}
+	}
+}
+
+void TIM1_BRK_TIM9_IRQHandler(void){
+	TIM_CPWM_BreakIRQHandling(TIM1, 0);
+	TIM_IRQHandling(TIM9);
+}
+
+void TIM8_BRK_TIM12_IRQHandler(void){
+	TIM_CPWM_BreakIRQHandling(TIM8, 1);
+	TIM_IRQHandling(TIM12);
+}
+
+/*
+ * ==========================================
+ * Timer Synchronization
+ * ==========================================
+ */
+
+/*
+ * Internal trigger connections (RM0390 17.4.3 / 16.4.3, TIMx internal trigger connection):
+ * ITRx of the slave = TRGO of SyncITR[slave][x]
+ */
+typedef struct{
+	TIM_RegDef_t *pSlave;
+	TIM_RegDef_t *pITR[4];          // ITR0 .. ITR3
+} TIM_SyncITR_t;
+
+static const TIM_SyncITR_t SyncITR[] = {
+	{ TIM1, { TIM5, TIM2, TIM3, TIM4 } },
+	{ TIM8, { TIM1, TIM2, TIM4, TIM5 } },
+	{ TIM2, { TIM1, TIM8, TIM3, TIM4 } },
+	{ TIM3, { TIM1, TIM2, TIM5, TIM4 } },
+	{ TIM4, { TIM1, TIM2, TIM3, TIM8 } },
+	{ TIM5, { TIM2, TIM3, TIM4, TIM8 } },
+};
+
+/*
+ * Helper: ITR number of pMaster's TRGO at pSlave, 0xFF if they are not wired together
+ */
+static uint8_t TIM_Sync_GetITR(TIM_RegDef_t *pSlave, TIM_RegDef_t *pMaster){
+	for (uint8_t i = 0; i < sizeof(SyncITR) / sizeof(SyncITR[0]); i++){
+		if (SyncITR[i].pSlave != pSlave){
+			continue;
+		}
+		for (uint8_t itr = 0; itr < 4; itr++){
+			if (SyncITR[i].pITR[itr] == pMaster){
+				return itr;
+			}
+		}
+		break;
+	}
+	return 0xFF;
+}
+
+void TIM_Sync_SetMasterOutput(TIM_RegDef_t *pMaster, uint8_t Trgo){
+	// CR2 MMS (6:4)
+	pMaster->CR2 = (pMaster->CR2 & ~(7U << 4)) | ((uint32_t)(Trgo & 7U) << 4);
+}
+
+uint8_t TIM_Sync_SetSlaveMode(TIM_RegDef_t *pSlave, TIM_RegDef_t *pMaster, uint8_t Mode){
+	uint8_t itr = TIM_Sync_GetITR(pSlave, pMaster);
+
+	if (itr == 0xFF){
+		return DISABLE;
+	}
+	/*
+	 * SMCR TS (6:4) = 000-011: ITR0-ITR3, SMS (2:0) = mode
+	 * SMS is cleared first: TS must not change while a slave mode is active.
+	 */
+	pSlave->SMCR &= ~(7U << 0);
+	pSlave->SMCR = (pSlave->SMCR & ~(7U << 4)) | ((uint32_t)itr << 4);
+	pSlave->SMCR |= (uint32_t)(Mode & 7U);
+	return ENABLE;
+}
+
+/*
+ * Helper: pTIMx is the master or a slave of a remembered sync group
+ */
+static uint8_t TIM_Sync_IsMember(TIM_RegDef_t *pTIMx){
+	for (uint8_t i = 0; i < TIM_MAX_SYNC_GROUPS; i++){
+		const TIM_Sync_Handle_t *pGroup = SyncGroups[i];
+		if (pGroup == NULL){
+			continue;
+		}
+		if (pGroup->pMaster == pTIMx){
+			return 1;
+		}
+		for (uint8_t j = 0; j < pGroup->SlaveCount; j++){
+			if (pGroup->Slaves[j].pTIMx == pTIMx){
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Helper: remember the group for TIM_ClockChangeCallback (same handle: no new slot)
+ */
+static uint8_t TIM_Sync_Remember(TIM_Sync_Handle_t *pSyncHandle){
+	uint8_t free_slot = TIM_MAX_SYNC_GROUPS;
+
+	for (uint8_t i = 0; i < TIM_MAX_SYNC_GROUPS; i++){
+		if (SyncGroups[i] == pSyncHandle){
+			return ENABLE;
+		}
+		if (SyncGroups[i] == NULL && free_slot == TIM_MAX_SYNC_GROUPS){
+			free_slot = i;
+		}
+	}
+	if (free_slot == TIM_MAX_SYNC_GROUPS){
+		return DISABLE;
+	}
+	SyncGroups[free_slot] = pSyncHandle;
+	return ENABLE;
+}
+
+uint8_t TIM_Sync_Start(TIM_Sync_Handle_t *pSyncHandle){
+	TIM_RegDef_t *pMaster = pSyncHandle->pMaster;
+
+	if (pSyncHandle->SlaveCount == 0 || pSyncHandle->SlaveCount > TIM_SYNC_MAX_SLAVES){
+		return DISABLE;
+	}
+	for (uint8_t i = 0; i < pSyncHandle->SlaveCount; i++){
+		if (TIM_Sync_GetITR(pSyncHandle->Slaves[i].pTIMx, pMaster) == 0xFF){
+			return DISABLE;
+		}
+	}
+	if (TIM_Sync_Remember(pSyncHandle) != ENABLE){
+		return DISABLE;
+	}
+
+	// 1. Everyone stopped
+	CLEAR_BIT(pMaster->CR1, 0);
+	for (uint8_t i = 0; i < pSyncHandle->SlaveCount; i++){
+		CLEAR_BIT(pSyncHandle->Slaves[i].pTIMx->CR1, 0);
+	}
+
+	/*
+	 * 2. Master: TRGO = CEN, MSM (SMCR bit 7) = 1
+	 * TRGO = CEN first: with CEN = 0 it stays low, so the UGs below cannot pulse it.
+	 * UG on every timer: preloaded PSC/ARR/CCRx take effect now (e.g. a PSC re-tuned
+	 * by TIM_ClockChangeCallback), so the whole group starts with the same divider.
+	 */
+	TIM_Sync_SetMasterOutput(pMaster, TIM_TRGO_ENABLE);
+	SET_BIT(pMaster->SMCR, 7);
+	TIM_ForceReload(pMaster);
+	for (uint8_t i = 0; i < pSyncHandle->SlaveCount; i++){
+		TIM_ForceReload(pSyncHandle->Slaves[i].pTIMx);
+	}
+	pMaster->CNT = 0;
+
+	/*
+	 * 3. Slaves: trigger mode on the master's TRGO, CNT = phase offset
+	 * SR bit 6 TIF: drop a stale trigger flag so nothing reacts to an old edge.
+	 */
+	for (uint8_t i = 0; i < pSyncHandle->SlaveCount; i++){
+		TIM_RegDef_t *pSlave = pSyncHandle->Slaves[i].pTIMx;
+
+		TIM_Sync_SetSlaveMode(pSlave, pMaster, TIM_SLAVE_TRIGGER);
+		pSlave->CNT = pSyncHandle->Slaves[i].PhaseOffset;
+		pSlave->SR = ~(1U << 6);
+	}
+
+	// 4. Go: the rising edge of the master's CEN starts every slave in hardware
+	SET_BIT(pMaster->CR1, 0);
+	return ENABLE;
+}
+
+/*
+ * ==========================================
+ * Quadrature Encoder Interface
+ * ==========================================
+ */
+
+/*
+ * Encoders with an index pulse: the capture callback only gets pTIMx,
+ * this finds the handle (and its pending index correction) again.
+ */
+typedef struct{
+	TIM_Encoder_Handle_t *pHandle;
+	volatile uint32_t IndexAdjust;  // counts removed from CNT by index resets since the last sample
+} TIM_EncoderIndex_t;
+
+static TIM_EncoderIndex_t EncoderIndex[TIM_MAX_ENCODERS];
+
+static TIM_EncoderIndex_t *TIM_Encoder_FindIndex(TIM_RegDef_t *pTIMx){
+	for (uint8_t i = 0; i < TIM_MAX_ENCODERS; i++){
+		if (EncoderIndex[i].pHandle != NULL && EncoderIndex[i].pHandle->pTIMx == pTIMx){
+			return &EncoderIndex[i];
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Helper: counter period (ARR + 1) arithmetic without overflowing on 32-bit timers
+ * Returns Diff mod (ARR + 1) as a signed value in -period/2 .. period/2.
+ * Diff is signed 64-bit: a backwards move plus an index correction can be negative
+ * and, on a 32-bit timer, exceed the int32_t range before the wrap.
+ */
+static int32_t TIM_Encoder_Wrap(int64_t Diff, uint32_t Arr){
+	if (Arr == 0xFFFFFFFFU){
+		return (int32_t)(uint32_t)Diff; // mod 2^32, read back as signed
+	}
+	int64_t period = (int64_t)Arr + 1;
+	int64_t wrapped = ((Diff % period) + period) % period; // 0 .. period - 1, also for Diff < 0
+
+	return (int32_t)((wrapped > period / 2) ? (wrapped - period) : wrapped);
+}
+
+/*
+ * Index edge (CH3 capture, timer interrupt): CNT -= captured count (mod ARR + 1)
+ * The counts made between the edge and now stay in CNT.
+ */
+static void TIM_Encoder_IndexHook(TIM_RegDef_t *pTIMx, uint8_t Channel, uint32_t Timestamp){
+	TIM_EncoderIndex_t *pIndex = TIM_Encoder_FindIndex(pTIMx);
+	uint32_t arr = pTIMx->ARR;
+	uint32_t cnt = pTIMx->CNT;
+	(void)Channel;
+
+	pTIMx->CNT = (cnt >= Timestamp) ? (cnt - Timestamp) : (cnt + (arr - Timestamp) + 1U);
+	if (pIndex != NULL){
+		pIndex->IndexAdjust += Timestamp;
+	}
+}
+
+void TIM_Encoder_Init(TIM_Encoder_Handle_t *pEncoderHandle){
+	TIM_RegDef_t *pTIMx = pEncoderHandle->pTIMx;
+	TIM_Encoder_Config_t Encoder_Config = pEncoderHandle->Encoder_Config;
+	uint8_t filter = Encoder_Config.Filter & 0xFU;
+
+	if (Encoder_Config.Mode < TIM_ENCODER_MODE_TI1 || Encoder_Config.Mode > TIM_ENCODER_MODE_TI12){
+		return;
+	}
+
+	// 1. Counter stopped, CH1/CH2 off (CCxS is only writable while CCxE = 0)
+	CLEAR_BIT(pTIMx->CR1, 0);
+	pTIMx->CCER &= ~0xFFU;
+
+	/*
+	 * 2. CCMR1: CC1S = 01 (IC1 = TI1), CC2S = 01 (IC2 = TI2), IC1F / IC2F = filter
+	 * CCER: CC1P / CC2P = 0 (non-inverted), CC2P = 1 swaps the direction
+	 */
+	pTIMx->CCMR1 = (1U << 0) | ((uint32_t)filter << 4) | (1U << 8) | ((uint32_t)filter << 12);
+	if (Encoder_Config.InvertB == ENABLE){
+		SET_BIT(pTIMx->CCER, 5);
+	}
+
+	// 3. SMCR SMS (2:0) = encoder mode, no trigger selection needed
+	pTIMx->SMCR = (pTIMx->SMCR & ~((7U << 4) | (7U << 0))) | Encoder_Config.Mode;
+
+	// 4. Range, start from 0
+	pTIMx->PSC = 0;
+	pTIMx->ARR = (Encoder_Config.Period != 0) ? Encoder_Config.Period : TIM_GetArrMax(pTIMx);
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
+	pTIMx->CNT = 0;
+
+	pEncoderHandle->Position = 0;
+	pEncoderHandle->Velocity = 0;
+	pEncoderHandle->LastCount = 0;
+
+	SET_BIT(pTIMx->CR1, 0);
+
+	// 5. Index pulse: input capture on CH3 (the counter already runs, TIM_IC_Init leaves it alone)
+	if (Encoder_Config.IndexReset == ENABLE){
+		TIM_EncoderIndex_t *pIndex = TIM_Encoder_FindIndex(pTIMx);
+
+		for (uint8_t i = 0; i < TIM_MAX_ENCODERS && pIndex == NULL; i++){
+			if (EncoderIndex[i].pHandle == NULL){
+				pIndex = &EncoderIndex[i];
+			}
+		}
+		if (pIndex == NULL){
+			return; // table full: counts without the index
+		}
+		pIndex->pHandle = pEncoderHandle;
+		pIndex->IndexAdjust = 0;
+
+		TIM_IC_Handle_t IndexHandle = {0};
+		IndexHandle.pTIMx = pTIMx;
+		IndexHandle.IC_Config.Channel = 3;
+		IndexHandle.IC_Config.Edge = TIM_IC_EDGE_RISING;
+		IndexHandle.IC_Config.Prescaler = TIM_IC_PSC_DIV1;
+		IndexHandle.IC_Config.Filter = filter;
+		IndexHandle.IC_Config.CaptureCallback = TIM_Encoder_IndexHook;
+		TIM_IC_Init(&IndexHandle);
+	}
+}
+
+uint32_t TIM_Encoder_GetCount(TIM_RegDef_t *pTIMx){
+	return pTIMx->CNT;
+}
+
+uint8_t TIM_Encoder_GetDirection(TIM_RegDef_t *pTIMx){
+	return READ_BIT(pTIMx->CR1, 4) ? 1 : 0;
+}
+
+void TIM_Encoder_Sample(TIM_Encoder_Handle_t *pEncoderHandle){
+	TIM_RegDef_t *pTIMx = pEncoderHandle->pTIMx;
+	TIM_EncoderIndex_t *pIndex = TIM_Encoder_FindIndex(pTIMx);
+	uint32_t adjust = 0;
+	uint32_t primask;
+
+	/*
+	 * CNT and the index correction must be read together: an index interrupt in between
+	 * would count its correction twice or not at all.
+	 */
+	__asm volatile ("mrs %0, primask" : "=r" (primask));
+	__asm volatile ("cpsid i" : : : "memory");
+	uint32_t count = pTIMx->CNT;
+	if (pIndex != NULL){
+		adjust = pIndex->IndexAdjust;
+		pIndex->IndexAdjust = 0;
+	}
+	__asm volatile ("msr primask, %0" : : "r" (primask) : "memory");
+
+	/*
+	 * The index reset moved CNT back by 'adjust' counts without the shaft moving:
+	 * add them back to get the real motion.
+	 */
+	int32_t delta = TIM_Encoder_Wrap((int64_t)count - (int64_t)pEncoderHandle->LastCount + (int64_t)adjust,
+	                                 pTIMx->ARR);
+
+	pEncoderHandle->LastCount = count;
+	pEncoderHandle->Position += delta;
+	pEncoderHandle->Velocity = delta * (int32_t)pEncoderHandle->Encoder_Config.SampleHz;
+}
+
+/*
+ * ==========================================
+ * Output-Compare Toggle (Tone Generator)
+ * ==========================================
+ */
+
+/*
+ * Handles with a sequence: the update callback only gets pTIMx
+ */
+static TIM_Tone_Handle_t *volatile TonePlayers[TIM_MAX_TONE];
+
+/*
+ * Helper: OCxM only, CCxE / polarity / preload untouched (used from the interrupt)
+ */
+static void TIM_OC_SetMode(TIM_RegDef_t *pTIMx, uint8_t Channel, uint8_t Mode){
+	volatile uint32_t *pCCMR = (Channel <= 2) ? &pTIMx->CCMR1 : &pTIMx->CCMR2;
+	uint8_t shift = ((Channel - 1U) & 1U) * 8U + 4U;
+
+	*pCCMR = (*pCCMR & ~(7U << shift)) | ((uint32_t)(Mode & 7U) << shift);
+}
+
+/*
+ * Helper: PSC / ARR for a toggle frequency, written to the preload registers.
+ * The counter period is one half-period of the output (one toggle per update).
+ * Returns the update rate actually reached in mHz (0 = out of range), for note lengths.
+ */
+static uint64_t TIM_Tone_LoadPeriod(TIM_RegDef_t *pTIMx, uint32_t UpdateHz){
+	uint64_t timer_clk = TIM_IsOnAPB2(pTIMx) ? RCC_GetTimerClock2() : RCC_GetTimerClock1();
+	uint64_t ticks = timer_clk / UpdateHz;                      // per update, before the prescaler
+	uint64_t arr_max = TIM_GetArrMax(pTIMx);
+
+	if (ticks < 2U){
+		return 0;   // ARR >= 1: CCRx = 0 must be reachable once per period
+	}
+	uint64_t divider = (ticks + arr_max) / (arr_max + 1U);     // ceil(ticks / (ARR_MAX + 1))
+	if (divider > TIM_PSC_MAX + 1U){
+		return 0;
+	}
+	uint64_t period = (timer_clk + (divider * UpdateHz) / 2U) / (divider * UpdateHz);
+	if (period > arr_max + 1U){
+		period = arr_max + 1U;
+	}
+
+	pTIMx->PSC = (uint32_t)(divider - 1U);
+	pTIMx->ARR = (uint32_t)(period - 1U);
+	return (timer_clk * 1000U) / (divider * period);
+}
+
+/*
+ * Helper: update events of a note of DurationMs at the given rate (at least one)
+ */
+static uint32_t TIM_Tone_Updates(uint16_t DurationMs, uint64_t UpdateMilliHz){
+	uint64_t updates = ((uint64_t)DurationMs * UpdateMilliHz + 500000U) / 1000000U;
+
+	return (updates == 0) ? 1U : (uint32_t)updates;
+}
+
+/*
+ * Helper: preload the next note of the sequence (takes effect at the next update event)
+ * Returns 0 if the sequence is over.
+ */
+static uint8_t TIM_Tone_PreloadNext(TIM_Tone_Handle_t *pToneHandle){
+	TIM_RegDef_t *pTIMx = pToneHandle->pTIMx;
+
+	if (pToneHandle->NextNote >= pToneHandle->NoteCount){
+		if (pToneHandle->Loop != ENABLE){
+			return 0;
+		}
+		pToneHandle->NextNote = 0;
+	}
+
+	const TIM_Note_t *pNote = &pToneHandle->pNotes[pToneHandle->NextNote++];
+	uint8_t rest = (pNote->FrequencyHz == TIM_NOTE_REST);
+	uint64_t rate = TIM_Tone_LoadPeriod(pTIMx, rest ? TIM_TONE_REST_UPDATE_HZ : 2U * (uint32_t)pNote->FrequencyHz);
+
+	if (rate == 0){
+		// out of range: play it as a rest of the same length
+		rest = 1;
+		rate = TIM_Tone_LoadPeriod(pTIMx, TIM_TONE_REST_UPDATE_HZ);
+	}
+	pToneHandle->PendingMode = rest ? TIM_OC_MODE_FORCE_INACTIVE : TIM_OC_MODE_TOGGLE;
+	pToneHandle->PendingCount = TIM_Tone_Updates(pNote->DurationMs, rate);
+	return 1;
+}
+
+/*
+ * Update hook: one call per half-period.
+ * 1. The note preloaded during the last period just became active (PSC / ARR swapped
+ *    in by the hardware): switch the output mode with it and start its countdown.
+ * 2. Last period of the current note: preload the next one, or end the sequence.
+ */
+static void TIM_Tone_UpdateHook(TIM_RegDef_t *pTIMx){
+	for (uint8_t i = 0; i < TIM_MAX_TONE; i++){
+		TIM_Tone_Handle_t *pToneHandle = TonePlayers[i];
+
+		if (pToneHandle == NULL || pToneHandle->pTIMx != pTIMx || pToneHandle->Playing != ENABLE){
+			continue;
+		}
+		if (pToneHandle->PendingMode != 0){
+			TIM_OC_SetMode(pTIMx, pToneHandle->Tone_Config.Channel, pToneHandle->PendingMode);
+			pToneHandle->Countdown = pToneHandle->PendingCount;
+			pToneHandle->PendingMode = 0;
+		}else if (pToneHandle->Countdown == 0){
+			// the last note is over
+			TIM_OC_SetMode(pTIMx, pToneHandle->Tone_Config.Channel, TIM_OC_MODE_FORCE_INACTIVE);
+			CLEAR_BIT(pTIMx->CR1, 0);
+			pToneHandle->Playing = DISABLE;
+			if (pToneHandle->CompleteCallback != NULL){
+				pToneHandle->CompleteCallback(pTIMx);
+			}
+			continue;
+		}
+
+		if (pToneHandle->Countdown == 1){
+			TIM_Tone_PreloadNext(pToneHandle);
+		}
+		pToneHandle->Countdown--;
+	}
+}
+
+uint8_t TIM_Tone_Init(TIM_Tone_Handle_t *pToneHandle){
+	TIM_RegDef_t *pTIMx = pToneHandle->pTIMx;
+	const TIM_Descriptor_t *pDesc = TIM_GetDescriptor(pTIMx);
+	uint8_t ch = pToneHandle->Tone_Config.Channel;
+
+	if (pDesc == NULL || ch < 1 || ch > pDesc->Channels || TIM_GetIRQNumber(pTIMx) == TIM_IRQ_NONE){
+		return DISABLE;
+	}
+
+	/*
+	 * 1. Counter stopped, CR1 = ARPE only (edge-aligned, up, no one-pulse left over),
+	 * slave mode off: the counter runs from the internal clock.
+	 */
+	pTIMx->CR1 = (1U << 7);
+	pTIMx->SMCR &= ~((7U << 4) | (7U << 0));
+	pToneHandle->Playing = DISABLE;
+	pToneHandle->PendingMode = 0;
+
+	// 2. Channel: silent, CCRx = 0 (one match per period, right after the update)
+	(&pTIMx->CCR1)[ch - 1U] = 0;
+	TIM_OC_ConfigChannel(pTIMx, ch, TIM_OC_MODE_FORCE_INACTIVE, pToneHandle->Tone_Config.Polarity, ENABLE);
+	if (pTIMx == TIM1 || pTIMx == TIM8){
+		SET_BIT(pTIMx->BDTR, TIM_BDTR_MOE); // advanced timers: outputs gated by MOE
+	}
+
+	// 3. Sequence table slot
+	uint8_t slot = TIM_MAX_TONE;
+	for (uint8_t i = 0; i < TIM_MAX_TONE; i++){
+		if (TonePlayers[i] == pToneHandle || (TonePlayers[i] != NULL && TonePlayers[i]->pTIMx == pTIMx)){
+			slot = i;
+			break;
+		}
+		if (TonePlayers[i] == NULL && slot == TIM_MAX_TONE){
+			slot = i;
+		}
+	}
+	if (slot == TIM_MAX_TONE){
+		return DISABLE;
+	}
+	TonePlayers[slot] = pToneHandle;
+
+	if (TIM_RegisterUpdateCallback(pTIMx, TIM_Tone_UpdateHook) != ENABLE){
+		TonePlayers[slot] = NULL; // nothing would ever advance it: give the slot back
+		return DISABLE;
+	}
+	return ENABLE;
+}
+
+uint8_t TIM_Tone_SetFrequency(TIM_Tone_Handle_t *pToneHandle, uint32_t FrequencyHz){
+	TIM_RegDef_t *pTIMx = pToneHandle->pTIMx;
+	uint8_t ch = pToneHandle->Tone_Config.Channel;
+
+	pToneHandle->Playing = DISABLE;
+	pToneHandle->PendingMode = 0;
+
+	if (FrequencyHz == TIM_NOTE_REST){
+		TIM_OC_SetMode(pTIMx, ch, TIM_OC_MODE_FORCE_INACTIVE);
+		return ENABLE;
+	}
+	if (FrequencyHz > 0x7FFFFFFFU || TIM_Tone_LoadPeriod(pTIMx, 2U * FrequencyHz) == 0){
+		return DISABLE;
+	}
+
+	// Counter stopped (first tone): load PSC / ARR now instead of at the next update
+	if (!READ_BIT(pTIMx->CR1, 0)){
+		SET_BIT(pTIMx->EGR, 0);
+		pTIMx->SR = ~(1U << 0);
+		SET_BIT(pTIMx->CR1, 0);
+	}
+	TIM_OC_SetMode(pTIMx, ch, TIM_OC_MODE_TOGGLE);
+	return ENABLE;
+}
+
+uint8_t TIM_Tone_Play(TIM_Tone_Handle_t *pToneHandle, const TIM_Note_t *pNotes, uint16_t Count,
+                      uint8_t Loop, TIM_Tone_Callback_t CompleteCallback){
+	TIM_RegDef_t *pTIMx = pToneHandle->pTIMx;
+
+	if (pNotes == NULL || Count == 0){
+		return DISABLE;
+	}
+
+	// 1. Stop: the interrupt must not see a half-written sequence
+	pToneHandle->Playing = DISABLE;
+	CLEAR_BIT(pTIMx->CR1, 0);
+
+	pToneHandle->pNotes = pNotes;
+	pToneHandle->NoteCount = Count;
+	pToneHandle->NextNote = 0;
+	pToneHandle->Loop = Loop;
+	pToneHandle->CompleteCallback = CompleteCallback;
+
+	/*
+	 * 2. First note: preload it, then UG loads it right away (CNT = 0). The UIF this raises
+	 * is dropped, so the first real update event is the end of the first period, which
+	 * the hook counts like any other. Its mode is applied here instead.
+	 */
+	TIM_Tone_PreloadNext(pToneHandle);
+	SET_BIT(pTIMx->EGR, 0);
+	pTIMx->SR = ~(1U << 0);
+	TIM_OC_SetMode(pTIMx, pToneHandle->Tone_Config.Channel, pToneHandle->PendingMode);
+	pToneHandle->Countdown = pToneHandle->PendingCount - 1U;
+	pToneHandle->PendingMode = 0;
+	if (pToneHandle->Countdown == 0){
+		TIM_Tone_PreloadNext(pToneHandle); // one-period note: the next one is due at the first update
+	}
+
+	// 3. Go
+	pToneHandle->Playing = ENABLE;
+	SET_BIT(pTIMx->CR1, 0);
+	return ENABLE;
+}
+
+void TIM_Tone_Stop(TIM_Tone_Handle_t *pToneHandle){
+	TIM_RegDef_t *pTIMx = pToneHandle->pTIMx;
+
+	pToneHandle->Playing = DISABLE;
+	pToneHandle->PendingMode = 0;
+	CLEAR_BIT(pTIMx->CR1, 0);
+	TIM_OC_SetMode(pTIMx, pToneHandle->Tone_Config.Channel, TIM_OC_MODE_FORCE_INACTIVE);
 }
@@ -16,6 +16,12 @@
 #ifndef SOURCES_STM32F446XX_TIMER_DRIVER_H_
 #define SOURCES_STM32F446XX_TIMER_DRIVER_H_
 
+#include <stdint.h>
+#include "stm32f446xx.h"
+#include "stm32f446xx_rcc_driver.h"
+#include "stm32f446xx_pclk_driver.h"
+#include "stm32f446xx_dma_driver.h"
+
 /*
  * ==========================================
  * 1. Peripheral Clock Setup
@@ -27,8 +33,12 @@
  * Bit 0 sets TIM2
  * 0: TIM2 clock disabled
  * 1: TIM2 clock enabled
+ *
+ * [UPDATED] Reference-counted through the clock manager (stm32f446xx_pclk_driver.h).
+ * TIM_PeriClockControl works for every timer; TIM2_PCLK_EN is kept for old code.
  */
-#define TIM2_PCLK_EN()  (SET_BIT(RCC->APB1ENR, 0)) // Bitwise Macro defined in stm32f446xx.h
+void TIM_PeriClockControl(TIM_RegDef_t *pTIMx, uint8_t EnableOrDisable);
+#define TIM2_PCLK_EN()  (PCLK_Acquire(PCLK_TIM2))
 
 /*
  * ==========================================
@@ -36,6 +46,36 @@
  * ==========================================
  */
 
+/*
+ * PWM Channel Configuration
+ * One entry per output channel (CH1-CH4), so a single timer can drive up to
+ * four outputs at the same frequency (e.g. an RGBW LED) with independent duty cycles.
+ */
+
+/* @TIM_PWM_MODE (CCMRx OCxM) */
+#define TIM_PWM_MODE1           6   // active while CNT < CCRx  (duty = CCRx / (ARR + 1))
+#define TIM_PWM_MODE2           7   // active while CNT >= CCRx (inverted duty)
+
+/* @TIM_OC_POLARITY (CCER CCxP) */
+#define TIM_OC_POL_HIGH         0   // active = high
+#define TIM_OC_POL_LOW          1   // active = low (e.g. LED wired to VDD)
+
+/* @TIM_ALIGNMENT (CR1 CMS) */
+#define TIM_ALIGN_EDGE          0   // count up 0 .. ARR, then wrap (default)
+#define TIM_ALIGN_CENTER1       1   // count up to ARR, then down to 0; compare flags while counting down
+#define TIM_ALIGN_CENTER2       2   // same, compare flags while counting up
+#define TIM_ALIGN_CENTER3       3   // same, compare flags both ways
+
+#define TIM_CHANNELS            4
+
+typedef struct{
+	uint8_t Enable;         // ENABLE / DISABLE. Disabled channels are not touched at all
+	uint8_t Mode;           // Possible values: @TIM_PWM_MODE
+	uint8_t Polarity;       // Possible values: @TIM_OC_POLARITY
+	uint8_t Preload;        // ENABLE: a new duty only takes effect at the next update event (no glitch)
+	uint32_t InitialDuty;   // CCRx at start, 0 .. ARR + 1
+} TIM_PWMChannel_t;
+
 /*
  * TIM Configuration Structure
  * This structure acts as the "Menu" for user-configurable settings.
@@ -47,21 +87,32 @@
  *
  * Exposed Settings:
  * 1. Prescaler (PSC): Controls the "Speed" of the timer tick.
- * 2. Period (ARR): Controls the "Frequency" of the PWM cycle.
+ * 2. Period (ARR): Controls the "Frequency" of the PWM cycle (shared by all channels).
+ * 3. Alignment (CMS): edge- or center-aligned counting.
+ * 4. Channel[0..3]: Mode, polarity, preload and starting duty of CH1-CH4.
  *
  * Hidden Settings (Hardcoded in Driver):
- * - PWM Mode (CCMR1): Fixed to PWM Mode 1.
- * - Output Enable (CCER): Always enabled for Channel 1.
  * - Counter Enable (CR1): Always turned on after init.
  *
- * Why not CCR1?
- * The Capture/Compare Register (CCR1) controls duty cycle (brightness).
- * Since brightness changes dynamically at runtime (in the while loop),
- * it is not part of the static initialization configuration.
+ * Center-aligned counting:
+ *   CNT:  0 /‾‾‾ARR‾‾‾\ 0 /‾‾‾ARR‾‾‾\ 0      (up, then down)
+ *   CH1:  ¯¯¯|_______|¯¯¯¯¯|_______|¯¯¯      (PWM mode 1: active while CNT < CCR1,
+ *   CH2:  ¯|___________|¯|___________|¯       centered on CNT = 0 for every channel)
+ * The pulses of all channels are symmetric around the same point. Edge-aligned,
+ * every channel switches on at the same instant (CNT = 0); center-aligned, the edges
+ * of different duties are spread over the period: less ripple and EMI.
+ * One period is 2 x ARR counts: PWM_Freq = TimerClock / ((PSC + 1) * 2 * ARR).
+ *
+ * Why is the duty only an INITIAL value?
+ * The Capture/Compare Register (CCRx) controls duty cycle (brightness).
+ * Since brightness changes dynamically at runtime, it is changed with
+ * TIM_SetCompare / TIM_SetCompareAll after init.
  */
 typedef struct{
-    uint32_t Prescaler;  // Clock Prescaler (PSC): SystemCoreClock / (Prescaler + 1)
+    uint32_t Prescaler;  // Clock Prescaler (PSC): TimerClock / (Prescaler + 1), see RCC_GetTimerClock1()
     uint32_t Period;     // Auto-Reload Value (ARR): Determines PWM frequency
+    uint8_t Alignment;   // Possible values: @TIM_ALIGNMENT (0 = edge-aligned)
+    TIM_PWMChannel_t Channel[TIM_CHANNELS]; // [0] = CH1 ... [3] = CH4
 } TIM_Config_t;
 
 /*
@@ -78,8 +129,879 @@ typedef struct{
     TIM_Config_t TIM_Config;   // Configuration settings
 } TIM_Handle_t;
 
+/*
+ * ==========================================
+ * 3. Compile-Time PSC/ARR Solver
+ * ==========================================
+ * Instead of working out PSC/ARR by hand for every clock configuration
+ * (PSC = 15, ARR = 999 was only right for 16 MHz), let the preprocessor do it.
+ * Every argument must be a constant expression, so the result is folded
+ * into a plain immediate by the compiler -> zero runtime division.
+ *
+ * Inputs:
+ * - CLK:   timer input clock in Hz (e.g. SYSINIT_TIMCLK1_HZ for TIM2)
+ * - FREQ:  wanted PWM/update frequency in Hz
+ * - STEPS: minimum duty resolution (number of counts per period, i.e. ARR + 1)
+ * - ARR_MAX: counter size of the timer (TIM_ARR_MAX_16BIT / TIM_ARR_MAX_32BIT)
+ * - TOL_PPM: largest acceptable frequency error in ppm
+ *
+ * Strategy:
+ * Total divider N = (PSC + 1) * (ARR + 1) = CLK / FREQ (rounded).
+ * We prefer the LARGEST prescaler that still leaves at least STEPS counts per period:
+ * a slower counter uses less power (see TECHNICAL_ANALYSIS.md, Section 2)
+ * and the period stays close to STEPS, which is what the duty-cycle code expects.
+ * e.g. CLK = 90 MHz, FREQ = 1 kHz, STEPS = 1000
+ *      N = 90000 -> PSC + 1 = 90 -> ARR + 1 = 1000 (exact, 1 us ticks)
+ *
+ * If that prescaler misses the frequency by more than TOL_PPM (or its ARR does not
+ * fit in ARR_MAX), the solver falls back to the largest prescaler that is GUARANTEED
+ * to hit it: the rounding error is at most P / (2 * N) for P = PSC + 1, so
+ * P <= 2 * N * TOL_PPM / 10^6 always fits the tolerance. P is raised if needed so that
+ * ARR fits in ARR_MAX, and never exceeds the first choice, so STEPS still holds.
+ * e.g. CLK = 90 MHz, FREQ = 7 kHz, STEPS = 1000, TOL_PPM = 100 (N = 12857.14)
+ *      PSC + 1 = 12 -> ARR + 1 = 1071 -> 400 ppm off, rejected
+ *      PSC + 1 = 2  -> ARR + 1 = 6429 ->  67 ppm, taken
+ * If neither fits, TIM_ASSERT_SOLVABLE fails.
+ *
+ * Error Bound:
+ * ARR is rounded to the nearest integer, so the frequency error is at most
+ * (PSC + 1) / (2 * N), which is about 1 / (2 * STEPS) for the first choice
+ * (<= 500 ppm with STEPS = 1000) and within TOL_PPM for the fallback.
+ */
+#define TIM_PSC_MAX             0xFFFFU        // PSC is 16 bits on every timer
+#define TIM_ARR_MAX_16BIT       0xFFFFU        // TIM1, TIM3, TIM4, TIM6-TIM14
+#define TIM_ARR_MAX_32BIT       0xFFFFFFFFU    // TIM2, TIM5
+
+#define TIM_CALC_DIVIDER(CLK, FREQ)         (((CLK) + ((FREQ) / 2U)) / (FREQ))
+#define TIM_CALC_PSC_RAW(CLK, FREQ, STEPS)  (TIM_CALC_DIVIDER(CLK, FREQ) / (STEPS))
+
+/*
+ * Prescaler P = PSC + 1, helpers per candidate P:
+ * ARR, ticks per second the pair actually produces (times FREQ), error in ppm.
+ * |f_actual - f| / f = |CLK - f * P * (ARR+1)| / (f * P * (ARR+1))
+ * 64-bit math: f * N is roughly CLK, and CLK * 10^6 does not fit in 32 bits.
+ */
+#define TIM_CALC_ARR_P(CLK, FREQ, P)        \
+	(((TIM_CALC_DIVIDER(CLK, FREQ) + ((P) / 2U)) / (P)) - 1U)
+#define TIM_CALC_TICKS_P(CLK, FREQ, P)      \
+	((uint64_t)(FREQ) * (uint64_t)(P) * ((uint64_t)TIM_CALC_ARR_P(CLK, FREQ, P) + 1U))
+#define TIM_CALC_ERROR_PPM_P(CLK, FREQ, P)  \
+	(((TIM_CALC_TICKS_P(CLK, FREQ, P) > (uint64_t)(CLK)) ? \
+	  (TIM_CALC_TICKS_P(CLK, FREQ, P) - (uint64_t)(CLK)) : \
+	  ((uint64_t)(CLK) - TIM_CALC_TICKS_P(CLK, FREQ, P))) * 1000000ULL / TIM_CALC_TICKS_P(CLK, FREQ, P))
+#define TIM_CALC_FITS_P(CLK, FREQ, P, ARR_MAX, TOL_PPM) \
+	((uint64_t)TIM_CALC_ARR_P(CLK, FREQ, P) <= (uint64_t)(ARR_MAX) && \
+	 TIM_CALC_ERROR_PPM_P(CLK, FREQ, P) <= (uint64_t)(TOL_PPM))
+
+/*
+ * First choice: the largest prescaler, 1 to 2^16.
+ * Fallback: 2 * N * TOL_PPM / 10^6, or the smallest P whose ARR fits, whichever is larger
+ * (at least 1 either way).
+ */
+#define TIM_CALC_P_MAX(CLK, FREQ, STEPS)    \
+	(TIM_CALC_PSC_RAW(CLK, FREQ, STEPS) > (TIM_PSC_MAX + 1U) ? (TIM_PSC_MAX + 1U) : \
+	 TIM_CALC_PSC_RAW(CLK, FREQ, STEPS) == 0U ? 1U : TIM_CALC_PSC_RAW(CLK, FREQ, STEPS))
+#define TIM_CALC_P_TOL(CLK, FREQ, TOL_PPM)  \
+	((uint64_t)TIM_CALC_DIVIDER(CLK, FREQ) * 2U * (TOL_PPM) / 1000000ULL)
+#define TIM_CALC_P_FIT(CLK, FREQ, ARR_MAX)  \
+	(((uint64_t)TIM_CALC_DIVIDER(CLK, FREQ) + (ARR_MAX)) / ((uint64_t)(ARR_MAX) + 1U))
+#define TIM_CALC_P_FALLBACK(CLK, FREQ, ARR_MAX, TOL_PPM) \
+	(TIM_CALC_P_TOL(CLK, FREQ, TOL_PPM) > TIM_CALC_P_FIT(CLK, FREQ, ARR_MAX) ? \
+	 TIM_CALC_P_TOL(CLK, FREQ, TOL_PPM) : TIM_CALC_P_FIT(CLK, FREQ, ARR_MAX))
+#define TIM_CALC_PRESCALER(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) \
+	((uint32_t)((TIM_CALC_FITS_P(CLK, FREQ, TIM_CALC_P_MAX(CLK, FREQ, STEPS), ARR_MAX, TOL_PPM) || \
+	             TIM_CALC_P_FALLBACK(CLK, FREQ, ARR_MAX, TOL_PPM) >= TIM_CALC_P_MAX(CLK, FREQ, STEPS)) ? \
+	            TIM_CALC_P_MAX(CLK, FREQ, STEPS) : TIM_CALC_P_FALLBACK(CLK, FREQ, ARR_MAX, TOL_PPM)))
+
+#define TIM_CALC_PSC(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) \
+	(TIM_CALC_PRESCALER(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) - 1U)
+#define TIM_CALC_ARR(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) \
+	TIM_CALC_ARR_P(CLK, FREQ, TIM_CALC_PRESCALER(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM))
+
+/*
+ * Actual frequency error in ppm (parts per million) of the solved pair.
+ */
+#define TIM_CALC_ERROR_PPM(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) \
+	TIM_CALC_ERROR_PPM_P(CLK, FREQ, TIM_CALC_PRESCALER(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM))
+
+/*
+ * Build-time guard: place next to the code that uses TIM_CALC_PSC/ARR
+ * (same arguments). Fails the BUILD (not the board!) if:
+ * 1. the clock is too slow to give STEPS counts at FREQ,
+ * 2. the period does not fit in the timer's counter (ARR_MAX),
+ * 3. the solved frequency is off by more than TOL_PPM.
+ */
+#define TIM_ASSERT_SOLVABLE(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) \
+	_Static_assert(TIM_CALC_DIVIDER(CLK, FREQ) >= (STEPS), \
+	               "TIM solver: timer clock too slow for this frequency/resolution"); \
+	_Static_assert((uint64_t)TIM_CALC_ARR(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) <= (uint64_t)(ARR_MAX), \
+	               "TIM solver: period does not fit in the counter, use a 32-bit timer or a lower resolution"); \
+	_Static_assert(TIM_CALC_ERROR_PPM(CLK, FREQ, STEPS, ARR_MAX, TOL_PPM) <= (TOL_PPM), \
+	               "TIM solver: requested frequency cannot be hit within tolerance")
+
+/*
+ * ==========================================
+ * 4. Clock Re-Tuning
+ * ==========================================
+ * Every timer started with TIM_PWM_Init() is remembered together with its
+ * counter frequency (TimerClock / (PSC + 1)), up to TIM_MAX_TRACKED timers.
+ * TIM_PWM_Init registers TIM_ClockChangeCallback with the RCC driver, so after
+ * RCC_SetSystemClock() each tracked timer gets a new PSC that keeps the
+ * counter frequency (and therefore the PWM frequency) unchanged.
+ *
+ * Transient: RCC_SetSystemClock switches SYSCLK (parking on HSI first) BEFORE the
+ * callbacks run, so for the duration of the switch the timers count at the old PSC
+ * on the intermediate clocks. The callback then forces an update (UG) so the new
+ * PSC applies at once: the period in progress is restarted, i.e. one PWM period
+ * comes out shorter or longer, after that the frequency is back on target.
+ * Linked timers are not forced one by one:
+ * - sync groups (Section 10) are restarted as a whole, phase offsets kept
+ * - other slaves (SMCR SMS != 0) and timers driving TRGO (CR2 MMS != 0, e.g. TIM2 feeding
+ *   the TIM4 waveform divider) load the new PSC at their next update event, so their
+ *   current and next period still run at the old divider (stretched or shortened).
+ */
+#define TIM_MAX_TRACKED         4
+
+void TIM_ClockChangeCallback(const RCC_ClockTree_t *pClockTree);
+
+/*
+ * ==========================================
+ * 5. Update Interrupt
+ * ==========================================
+ * The update event fires once per period (every ARR + 1 counts), e.g. every 1 ms
+ * for the 1 kHz PWM. Other modules can hook into it instead of each one owning
+ * the TIMx_IRQHandler: TIM_RegisterUpdateCallback enables UIE and the NVIC line
+ * on the first registration, and the IRQ handler calls every callback of that timer.
+ * Callbacks run in interrupt context: keep them short.
+ *
+ * Vector handlers are provided for every timer except TIM5 (the time base owns it).
+ * Shared vectors (e.g. TIM1_UP_TIM10) serve both timers: see Section 12.
+ */
+#define TIM_MAX_UPDATE_CALLBACKS    6   // per timer: one per client (swtimer, sequencer, OPM, dither, BAM, tone)
+
+typedef void (*TIM_UpdateCallback_t)(TIM_RegDef_t *pTIMx);
+
+/*
+ * Returns ENABLE if registered, DISABLE if the timer's table is full or the timer has no IRQ handler.
+ * Registering the same callback twice for the same timer is a no-op.
+ */
+uint8_t TIM_RegisterUpdateCallback(TIM_RegDef_t *pTIMx, TIM_UpdateCallback_t Callback);
+
+/*
+ * Frees the callback's entry; UIE is switched off once the timer has none left.
+ * Safe from a callback of the same timer. Returns DISABLE if it was not registered.
+ */
+uint8_t TIM_UnregisterUpdateCallback(TIM_RegDef_t *pTIMx, TIM_UpdateCallback_t Callback);
+
+/*
+ * Common IRQ body: clears UIF and dispatches the update callbacks of pTIMx,
+ * then the capture callbacks (see Section 7).
+ */
+void TIM_IRQHandling(TIM_RegDef_t *pTIMx);
+
+/*
+ * ==========================================
+ * 6. One-Pulse Mode (OPM)
+ * ==========================================
+ * Problem:
+ * A pulse made with "pin high, delay, pin low" depends on the CPU: interrupts in
+ * between stretch it, and the CPU is stuck for the whole delay.
+ *
+ * OPM: the timer runs exactly ONE period and then stops by itself (CR1 bit 3 OPM).
+ *      Channel in PWM mode 2 -> output is active while CNT >= CCRx:
+ *
+ *      trigger    CNT = CCRx          CNT = ARR (update, counter stops)
+ *         |<- Delay ->|<---- Width ---->|
+ *   ______|___________|¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯|______
+ *
+ *   CCRx = Delay, ARR = Delay + Width - 1 (both in counter ticks)
+ *
+ * Trigger:
+ * - Software: TIM_OPM_Trigger() sets CEN.
+ * - External: slave mode "trigger" (SMCR SMS = 110). An edge on TI1 or TI2 sets CEN
+ *   in hardware, so the delay is measured from the edge itself with zero CPU jitter.
+ *   Re-arms automatically for the next edge once the pulse is over.
+ *   The output channel must be a different channel than the trigger input.
+ *
+ * Pins: configure the channel pin (and the trigger pin) in alternate function mode first,
+ * e.g. TIM3: PA6 = CH1, PA7 = CH2, PB0 = CH3, PB1 = CH4 (AF2).
+ *
+ * Refer to RM0390 - 18.3.15 One-pulse mode
+ */
+
+/* @TIM_OPM_TRIGGER */
+#define TIM_OPM_TRIG_SOFTWARE   0   // TIM_OPM_Trigger()
+#define TIM_OPM_TRIG_TI1        1   // edge on channel 1 input (TI1FP1, SMCR TS = 101)
+#define TIM_OPM_TRIG_TI2        2   // edge on channel 2 input (TI2FP2, SMCR TS = 110)
+
+/* @TIM_OPM_EDGE */
+#define TIM_OPM_EDGE_RISING     0
+#define TIM_OPM_EDGE_FALLING    1
+
+/* @TIM_OPM_POLARITY */
+#define TIM_OPM_POL_HIGH        TIM_OC_POL_HIGH // idle low, pulse high
+#define TIM_OPM_POL_LOW         TIM_OC_POL_LOW  // idle high, pulse low
+
+/*
+ * Called from the timer interrupt when the pulse (or delay) is over.
+ */
+typedef void (*TIM_OPM_Callback_t)(TIM_RegDef_t *pTIMx);
+
+typedef struct{
+	uint8_t Channel;                // 1 .. channels of the timer, output channel
+	uint32_t Prescaler;             // counter tick = TimerClock / (Prescaler + 1)
+	uint32_t Delay;                 // ticks from trigger to the start of the pulse, >= 1
+	uint32_t Width;                 // ticks, >= 1. Delay + Width must fit in ARR (16 bits except TIM2/TIM5)
+	uint8_t Polarity;               // Possible values: @TIM_OPM_POLARITY
+	uint8_t Trigger;                // Possible values: @TIM_OPM_TRIGGER
+	uint8_t TriggerEdge;            // Possible values: @TIM_OPM_EDGE
+	TIM_OPM_Callback_t DoneCallback;// optional (NULL), needs a timer with a vector handler
+} TIM_OPM_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	TIM_OPM_Config_t OPM_Config;
+} TIM_OPM_Handle_t;
+
+#define TIM_MAX_OPM             2   // timers that can have a DoneCallback at the same time
+
+/*
+ * Configure one-pulse mode (timer clock must be enabled). Nothing is emitted yet.
+ * With an external trigger the timer is armed right away.
+ * Returns DISABLE (timer untouched) if the channel does not exist on this timer, the
+ * trigger input does not (TIM10/11/13/14 have no slave mode), Delay + Width does not
+ * fit in ARR (e.g. > 65536 ticks on a 16-bit timer: raise the Prescaler), or the
+ * DoneCallback cannot be hooked.
+ */
+uint8_t TIM_OPM_Init(TIM_OPM_Handle_t *pOPMHandle);
+
+/*
+ * Software trigger: emit one pulse now. Ignored while a pulse is in progress.
+ */
+void TIM_OPM_Trigger(TIM_RegDef_t *pTIMx);
+
+/*
+ * 1 while the counter is running (pulse or delay in progress).
+ */
+uint8_t TIM_OPM_IsBusy(TIM_RegDef_t *pTIMx);
+
+/*
+ * Non-blocking microsecond delay on the same hardware:
+ * the timer runs one period of 'Us' microseconds with no output, then calls Callback
+ * from its update interrupt. Returns immediately.
+ * The prescaler is picked so the period fits the counter: 1 timer-clock resolution
+ * up to 65536 clocks, coarser beyond (16-bit timers at 90 MHz reach about 47 s).
+ * Returns DISABLE (nothing started) if the Callback cannot be hooked.
+ */
+uint8_t TIM_OPM_DelayUs(TIM_RegDef_t *pTIMx, uint32_t Us, TIM_OPM_Callback_t Callback);
+
+/*
+ * ==========================================
+ * 7. Input Capture
+ * ==========================================
+ * Problem:
+ * Polling IDR in a loop to time an external signal is as precise as the loop is
+ * fast, and the CPU does nothing else meanwhile.
+ *
+ * Input capture: on an edge of the channel input, the hardware copies CNT into CCRx.
+ * The timestamp is exact to one counter tick (11 ns with PSC = 0 at 90 MHz),
+ * no matter how late the CPU looks at it.
+ *
+ *   CNT:      ...  1200  1201 ... 4800 ...
+ *   input:   ______|¯¯¯¯¯¯¯¯¯¯¯¯¯¯¯|_______|¯¯¯
+ *   CCRx:          1200            4800    ...
+ *   width = 4800 - 1200 counts, period = difference of two rising edges
+ *
+ * Per channel:
+ * - Edge:      rising, falling or both (pulse width = both edges on one channel)
+ * - Prescaler: capture only every 1/2/4/8 edges (ICxPSC), for fast signals
+ * - Filter:    ICxF, an edge is accepted only after N stable samples (glitch/bounce reject)
+ *
+ * Getting the timestamps out:
+ * - CaptureCallback: CCxIE, called from the timer interrupt with each timestamp.
+ * - pBuffer: CCxDE, a DMA stream copies every capture into a RAM buffer, no CPU at all.
+ *   The DMA clock must be enabled first (DMA_PeriClockControl(DMA1, ENABLE), DMA2 for TIM1/TIM8).
+ *   Streams (timer descriptor, Section 12): TIM2 CH1-4 = DMA1 S5/S6/S1/S7 (channel 3),
+ *                          TIM3 CH1-4 = S4/S5/S7/S2 (channel 5), TIM4 CH1-3 = S0/S3/S7 (channel 2),
+ *                          TIM5 CH1-4 = S2/S4/S0/S1 (channel 6), TIM1 CH1-4 = DMA2 S1/S2/S6/S4 (channel 6),
+ *                          TIM8 CH1-4 = DMA2 S2/S3/S4/S7 (channel 7)
+ *   Two captures that need the same stream cannot both use a buffer.
+ *
+ * Counter:
+ * Captures share the counter with everything else on the timer. If the counter is
+ * already running (e.g. TIM2 doing PWM on CH1), it is left alone and timestamps wrap
+ * at ARR + 1: use TIM_IC_Delta() to subtract them. Otherwise it is started free-running.
+ *
+ * Pins (alternate function mode): TIM2 AF1: CH1 PA0/PA15, CH2 PA1/PB3, CH3 PA2/PB10, CH4 PA3/PB11
+ *                                 TIM3 AF2: CH1 PA6, CH2 PA7, CH3 PB0, CH4 PB1
+ *
+ * Refer to RM0390 - 18.3.5 Input capture mode
+ */
+
+/* @TIM_IC_EDGE (CCER CCxP / CCxNP) */
+#define TIM_IC_EDGE_RISING      0
+#define TIM_IC_EDGE_FALLING     1
+#define TIM_IC_EDGE_BOTH        2
+
+/* @TIM_IC_PRESCALER (CCMR ICxPSC) */
+#define TIM_IC_PSC_DIV1         0   // every edge
+#define TIM_IC_PSC_DIV2         1
+#define TIM_IC_PSC_DIV4         2
+#define TIM_IC_PSC_DIV8         3
+
+/*
+ * Called from the timer interrupt. Timestamp = CCRx (counter value at the edge).
+ */
+typedef void (*TIM_IC_Callback_t)(TIM_RegDef_t *pTIMx, uint8_t Channel, uint32_t Timestamp);
+
+typedef struct{
+	uint8_t Channel;                // 1-4
+	uint8_t Edge;                   // Possible values: @TIM_IC_EDGE
+	uint8_t Prescaler;              // Possible values: @TIM_IC_PRESCALER
+	uint8_t Filter;                 // 0 (off) - 15, see RM0390 TIMx_CCMR1 IC1F
+	TIM_IC_Callback_t CaptureCallback;  // optional (NULL)
+	uint32_t *pBuffer;              // optional (NULL): DMA timestamp buffer
+	uint16_t BufferLength;          // number of timestamps in pBuffer
+	uint8_t Circular;               // ENABLE: overwrite from the start when full
+	DMA_Callback_t BufferCallback;  // optional (NULL): buffer full (one-shot) / wrapped (circular)
+} TIM_IC_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	TIM_IC_Config_t IC_Config;
+} TIM_IC_Handle_t;
+
+#define TIM_MAX_IC              2   // timers that can have capture callbacks at the same time
+
+/*
+ * Configure and enable one capture channel (timer clock must be enabled).
+ */
+void TIM_IC_Init(TIM_IC_Handle_t *pICHandle);
+
+/*
+ * Disable one capture channel, its interrupt and its DMA stream.
+ */
+void TIM_IC_Stop(TIM_RegDef_t *pTIMx, uint8_t Channel);
+
+/*
+ * Number of timestamps the DMA has written into pBuffer so far
+ * (in circular mode: index of the next one to be written).
+ */
+uint16_t TIM_IC_GetBufferCount(TIM_IC_Handle_t *pICHandle);
+
+/*
+ * Counts from Older to Newer, correct across one counter wrap (at ARR + 1).
+ */
+uint32_t TIM_IC_Delta(TIM_RegDef_t *pTIMx, uint32_t Older, uint32_t Newer);
+
+/*
+ * ==========================================
+ * 8. DMA Waveform Playback
+ * ==========================================
+ * Problem:
+ * Every duty change (one fade step) costs an interrupt and a few lines of code,
+ * a thousand times per second for the breathing LED.
+ *
+ * Idea: the animation is known in advance -> store it as a table of CCR values in
+ * flash and let DMA copy the next value into CCR1 on every update event (DIER UDE).
+ * The CPU only hears about it at half / end of the table (if it asks to).
+ *
+ *   update event:   |     |     |     |     |     |
+ *   DMA request:    v     v     v     v     v     v
+ *   CCR1 (preload): t[0]  t[1]  t[2]  t[3]  ...          (active one period later, glitch-free)
+ *
+ * Options:
+ * - Circular: loop forever (breathing), or one-shot (stops on the last sample, which stays in CCR1).
+ * - Channels 1-4: every sample is a frame {CCR1, CCR2, ...} written by a DMA burst through
+ *   DCR/DMAR (DBA = CCR1, DBL = Channels - 1): one table animates up to four outputs.
+ * - UpdatesPerSample: hold every sample for N PWM periods. TIM2 has no repetition counter
+ *   (only TIM1/TIM8 do), so for N > 1 TIM4 counts TIM2 update events (TRGO -> ITR1,
+ *   external clock mode) and ITS update requests the DMA: one sample every N periods,
+ *   still without the CPU. TIM4 is busy while that runs, and N > 1 needs Channels = 1
+ *   (the burst registers belong to the timer that requests the DMA).
+ *
+ * Requirements: TIM2 already running (TIM_PWM_Init, preload enabled on the channels),
+ * DMA1 clock enabled (DMA_PeriClockControl(DMA1, ENABLE)).
+ * Streams: TIM2_UP = DMA1 Stream 1 channel 3, TIM4_UP = DMA1 Stream 6 channel 2
+ * (Stream 1 is also TIM2_CH3 input capture: the two cannot be used together).
+ *
+ * Refer to RM0390 - 18.3.19 DMA burst mode, 18.3.15 Timer synchronization
+ */
+typedef struct{
+	const uint32_t *pTable;         // CCR values, frames of 'Channels' words; may live in flash
+	uint16_t Length;                // number of samples (frames)
+	uint8_t Channels;               // 1-4: CCR1 .. CCRn updated per sample
+	uint16_t UpdatesPerSample;      // >= 1, PWM periods per sample
+	uint8_t Circular;               // ENABLE: loop, DISABLE: play once
+	DMA_Callback_t HalfCallback;    // optional (NULL)
+	DMA_Callback_t CompleteCallback;// optional (NULL): end of table (every loop when circular)
+} TIM_Waveform_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;            // TIM2 only
+	TIM_Waveform_Config_t Waveform_Config;
+} TIM_Waveform_Handle_t;
+
+/*
+ * Start playback. Returns DISABLE (and does nothing) if the handle is not supported:
+ * not TIM2, empty table, Channels out of range, or Channels > 1 with UpdatesPerSample > 1.
+ */
+uint8_t TIM_Waveform_Start(TIM_Waveform_Handle_t *pWaveformHandle);
+
+/*
+ * Stop playback. CCRx keep the last value written.
+ */
+void TIM_Waveform_Stop(TIM_RegDef_t *pTIMx);
+
+/*
+ * ==========================================
+ * 9. Complementary PWM (Advanced Timers TIM1 / TIM8)
+ * ==========================================
+ * Half-bridge / motor stages:
+ * One PWM channel drives TWO switches, high side (CHx) and low side (CHxN),
+ * always in opposite states. If both conduct at the same time, even for a few
+ * nanoseconds, the supply is shorted through the bridge ("shoot-through").
+ *
+ * Dead-time (BDTR DTG):
+ * The hardware delays the rising edge of each output, so both are OFF for a while
+ * at every switch-over:
+ *   OCxREF: ____|¯¯¯¯¯¯¯¯¯¯|_______
+ *   CHx:    ______|¯¯¯¯¯¯¯¯|_______     (rising edge delayed by the dead-time)
+ *   CHxN:   ¯¯¯¯|____________|¯¯¯¯¯     (rising edge delayed by the dead-time)
+ *                ^^          ^^ both off
+ * The dead-time is given in ns and encoded into DTG by the driver (rounded UP, never shorter).
+ * Up to 1008 dead-time clocks; the dead-time clock is divided by CR1 CKD (1/2/4) for longer ones.
+ * At 180 MHz (TIMCLK2): 5.6 ns resolution, up to ~22 us.
+ *
+ * MOE (Main Output Enable):
+ * The master switch of all outputs of the timer. Off after init: the outputs sit at
+ * their idle level (OISx / OISxN) until TIM_CPWM_OutputControl(ENABLE).
+ *
+ * Break input (BKIN pin, e.g. PA6 AF1 for TIM1, PA6 AF3 for TIM8):
+ * An active level on BKIN clears MOE IN HARDWARE, asynchronously (no clock, no CPU),
+ * and the outputs fall to their idle levels. The interrupt only TELLS the software
+ * that it happened. MOE stays off until software sets it again (or, with
+ * AutomaticOutput, at the next update event once the break is gone).
+ *
+ * Lock (BDTR LOCK):
+ * Level 1-3 makes dead-time, break and idle settings read-only until the next reset,
+ * so a runaway program cannot disable the protection. Init therefore writes BDTR once.
+ *
+ * Refer to RM0390 - 16.3.11 Complementary outputs and dead-time insertion,
+ *                   16.3.12 Using the break function, 16.4.18 TIMx_BDTR
+ */
+
+/* @TIM_BREAK */
+#define TIM_BREAK_DISABLE       0
+#define TIM_BREAK_ACTIVE_LOW    1   // outputs off while BKIN is low (e.g. driver fault pin, open drain)
+#define TIM_BREAK_ACTIVE_HIGH   2
+
+/* @TIM_LOCK_LEVEL (BDTR LOCK) */
+#define TIM_LOCK_OFF            0
+#define TIM_LOCK_LEVEL1         1   // DTG, BKE/BKP/AOE, OISx locked
+#define TIM_LOCK_LEVEL2         2   // + CCxP/CCxNP, OSSR/OSSI
+#define TIM_LOCK_LEVEL3         3   // + OCxM/OCxPE
+
+#define TIM_CPWM_CHANNELS       3   // CH4 has no complementary output
+
+/*
+ * Called from the TIMx break interrupt, after the hardware has already switched the outputs off.
+ * Once per break (see TIM_CPWM_OutputControl).
+ */
+typedef void (*TIM_Break_Callback_t)(TIM_RegDef_t *pTIMx);
+
+typedef struct{
+	uint8_t Enable;         // ENABLE: CHxN output on (the CHx side is Base.Channel[x])
+	uint8_t Polarity;       // Possible values: @TIM_OC_POLARITY (CCxNP)
+	uint8_t IdleState;      // CHx level while MOE = 0 (OISx): 0 or 1
+	uint8_t IdleStateN;     // CHxN level while MOE = 0 (OISxN): 0 or 1
+} TIM_CPWMChannel_t;
+
+typedef struct{
+	TIM_Config_t Base;              // PSC, ARR, CH1-CH4 exactly as for TIM_PWM_Init
+	uint8_t RepetitionCounter;      // RCR: update event every RCR + 1 periods
+	TIM_CPWMChannel_t Complementary[TIM_CPWM_CHANNELS]; // [0] = CH1N ... [2] = CH3N
+	uint32_t DeadTimeNs;            // both outputs off at every switch-over
+	uint8_t Break;                  // Possible values: @TIM_BREAK
+	uint8_t AutomaticOutput;        // ENABLE: MOE comes back by itself after a break (AOE)
+	uint8_t LockLevel;              // Possible values: @TIM_LOCK_LEVEL
+	TIM_Break_Callback_t BreakCallback; // optional (NULL)
+} TIM_CPWM_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;            // TIM1 or TIM8
+	TIM_CPWM_Config_t CPWM_Config;
+} TIM_CPWM_Handle_t;
+
+/*
+ * Start the counter with every enabled channel / complementary output, MOE off.
+ * Returns DISABLE (and does nothing) if pTIMx is not TIM1/TIM8, the dead-time is
+ * too long for the timer clock, or BDTR is already locked (LOCK holds until reset).
+ */
+uint8_t TIM_CPWM_Init(TIM_CPWM_Handle_t *pCPWMHandle);
+
+/*
+ * MOE on/off. ENABLE has no effect while the break input is active,
+ * and re-arms the break report for the next break.
+ */
+void TIM_CPWM_OutputControl(TIM_RegDef_t *pTIMx, uint8_t EnableOrDisable);
+
+/*
+ * 1 if the outputs are live (MOE set), 0 after a break or before OutputControl(ENABLE).
+ */
+uint8_t TIM_CPWM_IsOutputEnabled(TIM_RegDef_t *pTIMx);
+
+/*
+ * Change the dead-time with the outputs off (MOE = 0), e.g. after a system clock change:
+ * the dead-time is counted in timer clocks. Returns DISABLE if the outputs are on,
+ * BDTR is locked, or the value does not fit.
+ */
+uint8_t TIM_CPWM_SetDeadTime(TIM_RegDef_t *pTIMx, uint32_t DeadTimeNs);
+
+/*
+ * ==========================================
+ * 10. Timer Synchronization (Master / Slave)
+ * ==========================================
+ * Several timers that switch together (interleaved / multiphase stages) must not
+ * drift apart, and must start at a defined phase to each other.
+ *
+ * Wiring inside the chip:
+ * Every timer has a trigger OUTPUT (TRGO, chosen by CR2 MMS) and four internal
+ * trigger INPUTS (ITR0-ITR3), each hard-wired to the TRGO of one other timer
+ * (RM0390 "TIMx internal trigger connection" tables). SMCR TS picks the ITR, SMCR SMS what the slave does with it.
+ *
+ * Synchronized start (TIM_Sync_Start):
+ *   1. every timer stopped, each slave's CNT preloaded with its phase offset
+ *   2. master: TRGO = its own CEN (MMS = 001), MSM = 1 (delays the master by the
+ *      trigger latency so it lines up with its slaves)
+ *   3. slaves: trigger mode (SMS = 110): the trigger edge sets their CEN in hardware
+ *   4. master CEN = 1 -> all of them start counting on the SAME timer clock edge
+ * No software loop starts the slaves, so there is no skew between them.
+ *
+ * Phase offset:
+ * A slave starting at CNT = X runs X counts AHEAD of the master (X = 0: in phase).
+ * e.g. 3 phases, ARR = 999 (edge-aligned): offsets 0, 333, 666 -> 120 degrees apart.
+ * Center-aligned: the preload starts the slave on the way UP (DIR is read-only there),
+ * so 0 .. ARR covers 0 .. 180 degrees.
+ * The timers must have the same period and counter clock to stay in phase after the
+ * start (the start itself is exact, the periods are not re-aligned afterwards).
+ *
+ * Clock changes (Section 4): the group is remembered (up to TIM_MAX_SYNC_GROUPS handles,
+ * which must stay valid) and TIM_ClockChangeCallback restarts it with TIM_Sync_Start
+ * after the new prescalers are written: same phase offsets, same start edge. The
+ * outputs pause for the restart, and every member begins a fresh period.
+ *
+ * TRGO is a single output: a TIM2 master cannot also drive the TIM4 sample divider
+ * of DMA waveform playback (Section 8, UpdatesPerSample > 1).
+ *
+ * Refer to RM0390 - 17.3.15 Timer synchronization, 17.4.3 TIMx_SMCR
+ */
+
+/* @TIM_TRGO (CR2 MMS) */
+#define TIM_TRGO_RESET          0   // EGR UG
+#define TIM_TRGO_ENABLE         1   // counter enable (CEN): used for synchronized start
+#define TIM_TRGO_UPDATE         2   // every update event (e.g. slave counts master periods)
+#define TIM_TRGO_COMPARE_PULSE  3   // CC1IF
+#define TIM_TRGO_OC1REF         4
+#define TIM_TRGO_OC2REF         5
+#define TIM_TRGO_OC3REF         6
+#define TIM_TRGO_OC4REF         7
+
+/* @TIM_SLAVE_MODE (SMCR SMS) */
+#define TIM_SLAVE_DISABLE       0   // internal clock, trigger ignored
+#define TIM_SLAVE_RESET         4   // trigger restarts the counter
+#define TIM_SLAVE_GATED         5   // counts while the trigger is high
+#define TIM_SLAVE_TRIGGER       6   // trigger edge starts the counter (CEN = 1)
+#define TIM_SLAVE_EXT_CLOCK     7   // every trigger edge counts once
+
+#define TIM_SYNC_MAX_SLAVES     3
+#define TIM_MAX_SYNC_GROUPS     2   // groups restarted after a clock change
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	uint32_t PhaseOffset;           // CNT at start, 0 .. ARR (counts ahead of the master)
+} TIM_SyncSlave_t;
+
+typedef struct{
+	TIM_RegDef_t *pMaster;
+	uint8_t SlaveCount;             // 1 .. TIM_SYNC_MAX_SLAVES
+	TIM_SyncSlave_t Slaves[TIM_SYNC_MAX_SLAVES];
+} TIM_Sync_Handle_t;
+
+/*
+ * Master side: what TRGO carries. Possible values: @TIM_TRGO
+ */
+void TIM_Sync_SetMasterOutput(TIM_RegDef_t *pMaster, uint8_t Trgo);
+
+/*
+ * Slave side: listen to pMaster's TRGO (the ITR is looked up) and react as Mode.
+ * Returns DISABLE if pMaster is not wired to any ITR of pSlave. Possible values: @TIM_SLAVE_MODE
+ */
+uint8_t TIM_Sync_SetSlaveMode(TIM_RegDef_t *pSlave, TIM_RegDef_t *pMaster, uint8_t Mode);
+
+/*
+ * Stop master and slaves, preload the phase offsets, start all of them on the same edge.
+ * The timers must be configured already (TIM_PWM_Init / TIM_CPWM_Init: they may be running).
+ * The handle is remembered for clock changes: keep it static / global.
+ * Returns DISABLE (and does nothing) if a slave is not wired to the master, or if
+ * TIM_MAX_SYNC_GROUPS other handles are already remembered.
+ */
+uint8_t TIM_Sync_Start(TIM_Sync_Handle_t *pSyncHandle);
+
+/*
+ * ==========================================
+ * 11. Quadrature Encoder Interface
+ * ==========================================
+ * Problem:
+ * Reading an encoder by polling its pins, or with an EXTI interrupt per edge, costs
+ * CPU per count: at 100k counts/s that is 100k interrupts per second, and a missed
+ * edge is a lost count forever.
+ *
+ * Encoder mode (SMCR SMS = 001/010/011):
+ * The two encoder channels A/B (TI1/TI2) CLOCK the counter themselves. Every valid
+ * edge counts up or down depending on the level of the other channel:
+ *   A:   __|¯¯¯|___|¯¯¯|___        A leads B -> up      x4 mode (TI12): every edge
+ *   B:   ____|¯¯¯|___|¯¯¯|_        B leads A -> down    of A and B = 4 counts per line
+ *   CNT:   1 2 3 4 5 6 7 8
+ * No interrupt, no CPU: CNT IS the position (modulo ARR + 1), CR1 DIR the direction.
+ * The input filter (ICxF) ignores glitches shorter than N samples.
+ *
+ * Index pulse (optional, once per revolution on CH3):
+ * Captured like any input capture (Section 7); the capture interrupt subtracts the
+ * captured count from CNT, so CNT is 0 exactly at the index edge and the counts made
+ * since then (during the interrupt latency) are kept. One interrupt per revolution.
+ *
+ * Velocity (TIM_Encoder_Sample):
+ * Call it at a FIXED rate (SampleHz), e.g. from a periodic software timer. It takes
+ * the signed difference to the previous sample (wrap-around and index resets included)
+ * and updates Position (multi-turn, never reset) and Velocity (counts per second).
+ * The counter may wrap at most half a period between two samples:
+ * 16-bit timer at 1 kHz sampling -> up to ~32 M counts/s.
+ *
+ * Pins (alternate function mode): TIM2 AF1: A = PA0/PA15, B = PA1/PB3, Index = PA2/PB10
+ *                                 TIM3 AF2: A = PA6, B = PA7, Index = PB0
+ *                                 TIM4 AF2: A = PB6, B = PB7, Index = PB8
+ *
+ * Refer to RM0390 - 18.3.16 Encoder interface mode
+ */
+
+/* @TIM_ENCODER_MODE (SMCR SMS) */
+#define TIM_ENCODER_MODE_TI1    1   // x2: edges of A only
+#define TIM_ENCODER_MODE_TI2    2   // x2: edges of B only
+#define TIM_ENCODER_MODE_TI12   3   // x4: edges of A and B
+
+typedef struct{
+	uint8_t Mode;                   // Possible values: @TIM_ENCODER_MODE
+	uint8_t Filter;                 // 0 (off) - 15, see RM0390 TIMx_CCMR1 IC1F (A, B and index)
+	uint8_t InvertB;                // ENABLE: swap the counting direction (CC2P)
+	uint32_t Period;                // ARR: counts per revolution - 1, 0 = full counter range
+	uint8_t IndexReset;             // ENABLE: CNT = 0 on a rising edge of CH3
+	uint32_t SampleHz;              // rate TIM_Encoder_Sample is called at
+} TIM_Encoder_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;            // TIM2 - TIM4 (TIM5 is the time base)
+	TIM_Encoder_Config_t Encoder_Config;
+	/* Updated by TIM_Encoder_Sample */
+	int32_t Position;               // counts since TIM_Encoder_Init, multi-turn
+	int32_t Velocity;               // counts per second
+	uint32_t LastCount;
+} TIM_Encoder_Handle_t;
+
+#define TIM_MAX_ENCODERS        2   // encoders with IndexReset at the same time
+
+/*
+ * Start counting from 0 (timer clock already on: TIM_PeriClockControl).
+ * The handle must stay valid (static / global) while IndexReset is used.
+ */
+void TIM_Encoder_Init(TIM_Encoder_Handle_t *pEncoderHandle);
+
+/*
+ * Position within one revolution: CNT (0 .. Period), 0 at the index with IndexReset.
+ */
+uint32_t TIM_Encoder_GetCount(TIM_RegDef_t *pTIMx);
+
+/*
+ * 1 = counting down (CR1 DIR), 0 = up.
+ */
+uint8_t TIM_Encoder_GetDirection(TIM_RegDef_t *pTIMx);
+
+/*
+ * Velocity / multi-turn position estimator, call at Encoder_Config.SampleHz.
+ */
+void TIM_Encoder_Sample(TIM_Encoder_Handle_t *pEncoderHandle);
+
+/*
+ * ==========================================
+ * 12. Timer Descriptor Table
+ * ==========================================
+ * The F446 has 14 timers with different widths, channel counts, buses, vectors and DMA
+ * requests. Instead of "if (pTIMx == TIM2) ... else if (pTIMx == TIM3) ..." in every
+ * function, one const table (in flash) describes all of them, and every lookup is
+ * a direct index computed from the base address (TIM_GetDescriptor, no search).
+ *
+ *   Timer   Bus   Bits  Ch  Update IRQ (vector)          DMA
+ *   TIM1    APB2  16    4   TIM1_UP_TIM10 (+ TIM1_CC)    DMA2
+ *   TIM8    APB2  16    4   TIM8_UP_TIM13 (+ TIM8_CC)    DMA2
+ *   TIM2/5  APB1  32    4   TIM2 / TIM5                  DMA1
+ *   TIM3/4  APB1  16    4   TIM3 / TIM4                  DMA1 (TIM4: no CH4 request)
+ *   TIM6/7  APB1  16    0   TIM6_DAC / TIM7              DMA1 (update only)
+ *   TIM9    APB2  16    2   TIM1_BRK_TIM9                -
+ *   TIM10   APB2  16    1   TIM1_UP_TIM10                -
+ *   TIM11   APB2  16    1   TIM1_TRG_COM_TIM11           -
+ *   TIM12   APB1  16    2   TIM8_BRK_TIM12               -
+ *   TIM13   APB1  16    1   TIM8_UP_TIM13                -
+ *   TIM14   APB1  16    1   TIM8_TRG_COM_TIM14           -
+ *
+ * Refer to RM0390 - memory map, vector table, Tables 28/29 (DMA1/DMA2 request mapping)
+ */
+#define TIM_COUNT               14
+#define TIM_DMA_NONE            0xFF    // stream value: no such DMA request
+#define TIM_IRQ_NONE            0xFF
+
+typedef struct{
+	uint8_t Stream;             // 0-7, or TIM_DMA_NONE
+	uint8_t Request;            // request channel (DMA_SxCR CHSEL)
+} TIM_DMARequest_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	uint8_t Number;             // x in TIMx
+	uint8_t CounterBits;        // 16 or 32
+	uint8_t Channels;           // capture/compare channels: 0 (basic), 1, 2 or 4
+	uint8_t PclkId;             // @PCLK_IDS
+	uint8_t IRQNumber;          // update / global interrupt
+	uint8_t CCIRQNumber;        // capture / compare interrupt (differs on TIM1 / TIM8 only)
+	DMA_RegDef_t *pDMAx;        // NULL: no DMA requests
+	TIM_DMARequest_t DMAUpdate;
+	TIM_DMARequest_t DMAChannel[TIM_CHANNELS];
+} TIM_Descriptor_t;
+
+/*
+ * Descriptor of a timer, NULL if pTIMx is not a timer.
+ */
+const TIM_Descriptor_t *TIM_GetDescriptor(TIM_RegDef_t *pTIMx);
+
+/*
+ * ==========================================
+ * 13. Output-Compare Toggle (Tone Generator)
+ * ==========================================
+ * Problem:
+ * A buzzer or a clock output needs a square wave with exactly 50 % duty at an arbitrary,
+ * changing frequency. Toggling a pin in a loop (GPIO_ToggleOutputPin + delay) blocks
+ * the CPU and jitters with every interrupt.
+ *
+ * Toggle mode (OCxM = 011):
+ * The output flips every time CNT matches CCRx. With CCRx = 0 it flips once per counter
+ * period, so two periods make one cycle, high and low exactly equal:
+ *   f_out = TimerClock / ((PSC + 1) x (ARR + 1) x 2)
+ *   CNT:  0 .. ARR | 0 .. ARR | 0 .. ARR | 0 ..
+ *   OUT:  ¯¯¯¯¯¯¯¯¯|__________|¯¯¯¯¯¯¯¯¯¯|____
+ *
+ * Glitch-free retuning: PSC is always preloaded and ARR is preloaded here (ARPE), so
+ * a new frequency takes effect at the next update event. Every half-period is completely
+ * old or completely new: no short pulse, and no counter running past a smaller ARR
+ * up to 0xFFFF. A rest (0 Hz) forces the output inactive (OCxM = 100).
+ *
+ * Note sequences (TIM_Tone_Play):
+ * A table of {frequency, duration} (const, in flash) is played by the timer's own update
+ * interrupt (TIM_RegisterUpdateCallback): it counts down the half-periods of the current
+ * note and preloads the next note during the last one, so the notes join at an update
+ * event as well. One interrupt per half-period, nothing in main.
+ *
+ * PSC / ARR solver: smallest PSC that fits the half-period into the counter, ARR rounded
+ * to the nearest count (e.g. 440 Hz at 90 MHz: PSC = 1, ARR = 51135, error < 0.001 %).
+ *
+ * The frequency belongs to the whole timer (PSC / ARR are shared): one tone per timer,
+ * and the timer cannot do PWM or periodic ticks at the same time.
+ * Timers: any timer with channels and an update vector (not TIM5, the time base).
+ * Pins (alternate function mode): as for PWM, e.g. TIM3 AF2: CH1 PA6, TIM4 AF2: CH1 PB6
+ *
+ * Refer to RM0390 - 18.3.8 Output compare mode
+ */
+#define TIM_OC_MODE_TOGGLE          3   // OCxM = 011: flip on every match
+#define TIM_OC_MODE_FORCE_INACTIVE  4   // OCxM = 100: output held inactive
+#define TIM_TONE_REST_UPDATE_HZ     1000U   // update rate during rests (duration granularity)
+#define TIM_MAX_TONE                2   // timers playing a sequence at the same time
+
+#define TIM_NOTE_REST               0   // FrequencyHz of a pause
+
+typedef struct{
+	uint16_t FrequencyHz;       // square wave frequency, TIM_NOTE_REST = silence
+	uint16_t DurationMs;
+} TIM_Note_t;
+
+typedef void (*TIM_Tone_Callback_t)(TIM_RegDef_t *pTIMx);
+
+typedef struct{
+	uint8_t Channel;            // 1-4
+	uint8_t Polarity;           // Possible values: @TIM_OC_POLARITY (level during rests = inactive)
+} TIM_Tone_Config_t;
+
+typedef struct{
+	TIM_RegDef_t *pTIMx;
+	TIM_Tone_Config_t Tone_Config;
+	/* Sequence state, owned by TIM_Tone_Play and the update interrupt */
+	const TIM_Note_t *pNotes;
+	uint16_t NoteCount;
+	uint16_t NextNote;
+	uint8_t Loop;
+	volatile uint8_t Playing;
+	uint8_t PendingMode;        // OCxM of the note preloaded for the next update, 0 = none
+	uint32_t PendingCount;      // its length in update events
+	uint32_t Countdown;         // update events left in the current note
+	TIM_Tone_Callback_t CompleteCallback;
+} TIM_Tone_Handle_t;
+
+/*
+ * Configure the channel, silent. Returns DISABLE if the timer / channel is not supported.
+ * The handle must stay valid (static / global) while a sequence plays.
+ */
+uint8_t TIM_Tone_Init(TIM_Tone_Handle_t *pToneHandle);
+
+/*
+ * Square wave at FrequencyHz (TIM_NOTE_REST: silence), glitch-free from the next update event.
+ * Stops a running sequence. Returns DISABLE if the frequency cannot be reached
+ * (above TimerClock / 4, or below what PSC = 0xFFFF allows).
+ */
+uint8_t TIM_Tone_SetFrequency(TIM_Tone_Handle_t *pToneHandle, uint32_t FrequencyHz);
+
+/*
+ * Play Count notes from pNotes (may live in flash), from the update interrupt.
+ * Loop = ENABLE: start over after the last note. Otherwise the timer stops silent and
+ * CompleteCallback (optional, NULL) runs in interrupt context.
+ */
+uint8_t TIM_Tone_Play(TIM_Tone_Handle_t *pToneHandle, const TIM_Note_t *pNotes, uint16_t Count,
+                      uint8_t Loop, TIM_Tone_Callback_t CompleteCallback);
+
+/*
+ * Stop the sequence and the counter, output inactive.
+ */
+void TIM_Tone_Stop(TIM_Tone_Handle_t *pToneHandle);
+
 /* Function Prototypes */
+
+/*
+ * Start PWM on every enabled channel of the handle.
+ */
 void TIM_PWM_Init(TIM_Handle_t *pTIMHandle);
+
+/*
+ * Duty of one channel (1-4). Other values are ignored.
+ */
+void TIM_SetCompare(TIM_RegDef_t *pTIMx, uint8_t Channel, uint32_t CompareValue);
+
+/*
+ * Duty of all four channels in one call: Values[0] -> CCR1 ... Values[3] -> CCR4.
+ * With preload enabled, all four take effect at the same update event, unless that
+ * event lands within the few cycles of the (interrupt-free) write sequence:
+ * then the channels switch one period apart, once.
+ */
+void TIM_SetCompareAll(TIM_RegDef_t *pTIMx, const uint32_t Values[TIM_CHANNELS]);
+
+/*
+ * Kept for existing code: same as TIM_SetCompare(pTIMx, 1, CaptureValue).
+ */
 void TIM_SetCompare1(TIM_RegDef_t *pTIMx, uint32_t CaptureValue);
 
 #endif /* SOURCES_STM32F446XX_TIMER_DRIVER_H_ */
@@ -0,0 +1,240 @@
+#!/usr/bin/env python3
+"""
+check_pin_codegen.py
+
+Checks on the host what stm32f446xx_gpio_pin.hpp (gpio::Pin / gpio::PinGroup) compiles to.
+
+Two parts:
+
+codegen  Compiles a probe with the ARM toolchain (one extern "C" function per operation,
+         -O2, Cortex-M4 Thumb-2), disassembles it and checks every function:
+         - the GPIO register accesses are exactly the expected ones, e.g.
+             Pin::set()    one store to BSRR, no GPIO load
+             Pin::read()   one load of IDR, no store
+             Pin::toggle() one load of ODR, one store to BSRR
+         - at most N instructions, counting the literal load of the port address
+           (the return and the literal pool itself are not counted)
+         For comparison, prints the length of the C driver functions doing the same
+         (GPIO_WriteToOutputPin, ...), which also cost a call with runtime arguments.
+
+static   Every invalid pin / mode combination below must FAIL to compile, with its
+         static_assert message, and a valid use of every feature must compile.
+
+Usage:
+    python3 check_pin_codegen.py
+    python3 check_pin_codegen.py --prefix /opt/arm-gnu-toolchain/bin/arm-none-eabi-
+    python3 check_pin_codegen.py --list     (also print the disassembly)
+Exit status 1 if a check fails.
+"""
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+SOURCES = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "Sources")
+
+CXXFLAGS = ["-std=gnu++17", "-O2", "-mcpu=cortex-m4", "-mthumb", "-ffreestanding",
+            "-fno-exceptions", "-fno-rtti", "-Wall", "-Wextra", "-Werror"]
+CFLAGS = ["-std=gnu11", "-O2", "-mcpu=cortex-m4", "-mthumb", "-ffreestanding"]
+
+# GPIO register offsets (GPIO_RegDef_t)
+IDR, ODR, BSRR = 0x10, 0x14, 0x18
+REG_NAMES = {IDR: "IDR", ODR: "ODR", BSRR: "BSRR"}
+
+PROBE_HEADER = """
+#include "stm32f446xx_gpio_pin.hpp"
+using LED = gpio::Pin<gpio::PortA, 5>;
+using Bus = gpio::PinGroup<gpio::Pin<gpio::PortB, 0>, gpio::Pin<gpio::PortB, 1>,
+                           gpio::Pin<gpio::PortB, 2>, gpio::Pin<gpio::PortB, 3>>;
+"""
+
+# name, C++ function, max instructions, {offset: loads}, {offset: stores}
+# e.g. set = ldr r3, [pc, #..] (port address) / movs r2, #32 / str r2, [r3, #24]
+PROBES = [
+    ("pin_set",     "void pin_set(void){ LED::set(); }",                   3, {},        {BSRR: 1}),
+    ("pin_clear",   "void pin_clear(void){ LED::clear(); }",               3, {},        {BSRR: 1}),
+    ("pin_write",   "void pin_write(bool v){ LED::write(v); }",            6, {},        {BSRR: 1}),
+    ("pin_read",    "bool pin_read(void){ return LED::read(); }",          3, {IDR: 1},  {}),
+    ("pin_toggle",  "void pin_toggle(void){ LED::toggle(); }",             8, {ODR: 1},  {BSRR: 1}),
+    ("group_set",   "void group_set(void){ Bus::set(); }",                 3, {},        {BSRR: 1}),
+    ("group_write", "void group_write(uint16_t v){ Bus::write(v); }",      7, {},        {BSRR: 1}),
+    ("group_read",  "uint16_t group_read(void){ return Bus::read(); }",    3, {IDR: 1},  {}),
+]
+
+# C driver functions doing the same job, for comparison only
+DRIVER_FUNCTIONS = ["GPIO_WriteToOutputPin", "GPIO_ToggleOutputPin", "GPIO_ReadFromInputPin",
+                    "GPIO_WriteToOutputPins"]
+
+VALID_USE = """
+void valid(void){
+    LED::init<gpio::Mode::Output, gpio::Pull::None, gpio::OutType::PushPull, gpio::Speed::High>();
+    gpio::Pin<gpio::PortA, 2>::init<gpio::Mode::AltFn, gpio::Pull::Up, gpio::OutType::OpenDrain,
+                                     gpio::Speed::Low, 7>();
+    gpio::Pin<gpio::PortA, 13>::init<gpio::Mode::AltFn>();
+    gpio::Pin<gpio::PortC, 0>::init<gpio::Mode::Analog>();
+    gpio::Pin<gpio::PortD, 2>::set();
+    gpio::Pin<gpio::PortH, 1>::clear();
+    Bus::init<gpio::Mode::Input, gpio::Pull::Down>();
+}
+"""
+
+# body, expected static_assert message (substring)
+NEGATIVE = [
+    ("gpio::Pin<gpio::PortA, 16>::set();", "pin number must be 0-15"),
+    ("gpio::Pin<gpio::PortD, 5>::set();", "not bonded out"),
+    ("gpio::Pin<gpio::PortE, 0>::set();", "not bonded out"),
+    ("gpio::Pin<gpio::PortA, 13>::init<gpio::Mode::Output>();", "SWDIO / SWCLK"),
+    ("gpio::Pin<gpio::PortA, 14>::init<gpio::Mode::AltFn, gpio::Pull::None, gpio::OutType::PushPull,"
+     " gpio::Speed::Low, 1>();", "SWDIO / SWCLK"),
+    ("LED::init<gpio::Mode::Output, gpio::Pull::None, gpio::OutType::PushPull, gpio::Speed::Low, 1>();",
+     "only makes sense with Mode::AltFn"),
+    ("LED::init<gpio::Mode::AltFn, gpio::Pull::None, gpio::OutType::PushPull, gpio::Speed::Low, 16>();",
+     "must be 0-15"),
+    ("LED::init<gpio::Mode::Input, gpio::Pull::None, gpio::OutType::OpenDrain>();", "open drain"),
+    ("LED::init<gpio::Mode::Analog, gpio::Pull::Up>();", "pull resistor"),
+    ("gpio::PinGroup<gpio::Pin<gpio::PortA, 0>, gpio::Pin<gpio::PortB, 0>>::set();", "same port"),
+    ("gpio::PinGroup<gpio::Pin<gpio::PortA, 0>, gpio::Pin<gpio::PortA, 0>>::set();", "appears twice"),
+]
+
+INSN = re.compile(r"^\s*[0-9a-f]+:\s+(\S+)\s*(.*)$")
+FUNC = re.compile(r"^[0-9a-f]+ <(\w+)>:$")
+MEM = re.compile(r"\[(r\d+|ip|lr)(?:,\s*#(-?\d+))?\]")
+
+
+def run(cmd):
+    return subprocess.run(cmd, capture_output=True, text=True)
+
+
+def disassemble(prefix, obj):
+    """{function: [(mnemonic, operands), ...]} without returns, padding and literal pools."""
+    out = run([prefix + "objdump", "-d", "--no-show-raw-insn", obj])
+    if out.returncode != 0:
+        raise RuntimeError(out.stderr)
+    funcs, current = {}, None
+    for line in out.stdout.splitlines():
+        m = FUNC.match(line)
+        if m:
+            current = funcs.setdefault(m.group(1), [])
+            continue
+        m = INSN.match(line)
+        if current is None or not m:
+            continue
+        mnemonic, operands = m.group(1), m.group(2).split("@")[0].strip()
+        if mnemonic.startswith(".") or mnemonic == "nop" or (mnemonic == "bx" and operands == "lr"):
+            continue
+        current.append((mnemonic, operands))
+    return funcs
+
+
+def gpio_accesses(insns):
+    """Loads and stores through a base register (the GPIO literal), by register offset."""
+    loads, stores = {}, {}
+    for mnemonic, operands in insns:
+        m = MEM.search(operands)
+        if not m:
+            continue    # pc-relative literal load or no memory operand
+        offset = int(m.group(2) or 0)
+        if mnemonic.startswith("ldr"):
+            loads[offset] = loads.get(offset, 0) + 1
+        elif mnemonic.startswith("str"):
+            stores[offset] = stores.get(offset, 0) + 1
+    return loads, stores
+
+
+def describe(accesses):
+    return ", ".join(f"{n} x {REG_NAMES.get(o, hex(o))}" for o, n in sorted(accesses.items())) or "none"
+
+
+def check_codegen(prefix, tmp, listing):
+    src = os.path.join(tmp, "probe.cpp")
+    obj = os.path.join(tmp, "probe.o")
+    with open(src, "w") as f:
+        f.write(PROBE_HEADER)
+        for _, code, *_ in PROBES:
+            f.write(f'extern "C" {code}\n')
+    out = run([prefix + "g++", *CXXFLAGS, "-I", SOURCES, "-c", src, "-o", obj])
+    if out.returncode != 0:
+        print(out.stderr)
+        print("FAIL probe does not compile")
+        return False
+
+    funcs = disassemble(prefix, obj)
+    failures = 0
+    print(f"{'operation':<12} {'insns':>5}  {'GPIO loads':<14} {'GPIO stores':<14} result")
+    for name, _, max_insns, want_loads, want_stores in PROBES:
+        insns = funcs.get(name, [])
+        loads, stores = gpio_accesses(insns)
+        ok = bool(insns) and len(insns) <= max_insns and loads == want_loads and stores == want_stores
+        failures += not ok
+        print(f"{name:<12} {len(insns):>5}  {describe(loads):<14} {describe(stores):<14} "
+              f"{'OK' if ok else f'FAIL (max {max_insns}, want {describe(want_loads)} / {describe(want_stores)})'}")
+        if listing or not ok:
+            for mnemonic, operands in insns:
+                print(f"               {mnemonic:<8} {operands}")
+
+    # The C driver, for comparison
+    drv_obj = os.path.join(tmp, "gpio_driver.o")
+    out = run([prefix + "gcc", *CFLAGS, "-I", SOURCES, "-c",
+               os.path.join(SOURCES, "stm32f446xx_gpio_driver.c"), "-o", drv_obj])
+    if out.returncode == 0:
+        drv = disassemble(prefix, drv_obj)
+        print("\nC driver (plus argument setup and a call at every call site):")
+        for name in DRIVER_FUNCTIONS:
+            if name in drv:
+                print(f"  {name:<24} {len(drv[name]):>3} insns")
+    return failures == 0
+
+
+def check_static(prefix, tmp):
+    failures = 0
+
+    def compile_body(body):
+        src = os.path.join(tmp, "static.cpp")
+        with open(src, "w") as f:
+            f.write(PROBE_HEADER)
+            f.write(body)
+        return run([prefix + "g++", *CXXFLAGS, "-I", SOURCES, "-fsyntax-only", src])
+
+    out = compile_body(VALID_USE)
+    if out.returncode != 0:
+        print(out.stderr)
+        print("FAIL valid use does not compile")
+        failures += 1
+    else:
+        print("valid use compiles: OK")
+
+    for body, message in NEGATIVE:
+        out = compile_body(f"void invalid(void){{ {body} }}\n")
+        ok = out.returncode != 0 and message in out.stderr
+        failures += not ok
+        if ok:
+            print(f"OK   rejected ({message}): {body}")
+        else:
+            print(f"FAIL not rejected with '{message}': {body}")
+    return failures == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--prefix", default="arm-none-eabi-", help="toolchain prefix (g++, gcc, objdump)")
+    parser.add_argument("--list", action="store_true", help="print the disassembly of every probe")
+    args = parser.parse_args()
+
+    try:
+        with tempfile.TemporaryDirectory() as tmp:
+            print("== codegen ==")
+            ok = check_codegen(args.prefix, tmp, args.list)
+            print("\n== compile-time checks ==")
+            ok = check_static(args.prefix, tmp) and ok
+    except FileNotFoundError as e:
+        print(f"toolchain not found: {e.filename} (use --prefix)")
+        sys.exit(1)
+
+    print("OK" if ok else "FAILURES")
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+dither_analysis.py
+
+Checks the sigma-delta PWM dithering of stm32f446xx_dither_driver.c on the host.
+
+Two modes:
+
+model    Runs the SAME modulator as the driver (DITHER_FillPattern / DITHER_UpdateHook):
+             acc = (acc & FRAC_MASK) + duty
+             ccr = acc >> FRAC_BITS
+         for every fixed-point duty from 0 to (ARR + 1) << FRAC_BITS, and checks:
+         - DMA pattern (one cycle from acc = 0): average == duty exactly
+         - update ISR (free running, any leftover fraction, every fraction): every window of
+           2^FRAC_BITS periods averages within less than 1 / 2^FRAC_BITS counts of duty
+         - no period is more than one count away from the duty
+         Then prints the effective resolution for the given carrier.
+
+capture  Measures a logic-analyzer export of the PWM pin (CSV: time in seconds, level 0/1,
+         one row per transition, e.g. Saleae "digital.csv"). Every rising edge starts a
+         period (PWM mode 1, active high); the duty of each period is high time / period.
+         Prints the average duty in counts and compares it with --expect.
+
+Usage:
+    python3 dither_analysis.py model --arr 4499 --frac-bits 4 --pwm-hz 20000
+    python3 dither_analysis.py capture digital.csv --arr 4499 --frac-bits 4 --expect 160.25
+Exit status 1 if a check fails.
+"""
+import argparse
+import csv
+import math
+import sys
+
+
+def modulate(duty, frac_bits, periods, acc=0):
+    """CCR value of each period, exactly as the driver computes it."""
+    mask = (1 << frac_bits) - 1
+    out = []
+    for _ in range(periods):
+        acc = (acc & mask) + duty
+        out.append(acc >> frac_bits)
+    return out
+
+
+def check_model(arr, frac_bits, pwm_hz):
+    cycle = 1 << frac_bits
+    top = (arr + 1) << frac_bits
+    worst_window = 0.0
+    failures = 0
+
+    # DMA engine: the pattern buffer of every duty
+    for duty in range(top + 1):
+        pattern = modulate(duty, frac_bits, cycle)
+        if sum(pattern) != duty:
+            print(f"FAIL pattern duty={duty}: sum {sum(pattern)}")
+            failures += 1
+
+    # Update ISR engine, starting from every possible leftover fraction (the duty was just
+    # changed). The integer part of the duty only offsets every CCR value, so every
+    # fraction on top of one integer part covers all duties.
+    base = arr // 2
+    for frac in range(cycle):
+        duty = (base << frac_bits) + frac
+        target = duty / cycle
+        for start in range(cycle):
+            seq = modulate(duty, frac_bits, 2 * cycle, acc=start)
+            if any(abs(ccr - target) >= 1.0 for ccr in seq):
+                print(f"FAIL isr duty={duty} acc={start}: step of a full count or more")
+                failures += 1
+            for i in range(cycle + 1):
+                err = abs(sum(seq[i:i + cycle]) / cycle - target)
+                worst_window = max(worst_window, err)
+                if err >= 1.0 / cycle:
+                    print(f"FAIL isr duty={duty} acc={start}: window error {err:.6f} counts")
+                    failures += 1
+                    break
+
+    steps = top
+    print(f"ARR = {arr}, {arr + 1} counts per period, FRAC_BITS = {frac_bits}")
+    print(f"duty steps:           {steps} ({math.log2(steps):.2f} bits, plain PWM {math.log2(arr + 1):.2f} bits)")
+    print(f"worst window error:   {worst_window:.6f} counts (limit {1.0 / cycle:.6f})")
+    if pwm_hz:
+        print(f"carrier:              {pwm_hz} Hz")
+        print(f"averaging window:     {cycle} periods = {1000.0 * cycle / pwm_hz:.3f} ms")
+        print(f"lowest ripple freq.:  {pwm_hz / cycle:.1f} Hz (+-1 count)")
+    print("OK" if failures == 0 else f"{failures} FAILURES")
+    return failures == 0
+
+
+def check_capture(path, arr, frac_bits, expect, tolerance):
+    edges = []
+    with open(path, newline="") as f:
+        for row in csv.reader(f):
+            try:
+                edges.append((float(row[0]), int(float(row[1]))))
+            except (ValueError, IndexError):
+                continue    # header line
+
+    rises = [i for i in range(1, len(edges)) if edges[i][1] == 1 and edges[i - 1][1] == 0]
+    duties = []
+    for a, b in zip(rises, rises[1:]):
+        start, end = edges[a][0], edges[b][0]
+        fall = next((t for t, level in edges[a:b] if level == 0), end)
+        duties.append((fall - start) / (end - start) * (arr + 1))
+
+    if len(duties) < (1 << frac_bits):
+        print(f"capture too short: {len(duties)} periods, need at least {1 << frac_bits}")
+        return False
+
+    # Whole modulator cycles only: a partial cycle biases the average
+    duties = duties[:len(duties) - len(duties) % (1 << frac_bits)]
+    mean = sum(duties) / len(duties)
+    print(f"periods:              {len(duties)} ({len(duties) >> frac_bits} modulator cycles)")
+    print(f"per-period duty:      {min(duties):.3f} .. {max(duties):.3f} counts")
+    print(f"average duty:         {mean:.4f} counts")
+    if expect is None:
+        return True
+    err = mean - expect
+    print(f"expected:             {expect:.4f} counts, error {err:+.4f} (tolerance {tolerance})")
+    ok = abs(err) <= tolerance
+    print("OK" if ok else "FAIL")
+    return ok
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="mode", required=True)
+
+    model = sub.add_parser("model", help="check the modulator for every duty")
+    model.add_argument("--arr", type=int, default=4499)
+    model.add_argument("--frac-bits", type=int, default=4)
+    model.add_argument("--pwm-hz", type=float, default=20000)
+
+    cap = sub.add_parser("capture", help="measure a logic-analyzer CSV")
+    cap.add_argument("csv")
+    cap.add_argument("--arr", type=int, required=True)
+    cap.add_argument("--frac-bits", type=int, default=4)
+    cap.add_argument("--expect", type=float, help="expected duty in counts, e.g. 160.25")
+    cap.add_argument("--tolerance", type=float, default=0.05, help="counts (edge timing of the analyzer)")
+
+    args = parser.parse_args()
+    if args.mode == "model":
+        ok = check_model(args.arr, args.frac_bits, args.pwm_hz)
+    else:
+        ok = check_capture(args.csv, args.arr, args.frac_bits, args.expect, args.tolerance)
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""
+gen_brightness_tables.py
+
+Generates Sources/brightness_tables.h: perceptual brightness tables for the PWM LED.
+
+Why a generator?
+The eye does not see PWM duty linearly: 50 % duty looks much brighter than "half".
+Correct curves need pow() / cos(), which we do not want to run on the MCU.
+This script does the math once on the host and writes the results as C constants.
+
+Why Q16 and a SCALE macro instead of CCR values?
+The values are stored as fractions of full brightness in Q16 (0 .. 65536 = 100 %).
+Each table is emitted as a macro that takes a SCALE(q16) macro, so the C side
+turns them into CCR values at compile time with its own ARR:
+
+    #define PWM_SCALE(Q16) LEDTABLE_Q16_TO_CCR(Q16, PWM_ARR)
+    static const uint32_t Table[] = { LEDTABLE_CIE1931(PWM_SCALE) };
+
+If PSC/ARR change, the compiler simply rescales; only the table LENGTH and the
+curve parameters need this script.
+
+Usage:
+    python3 gen_brightness_tables.py --length 100 --gamma 2.2 -o ../Sources/brightness_tables.h
+(CMake runs it automatically when this file or BRIGHTNESS_TABLE_LENGTH changes.)
+"""
+import argparse
+import math
+
+Q16_ONE = 1 << 16
+
+
+def q16(x):
+    """Fraction 0..1 -> Q16, rounded and clamped."""
+    return max(0, min(Q16_ONE, int(round(x * Q16_ONE))))
+
+
+def gamma_ramp(n, gamma):
+    """Power-law ramp: duty = (i / (n - 1)) ^ gamma."""
+    return [q16((i / (n - 1)) ** gamma) for i in range(n)]
+
+
+def cie1931(lightness):
+    """CIE 1931 lightness L* (0..100) -> relative luminance Y (0..1)."""
+    if lightness <= 8.0:
+        return lightness / 903.3
+    return ((lightness + 16.0) / 116.0) ** 3
+
+
+def cie_ramp(n):
+    """Equal steps in perceived lightness, 0 .. 100 %."""
+    return [q16(cie1931(100.0 * i / (n - 1))) for i in range(n)]
+
+
+def sine_breath(n):
+    """
+    One full breath (dark -> bright -> dark) over n samples.
+    Lightness follows a raised cosine, so the speed eases in and out at both ends;
+    it is then converted to luminance with CIE 1931 so the fade LOOKS like a sine.
+    """
+    return [q16(cie1931(100.0 * (1.0 - math.cos(2.0 * math.pi * i / n)) / 2.0)) for i in range(n)]
+
+
+def emit_macro(name, values, per_line=8):
+    lines = []
+    for k in range(0, len(values), per_line):
+        chunk = ", ".join("SCALE(%5d)" % v for v in values[k:k + per_line])
+        lines.append("\t" + chunk + ",")
+    return "#define %s(SCALE) \\\n" % name + " \\\n".join(lines) + "\n"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--length", type=int, default=100, help="entries per table (>= 2)")
+    parser.add_argument("--gamma", type=float, default=2.2, help="exponent of the gamma table")
+    parser.add_argument("-o", "--output", required=True, help="header to write")
+    args = parser.parse_args()
+
+    if args.length < 2 or args.length > 65535:
+        parser.error("--length must be 2 .. 65535")
+
+    n = args.length
+    out = []
+    out.append("/*\n")
+    out.append(" * brightness_tables.h\n")
+    out.append(" *\n")
+    out.append(" * GENERATED by Tools/gen_brightness_tables.py -- do not edit by hand.\n")
+    out.append(" * Parameters: --length %d --gamma %g\n" % (n, args.gamma))
+    out.append(" *\n")
+    out.append(" * Every table is a list macro: LEDTABLE_xxx(SCALE) expands to\n")
+    out.append(" * SCALE(q0), SCALE(q1), ... with q in Q16 (65536 = 100 % duty).\n")
+    out.append(" * Use LEDTABLE_Q16_TO_CCR as SCALE to get CCR values for a given ARR,\n")
+    out.append(" * evaluated by the compiler (the table ends up in flash, zero runtime math).\n")
+    out.append(" */\n\n")
+    out.append("#ifndef SOURCES_BRIGHTNESS_TABLES_H_\n#define SOURCES_BRIGHTNESS_TABLES_H_\n\n")
+    out.append("#include <stdint.h>\n\n")
+    out.append("#define LEDTABLE_LENGTH         %dU\n" % n)
+    out.append("#define LEDTABLE_GAMMA_X10      %dU   // gamma of LEDTABLE_GAMMA, times 10\n\n" % int(round(args.gamma * 10)))
+    out.append("/*\n * Q16 fraction -> CCR value for a timer with period ARR (full on = ARR + 1), rounded.\n */\n")
+    out.append("#define LEDTABLE_Q16_TO_CCR(Q16, ARR) \\\n")
+    out.append("\t((uint32_t)((((uint64_t)(Q16) * ((uint64_t)(ARR) + 1U)) + 0x8000U) >> 16))\n\n")
+    out.append("/* Ramp 0 -> 100 %%, duty = x ^ %g */\n" % args.gamma)
+    out.append(emit_macro("LEDTABLE_GAMMA", gamma_ramp(n, args.gamma)))
+    out.append("\n/* Ramp 0 -> 100 %, equal steps of CIE 1931 lightness */\n")
+    out.append(emit_macro("LEDTABLE_CIE1931", cie_ramp(n)))
+    out.append("\n/* One full breath dark -> bright -> dark, raised-cosine lightness (CIE 1931 corrected) */\n")
+    out.append(emit_macro("LEDTABLE_SINE_BREATH", sine_breath(n)))
+    out.append("\n#endif /* SOURCES_BRIGHTNESS_TABLES_H_ */\n")
+
+    with open(args.output, "w", newline="\n") as f:
+        f.write("".join(out))
+
+
+if __name__ == "__main__":
+    main()